@@ -1,11 +1,22 @@
 #version 410 core
 
-in vec2 vTexCoord;
+layout (location = 0) in vec2 vTexCoord;
+#ifdef TEXTURE_ARRAY
+layout (location = 1) flat in uint vLayer;
+#endif
 out vec4 fragColor;
 
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray uTextureArray;
+#else
 uniform sampler2D uTexture0;
+#endif
 
 void main()
 {
+#ifdef TEXTURE_ARRAY
+    fragColor = texture(uTextureArray, vec3(vTexCoord, float(vLayer)));
+#else
     fragColor = texture(uTexture0, vTexCoord);
+#endif
 }
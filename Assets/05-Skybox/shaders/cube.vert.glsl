@@ -4,14 +4,14 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
-out vec2 vTexCoord;
+layout (location = 0) out vec2 vTexCoord; // Explicit, to match cube.frag.glsl
+
+#include "frame_data.glsl"
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
 
 void main()
 {
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0);
+    gl_Position = uViewProjection * uModel * vec4(aPos, 1.0);
     vTexCoord = aTexCoord;
 }
@@ -0,0 +1,31 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aInstanceModel; // Per-instance model matrix (locations 3..6)
+#ifdef TEXTURE_ARRAY
+layout (location = 7) in uint aLayer;         // Per-instance texture array layer (see Mesh::LAYER_ATTRIBUTE)
+#endif
+
+// Also compiled as a separable stage (see ShaderStage): the built-in outputs are redeclared,
+// and the varyings use explicit locations to match the fragment stage
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+layout (location = 0) out vec2 vTexCoord;
+#ifdef TEXTURE_ARRAY
+layout (location = 1) flat out uint vLayer;
+#endif
+
+#include "frame_data.glsl"
+
+void main()
+{
+    gl_Position = uViewProjection * aInstanceModel * vec4(aPos, 1.0);
+    vTexCoord = aTexCoord;
+#ifdef TEXTURE_ARRAY
+    vLayer = aLayer;
+#endif
+}
@@ -0,0 +1,9 @@
+// Per-frame constants, written once per frame (see FrameUniforms)
+layout (std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec4 uCameraPosition; // xyz = camera world position
+    vec4 uTime;           // x = seconds since start, y = frame delta time
+};
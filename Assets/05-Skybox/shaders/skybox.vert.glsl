@@ -4,16 +4,15 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 vTexCoord;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
+#include "frame_data.glsl"
 
 void main()
 {
     vTexCoord = aPos;
-    // We use a 4x4 matrix multiplication for the view matrix,
-    // but we discard the translation part by setting the w component to 0.0.
-    // This makes the skybox appear infinitely far away.
-    vec4 pos = uProjection * uView * vec4(aPos, 1.0);
+    // We need the view matrix without the translation component for the skybox.
+    // Keeping only the upper-left 3x3 (rotation) part makes the skybox appear infinitely far away.
+    mat4 viewWithoutTranslation = mat4(mat3(uView));
+    vec4 pos = uProjection * viewWithoutTranslation * vec4(aPos, 1.0);
     gl_Position = pos.xyww; // Set z to w to ensure z is always 1.0 after perspective divide
 }
 
@@ -35,6 +35,13 @@ std::string AssetManager::getTextureDirectory()
     return baseDirectory + "textures/";
 }
 
+// Get the directory for generated files (derived from base directory)
+std::string AssetManager::getCacheDirectory()
+{
+    // Generated files go in a "cache/" subdirectory, which can be deleted at any time
+    return baseDirectory + "cache/";
+}
+
 // Get the full path for a shader file.
 // Combines base directory, shader directory, and filename.
 std::string AssetManager::getShaderPath(const std::string& filename)
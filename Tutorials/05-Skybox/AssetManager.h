@@ -20,6 +20,10 @@ public:
     // Get the directory for textures (derived from base directory).
     static std::string getTextureDirectory();
     
+    // Get the directory for files generated at runtime, such as the shader binary cache
+    // (derived from base directory).
+    static std::string getCacheDirectory();
+    
     // Get the full path for a shader file.
     // Combines base directory, shader directory, and filename.
     static std::string getShaderPath(const std::string& filename);
@@ -0,0 +1,782 @@
+#include "BlockCompressor.h"
+
+#include <algorithm> // For std::min, std::max, std::swap
+#include <cmath>     // For std::log10, std::sqrt
+#include <future>    // For waiting on the worker jobs
+
+#include "ThreadPool.h"
+
+// Pick the vector instruction set for the fast encoder
+#if defined(__SSE2__) || defined(_M_X64)
+#define BLOCKCOMPRESSOR_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define BLOCKCOMPRESSOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+// On x86 with GCC / Clang, also build AVX2 kernels (8 pixels per register instead of 4).
+// They are compiled per function with the target attribute and picked at runtime, so the
+// project needs no -mavx2 and the binary still runs on CPUs without AVX2.
+#if BLOCKCOMPRESSOR_SSE2 && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLOCKCOMPRESSOR_AVX2 1
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Shared helpers
+// ---------------------------------------------------------------------------
+
+// Quantize an 8-bit color to RGB565
+static uint16_t to565(const int rgb[3])
+{
+    return static_cast<uint16_t>((((rgb[0] * 31 + 127) / 255) << 11) | (((rgb[1] * 63 + 127) / 255) << 5) | ((rgb[2] * 31 + 127) / 255));
+}
+
+// Expand an RGB565 color back to 8 bits per channel (the way the GPU does)
+static void from565(uint16_t color, int rgb[3])
+{
+    int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Write a BC1 color block: two little-endian 565 endpoints, then 2-bit indices (pixel 0 in the low bits)
+static void writeColorBlock(uint8_t out[8], uint16_t color0, uint16_t color1, uint32_t indices)
+{
+    out[0] = color0 & 0xFF; out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF; out[3] = color1 >> 8;
+    out[4] = indices & 0xFF; out[5] = (indices >> 8) & 0xFF;
+    out[6] = (indices >> 16) & 0xFF; out[7] = indices >> 24;
+}
+
+// Write a BC3 alpha block: two endpoints, then 3-bit indices (pixel 0 in the low bits)
+static void writeAlphaBlock(uint8_t out[8], int alpha0, int alpha1, uint64_t indices)
+{
+    out[0] = static_cast<uint8_t>(alpha0);
+    out[1] = static_cast<uint8_t>(alpha1);
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+}
+
+// Build the 4-color palette of a BC1 color block (4-color mode)
+static void colorPalette(uint16_t color0, uint16_t color1, int palette[4][3])
+{
+    from565(color0, palette[0]);
+    from565(color1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+// Build the 8-value palette of a BC3 alpha block (either mode)
+static void alphaPalette(int alpha0, int alpha1, int palette[8])
+{
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+    if (alpha0 > alpha1)
+    {
+        for (int i = 1; i < 7; i++) {
+            palette[1 + i] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 1; i < 5; i++) {
+            palette[1 + i] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Vectorized kernels of the fast encoder
+// ---------------------------------------------------------------------------
+
+#if BLOCKCOMPRESSOR_AVX2
+// Check once whether this CPU can run the AVX2 kernels
+static bool cpuHasAVX2()
+{
+#if defined(__AVX2__)
+    return true; // Built for AVX2 CPUs only
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
+}
+
+// AVX2 version of blockMinMax: two registers of 8 pixels
+__attribute__((target("avx2")))
+static void blockMinMaxAVX2(const uint8_t rgba[64], uint8_t minColor[4], uint8_t maxColor[4])
+{
+    __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba));
+    __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + 32));
+    __m256i lo8 = _mm256_min_epu8(p0, p1);
+    __m256i hi8 = _mm256_max_epu8(p0, p1);
+    // Fold the two 128-bit halves, then the four pixels of the remaining register into lane 0
+    __m128i lo = _mm_min_epu8(_mm256_castsi256_si128(lo8), _mm256_extracti128_si256(lo8, 1));
+    __m128i hi = _mm_max_epu8(_mm256_castsi256_si128(hi8), _mm256_extracti128_si256(hi8, 1));
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t loBits = static_cast<uint32_t>(_mm_cvtsi128_si32(lo));
+    uint32_t hiBits = static_cast<uint32_t>(_mm_cvtsi128_si32(hi));
+    for (int c = 0; c < 4; c++)
+    {
+        minColor[c] = static_cast<uint8_t>(loBits >> (8 * c));
+        maxColor[c] = static_cast<uint8_t>(hiBits >> (8 * c));
+    }
+}
+
+// AVX2 version of projectLevels: two iterations of 8 pixels
+__attribute__((target("avx2")))
+static void projectLevelsAVX2(const uint8_t rgba[64], const int weights[4], int base, const int* thresholds, int thresholdCount, int levels[16])
+{
+    const __m256i byteMask = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i weightRB = _mm256_set1_epi32((weights[2] << 16) | weights[0]);
+    const __m256i weightGA = _mm256_set1_epi32((weights[3] << 16) | weights[1]);
+    const __m256i baseVector = _mm256_set1_epi32(base);
+    for (int h = 0; h < 2; h++)
+    {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + 32 * h));
+        __m256i rb = _mm256_and_si256(pixels, byteMask);
+        __m256i ga = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), byteMask);
+        __m256i dot = _mm256_add_epi32(_mm256_madd_epi16(rb, weightRB), _mm256_madd_epi16(ga, weightGA));
+        dot = _mm256_sub_epi32(dot, baseVector);
+        __m256i level = _mm256_setzero_si256();
+        for (int t = 0; t < thresholdCount; t++) {
+            level = _mm256_sub_epi32(level, _mm256_cmpgt_epi32(dot, _mm256_set1_epi32(thresholds[t] - 1)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(levels + 8 * h), level);
+    }
+}
+#endif
+
+// Per-channel minimum and maximum over the 16 pixels
+static void blockMinMax(const uint8_t rgba[64], uint8_t minColor[4], uint8_t maxColor[4])
+{
+#if BLOCKCOMPRESSOR_AVX2
+    if (cpuHasAVX2())
+    {
+        blockMinMaxAVX2(rgba, minColor, maxColor);
+        return;
+    }
+#endif
+#if BLOCKCOMPRESSOR_SSE2
+    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba));
+    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16));
+    __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 32));
+    __m128i p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 48));
+    __m128i lo = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+    __m128i hi = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+    // Fold the four pixels of each register into lane 0
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t loBits = static_cast<uint32_t>(_mm_cvtsi128_si32(lo));
+    uint32_t hiBits = static_cast<uint32_t>(_mm_cvtsi128_si32(hi));
+    for (int c = 0; c < 4; c++)
+    {
+        minColor[c] = static_cast<uint8_t>(loBits >> (8 * c));
+        maxColor[c] = static_cast<uint8_t>(hiBits >> (8 * c));
+    }
+#elif BLOCKCOMPRESSOR_NEON
+    uint8x16_t p0 = vld1q_u8(rgba), p1 = vld1q_u8(rgba + 16), p2 = vld1q_u8(rgba + 32), p3 = vld1q_u8(rgba + 48);
+    uint8x16_t lo = vminq_u8(vminq_u8(p0, p1), vminq_u8(p2, p3));
+    uint8x16_t hi = vmaxq_u8(vmaxq_u8(p0, p1), vmaxq_u8(p2, p3));
+    // Fold the four pixels of each register into the first pixel
+    uint8x8_t lo8 = vmin_u8(vget_low_u8(lo), vget_high_u8(lo));
+    uint8x8_t hi8 = vmax_u8(vget_low_u8(hi), vget_high_u8(hi));
+    lo8 = vmin_u8(lo8, vreinterpret_u8_u32(vrev64_u32(vreinterpret_u32_u8(lo8))));
+    hi8 = vmax_u8(hi8, vreinterpret_u8_u32(vrev64_u32(vreinterpret_u32_u8(hi8))));
+    uint8_t loBytes[8], hiBytes[8];
+    vst1_u8(loBytes, lo8);
+    vst1_u8(hiBytes, hi8);
+    for (int c = 0; c < 4; c++)
+    {
+        minColor[c] = loBytes[c];
+        maxColor[c] = hiBytes[c];
+    }
+#else
+    for (int c = 0; c < 4; c++)
+    {
+        minColor[c] = 255;
+        maxColor[c] = 0;
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            minColor[c] = std::min(minColor[c], rgba[i * 4 + c]);
+            maxColor[c] = std::max(maxColor[c], rgba[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+// For each pixel, project it onto the weights (w . rgba - base) and count how many of
+// the ascending thresholds the projection reaches. The count is the pixel's position
+// along the line between the endpoints, 0 = at the low endpoint.
+// Weights must be in [0, 255] (they fit 16-bit multiplies).
+static void projectLevels(const uint8_t rgba[64], const int weights[4], int base, const int* thresholds, int thresholdCount, int levels[16])
+{
+#if BLOCKCOMPRESSOR_AVX2
+    if (cpuHasAVX2())
+    {
+        projectLevelsAVX2(rgba, weights, base, thresholds, thresholdCount, levels);
+        return;
+    }
+#endif
+#if BLOCKCOMPRESSOR_SSE2
+    // Split each pixel into 16-bit (R, B) and (G, A) pairs, so one madd computes two channel products
+    const __m128i byteMask = _mm_set1_epi32(0x00FF00FF);
+    const __m128i weightRB = _mm_set1_epi32((weights[2] << 16) | weights[0]);
+    const __m128i weightGA = _mm_set1_epi32((weights[3] << 16) | weights[1]);
+    const __m128i baseVector = _mm_set1_epi32(base);
+    for (int q = 0; q < 4; q++)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16 * q));
+        __m128i rb = _mm_and_si128(pixels, byteMask);
+        __m128i ga = _mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask);
+        __m128i dot = _mm_add_epi32(_mm_madd_epi16(rb, weightRB), _mm_madd_epi16(ga, weightGA));
+        dot = _mm_sub_epi32(dot, baseVector);
+        __m128i level = _mm_setzero_si128();
+        for (int t = 0; t < thresholdCount; t++)
+        {
+            // Compare masks are -1 where true, so subtracting them counts
+            level = _mm_sub_epi32(level, _mm_cmpgt_epi32(dot, _mm_set1_epi32(thresholds[t] - 1)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(levels + 4 * q), level);
+    }
+#elif BLOCKCOMPRESSOR_NEON
+    const uint32x4_t byteMask = vdupq_n_u32(0xFF);
+    const int32x4_t baseVector = vdupq_n_s32(base);
+    for (int q = 0; q < 4; q++)
+    {
+        uint32x4_t pixels = vreinterpretq_u32_u8(vld1q_u8(rgba + 16 * q));
+        int32x4_t r = vreinterpretq_s32_u32(vandq_u32(pixels, byteMask));
+        int32x4_t g = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(pixels, 8), byteMask));
+        int32x4_t b = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(pixels, 16), byteMask));
+        int32x4_t a = vreinterpretq_s32_u32(vshrq_n_u32(pixels, 24));
+        int32x4_t dot = vmulq_n_s32(r, weights[0]);
+        dot = vmlaq_n_s32(dot, g, weights[1]);
+        dot = vmlaq_n_s32(dot, b, weights[2]);
+        dot = vmlaq_n_s32(dot, a, weights[3]);
+        dot = vsubq_s32(dot, baseVector);
+        int32x4_t level = vdupq_n_s32(0);
+        for (int t = 0; t < thresholdCount; t++)
+        {
+            // Compare masks are all ones (-1) where true, so subtracting them counts
+            level = vsubq_s32(level, vreinterpretq_s32_u32(vcgeq_s32(dot, vdupq_n_s32(thresholds[t]))));
+        }
+        vst1q_s32(levels + 4 * q, level);
+    }
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        const uint8_t* p = rgba + 4 * i;
+        int dot = p[0] * weights[0] + p[1] * weights[1] + p[2] * weights[2] + p[3] * weights[3] - base;
+        int level = 0;
+        for (int t = 0; t < thresholdCount; t++) {
+            level += dot >= thresholds[t];
+        }
+        levels[i] = level;
+    }
+#endif
+}
+
+// Smallest integer x with scale * x >= value (for value >= 0)
+static int ceilDiv(int value, int scale)
+{
+    return (value + scale - 1) / scale;
+}
+
+// ---------------------------------------------------------------------------
+// Fast encoder
+// ---------------------------------------------------------------------------
+
+// Bounding box endpoints (inset by 1/16 to counter the box overshooting), projection indices
+void BlockCompressor::encodeColorFast(const uint8_t rgba[64], uint8_t out[8])
+{
+    uint8_t minColor[4], maxColor[4];
+    blockMinMax(rgba, minColor, maxColor);
+
+    int low[3], high[3];
+    for (int c = 0; c < 3; c++)
+    {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        low[c] = minColor[c] + inset;
+        high[c] = maxColor[c] - inset;
+    }
+    // Each channel of high is >= low, so color0 >= color1
+    uint16_t color0 = to565(high);
+    uint16_t color1 = to565(low);
+    if (color0 == color1)
+    {
+        writeColorBlock(out, color0, color1, 0); // Solid block: every pixel uses color0
+        return;
+    }
+
+    // Project onto the line between the decoded endpoints
+    int end0[3], end1[3];
+    from565(color0, end0);
+    from565(color1, end1);
+    int weights[4] = { end0[0] - end1[0], end0[1] - end1[1], end0[2] - end1[2], 0 };
+    int base = end1[0] * weights[0] + end1[1] * weights[1] + end1[2] * weights[2];
+    int range = (end0[0] * weights[0] + end0[1] * weights[1] + end0[2] * weights[2]) - base;
+
+    // Nearest of 4 evenly spaced points: boundaries at 1/6, 3/6 and 5/6 of the range
+    int thresholds[3] = { ceilDiv(range, 6), ceilDiv(3 * range, 6), ceilDiv(5 * range, 6) };
+    int levels[16];
+    projectLevels(rgba, weights, base, thresholds, 3, levels);
+
+    // Position along the line (0 = color1 .. 3 = color0) to BC1 index
+    static const uint32_t LEVEL_TO_INDEX[4] = { 1, 3, 2, 0 };
+    uint32_t indices = 0;
+    for (int i = 0; i < 16; i++) {
+        indices |= LEVEL_TO_INDEX[levels[i]] << (2 * i);
+    }
+    writeColorBlock(out, color0, color1, indices);
+}
+
+// Min / max endpoints, projection indices (8-value mode)
+void BlockCompressor::encodeAlphaFast(const uint8_t rgba[64], uint8_t out[8])
+{
+    uint8_t minColor[4], maxColor[4];
+    blockMinMax(rgba, minColor, maxColor);
+    int alpha0 = maxColor[3], alpha1 = minColor[3];
+    if (alpha0 == alpha1)
+    {
+        writeAlphaBlock(out, alpha0, alpha1, 0);
+        return;
+    }
+
+    // Nearest of 8 evenly spaced values: boundaries at 1/14, 3/14, ... 13/14 of the range
+    int range = alpha0 - alpha1;
+    int thresholds[7];
+    for (int k = 0; k < 7; k++) {
+        thresholds[k] = ceilDiv((2 * k + 1) * range, 14);
+    }
+    const int weights[4] = { 0, 0, 0, 1 };
+    int levels[16];
+    projectLevels(rgba, weights, alpha1, thresholds, 7, levels);
+
+    // Position (0 = alpha1 .. 7 = alpha0) to BC3 alpha index
+    static const uint64_t LEVEL_TO_INDEX[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; i++) {
+        indices |= LEVEL_TO_INDEX[levels[i]] << (3 * i);
+    }
+    writeAlphaBlock(out, alpha0, alpha1, indices);
+}
+
+// ---------------------------------------------------------------------------
+// Reference encoder
+// ---------------------------------------------------------------------------
+
+// Nearest-palette indices for a pair of 565 endpoints (in 4-color order), and the squared error
+static uint32_t fitColorIndices(const uint8_t rgba[64], uint16_t color0, uint16_t color1, int& error)
+{
+    int palette[4][3];
+    colorPalette(color0, color1, palette);
+    uint32_t indices = 0;
+    error = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 4; p++)
+        {
+            int dr = rgba[4 * i] - palette[p][0], dg = rgba[4 * i + 1] - palette[p][1], db = rgba[4 * i + 2] - palette[p][2];
+            int e = dr * dr + dg * dg + db * db;
+            if (e < bestError) {
+                bestError = e;
+                best = p;
+            }
+        }
+        indices |= static_cast<uint32_t>(best) << (2 * i);
+        error += bestError;
+    }
+    return indices;
+}
+
+// Principal-axis endpoints, refined twice by least squares; keeps the best of the candidates
+void BlockCompressor::encodeColorReference(const uint8_t rgba[64], uint8_t out[8])
+{
+    // Mean and covariance of the colors
+    float mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) mean[c] += rgba[4 * i + c] / 16.0f;
+    }
+    float cov[3][3] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float d[3] = { rgba[4 * i] - mean[0], rgba[4 * i + 1] - mean[1], rgba[4 * i + 2] - mean[2] };
+        for (int a = 0; a < 3; a++) {
+            for (int b = 0; b < 3; b++) cov[a][b] += d[a] * d[b];
+        }
+    }
+
+    // Principal axis by power iteration
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[3];
+        for (int a = 0; a < 3; a++) {
+            next[a] = cov[a][0] * axis[0] + cov[a][1] * axis[1] + cov[a][2] * axis[2];
+        }
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) {
+            break; // Solid block: any axis works
+        }
+        for (int a = 0; a < 3; a++) axis[a] = next[a] / length;
+    }
+
+    // Endpoints at the extreme projections along the axis
+    float minProjection = 1e30f, maxProjection = -1e30f;
+    for (int i = 0; i < 16; i++)
+    {
+        float projection = (rgba[4 * i] - mean[0]) * axis[0] + (rgba[4 * i + 1] - mean[1]) * axis[1] + (rgba[4 * i + 2] - mean[2]) * axis[2];
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+    int high[3], low[3];
+    for (int c = 0; c < 3; c++)
+    {
+        high[c] = std::clamp(static_cast<int>(std::lround(mean[c] + axis[c] * maxProjection)), 0, 255);
+        low[c] = std::clamp(static_cast<int>(std::lround(mean[c] + axis[c] * minProjection)), 0, 255);
+    }
+
+    uint16_t bestColor0 = to565(high), bestColor1 = to565(low);
+    int bestError;
+    uint32_t bestIndices = fitColorIndices(rgba, bestColor0, bestColor1, bestError);
+
+    // Least-squares refinement: given the indices, solve for the endpoints that minimize the error
+    static const float INDEX_WEIGHT[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f }; // Weight of color0
+    uint32_t indices = bestIndices;
+    for (int iteration = 0; iteration < 2; iteration++)
+    {
+        float aa = 0, ab = 0, bb = 0, ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float w = INDEX_WEIGHT[(indices >> (2 * i)) & 3];
+            aa += w * w;
+            ab += w * (1 - w);
+            bb += (1 - w) * (1 - w);
+            for (int c = 0; c < 3; c++)
+            {
+                ax[c] += w * rgba[4 * i + c];
+                bx[c] += (1 - w) * rgba[4 * i + c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f) {
+            break; // All pixels on one index: nothing to solve
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            high[c] = std::clamp(static_cast<int>(std::lround((bb * ax[c] - ab * bx[c]) / determinant)), 0, 255);
+            low[c] = std::clamp(static_cast<int>(std::lround((aa * bx[c] - ab * ax[c]) / determinant)), 0, 255);
+        }
+        uint16_t color0 = to565(high), color1 = to565(low);
+        int error;
+        indices = fitColorIndices(rgba, color0, color1, error);
+        if (error < bestError)
+        {
+            bestError = error;
+            bestColor0 = color0;
+            bestColor1 = color1;
+            bestIndices = indices;
+        }
+    }
+
+    // 4-color mode needs color0 > color1: swap the endpoints and their indices if needed
+    if (bestColor0 < bestColor1)
+    {
+        std::swap(bestColor0, bestColor1);
+        bestIndices ^= 0x55555555u; // 0 <-> 1 and 2 <-> 3
+    }
+    else if (bestColor0 == bestColor1)
+    {
+        bestIndices = 0; // 3-color mode would make index 3 transparent
+    }
+    writeColorBlock(out, bestColor0, bestColor1, bestIndices);
+}
+
+// Nearest-value indices for a pair of alpha endpoints, and the squared error
+static uint64_t fitAlphaIndices(const uint8_t rgba[64], int alpha0, int alpha1, int& error)
+{
+    int palette[8];
+    alphaPalette(alpha0, alpha1, palette);
+    uint64_t indices = 0;
+    error = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 8; p++)
+        {
+            int d = rgba[4 * i + 3] - palette[p];
+            if (d * d < bestError) {
+                bestError = d * d;
+                best = p;
+            }
+        }
+        indices |= static_cast<uint64_t>(best) << (3 * i);
+        error += bestError;
+    }
+    return indices;
+}
+
+// Tries the 8-value mode on the full range and the 6-value mode (explicit 0 and 255)
+// on the range without the extremes; keeps the better one
+void BlockCompressor::encodeAlphaReference(const uint8_t rgba[64], uint8_t out[8])
+{
+    int minAlpha = 255, maxAlpha = 0, minInner = 255, maxInner = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int a = rgba[4 * i + 3];
+        minAlpha = std::min(minAlpha, a);
+        maxAlpha = std::max(maxAlpha, a);
+        if (a != 0 && a != 255)
+        {
+            minInner = std::min(minInner, a);
+            maxInner = std::max(maxInner, a);
+        }
+    }
+
+    int error8, error6 = 1 << 30;
+    uint64_t indices8 = fitAlphaIndices(rgba, maxAlpha, minAlpha, error8);
+    uint64_t indices6 = 0;
+    if (minInner <= maxInner) {
+        indices6 = fitAlphaIndices(rgba, minInner, maxInner, error6);
+    }
+
+    if (error6 < error8)
+        writeAlphaBlock(out, minInner, maxInner, indices6);
+    else
+        writeAlphaBlock(out, maxAlpha, minAlpha, indices8);
+}
+
+// ---------------------------------------------------------------------------
+// Blocks and images
+// ---------------------------------------------------------------------------
+
+// Encode one 4x4 block
+void BlockCompressor::encodeBlock(Format format, Quality quality, const uint8_t rgba[64], uint8_t* out)
+{
+    // BC3 = alpha block followed by a (always 4-color) BC1 color block
+    uint8_t* colorOut = out;
+    if (format == Format::BC3)
+    {
+        if (quality == Quality::FAST)
+            encodeAlphaFast(rgba, out);
+        else
+            encodeAlphaReference(rgba, out);
+        colorOut = out + 8;
+    }
+    if (quality == Quality::FAST)
+        encodeColorFast(rgba, colorOut);
+    else
+        encodeColorReference(rgba, colorOut);
+}
+
+// Decode one block into 4x4 RGBA pixels
+void BlockCompressor::decodeBlock(Format format, const uint8_t* block, uint8_t rgba[64])
+{
+    const uint8_t* colorBlock = format == Format::BC3 ? block + 8 : block;
+    uint16_t color0 = static_cast<uint16_t>(colorBlock[0] | (colorBlock[1] << 8));
+    uint16_t color1 = static_cast<uint16_t>(colorBlock[2] | (colorBlock[3] << 8));
+    uint32_t indices = colorBlock[4] | (colorBlock[5] << 8) | (colorBlock[6] << 16) | (uint32_t(colorBlock[7]) << 24);
+
+    int palette[4][4];
+    int rgb[4][3];
+    colorPalette(color0, color1, rgb);
+    for (int p = 0; p < 4; p++)
+    {
+        for (int c = 0; c < 3; c++) palette[p][c] = rgb[p][c];
+        palette[p][3] = 255;
+    }
+    if (format == Format::BC1 && color0 <= color1)
+    {
+        // 3-color mode: midpoint, and transparent black
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (rgb[0][c] + rgb[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[3][3] = 0;
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        const int* color = palette[(indices >> (2 * i)) & 3];
+        for (int c = 0; c < 4; c++) rgba[4 * i + c] = static_cast<uint8_t>(color[c]);
+    }
+
+    if (format == Format::BC3)
+    {
+        int alphas[8];
+        alphaPalette(block[0], block[1], alphas);
+        uint64_t alphaIndices = 0;
+        for (int i = 0; i < 6; i++) {
+            alphaIndices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+        }
+        for (int i = 0; i < 16; i++) {
+            rgba[4 * i + 3] = static_cast<uint8_t>(alphas[(alphaIndices >> (3 * i)) & 7]);
+        }
+    }
+}
+
+// Read pixel (x, y) of an image with any channel count as RGBA
+static void readPixel(const Image& image, int x, int y, uint8_t rgba[4])
+{
+    const unsigned char* p = image.pixels.data() + (static_cast<size_t>(y) * image.width + x) * image.channels;
+    switch (image.channels)
+    {
+        case 1: rgba[0] = rgba[1] = rgba[2] = p[0]; rgba[3] = 255; break;
+        case 2: rgba[0] = rgba[1] = rgba[2] = p[0]; rgba[3] = p[1]; break;
+        case 3: rgba[0] = p[0]; rgba[1] = p[1]; rgba[2] = p[2]; rgba[3] = 255; break;
+        default: rgba[0] = p[0]; rgba[1] = p[1]; rgba[2] = p[2]; rgba[3] = p[3]; break;
+    }
+}
+
+// Name of the instruction set the fast encoder uses
+const char* BlockCompressor::getInstructionSet()
+{
+#if BLOCKCOMPRESSOR_AVX2
+    if (cpuHasAVX2()) {
+        return "AVX2";
+    }
+#endif
+#if BLOCKCOMPRESSOR_SSE2
+    return "SSE2";
+#elif BLOCKCOMPRESSOR_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+// Encode a whole image
+std::vector<uint8_t> BlockCompressor::compressImage(const Image& image, Format format, Quality quality, ThreadPool* pool)
+{
+    const int blocksX = (image.width + 3) / 4;
+    const int blocksY = (image.height + 3) / 4;
+    const unsigned int blockBytes = getBlockBytes(format);
+    std::vector<uint8_t> blocks(static_cast<size_t>(blocksX) * blocksY * blockBytes);
+    if (!image.isValid()) {
+        return blocks;
+    }
+
+    // Encode the block rows [firstRow, endRow)
+    auto encodeRows = [&](int firstRow, int endRow) {
+        uint8_t rgba[64];
+        for (int by = firstRow; by < endRow; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                // Gather the block, repeating the last row / column past the image edge
+                for (int y = 0; y < 4; y++)
+                {
+                    int sy = std::min(by * 4 + y, image.height - 1);
+                    for (int x = 0; x < 4; x++) {
+                        readPixel(image, std::min(bx * 4 + x, image.width - 1), sy, rgba + 4 * (y * 4 + x));
+                    }
+                }
+                encodeBlock(format, quality, rgba, blocks.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes);
+            }
+        }
+    };
+
+    if (!pool)
+    {
+        encodeRows(0, blocksY);
+        return blocks;
+    }
+
+    // A few chunks per worker, so uneven chunks even out
+    int chunkCount = std::min(blocksY, static_cast<int>(pool->getThreadCount()) * 4);
+    std::vector<std::future<void>> jobs;
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+        int firstRow = blocksY * chunk / chunkCount;
+        int endRow = blocksY * (chunk + 1) / chunkCount;
+        jobs.push_back(pool->submit([&encodeRows, firstRow, endRow]() { encodeRows(firstRow, endRow); }));
+    }
+    for (std::future<void>& job : jobs) {
+        job.get();
+    }
+    return blocks;
+}
+
+// Decode a whole image into RGBA
+Image BlockCompressor::decompressImage(const std::vector<uint8_t>& blocks, Format format, int width, int height)
+{
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.channels = 4;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const unsigned int blockBytes = getBlockBytes(format);
+    if (blocks.size() < static_cast<size_t>(blocksX) * blocksY * blockBytes) {
+        return Image();
+    }
+
+    uint8_t rgba[64];
+    for (int by = 0; by < blocksY; by++)
+    {
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            decodeBlock(format, blocks.data() + (static_cast<size_t>(by) * blocksX + bx) * blockBytes, rgba);
+            for (int y = 0; y < 4 && by * 4 + y < height; y++)
+            {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                {
+                    unsigned char* dst = image.pixels.data() + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4 + x) * 4;
+                    for (int c = 0; c < 4; c++) dst[c] = rgba[4 * (y * 4 + x) + c];
+                }
+            }
+        }
+    }
+    return image;
+}
+
+// Peak signal-to-noise ratio of b against a
+double BlockCompressor::computePSNR(const Image& a, const Image& b)
+{
+    if (a.width != b.width || a.height != b.height || !a.isValid() || !b.isValid()) {
+        return 0.0;
+    }
+    // Alpha only counts if both images have it
+    const bool hasAlpha = (a.channels == 2 || a.channels == 4) && (b.channels == 2 || b.channels == 4);
+    const int channels = hasAlpha ? 4 : 3;
+
+    double squaredError = 0.0;
+    for (int y = 0; y < a.height; y++)
+    {
+        for (int x = 0; x < a.width; x++)
+        {
+            uint8_t pa[4], pb[4];
+            readPixel(a, x, y, pa);
+            readPixel(b, x, y, pb);
+            for (int c = 0; c < channels; c++)
+            {
+                double d = double(pa[c]) - double(pb[c]);
+                squaredError += d * d;
+            }
+        }
+    }
+    double meanSquaredError = squaredError / (double(a.width) * a.height * channels);
+    if (meanSquaredError <= 0.0) {
+        return 99.0;
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
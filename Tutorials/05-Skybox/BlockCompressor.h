@@ -0,0 +1,72 @@
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Image.h"
+
+class ThreadPool;
+
+// CPU encoder (and decoder) for the BC1 and BC3 block-compressed formats.
+// No OpenGL calls: runs on machines without a GPU, e.g. to cook textures on a build server.
+//
+// Two encoders are provided:
+//  - FAST: bounding-box endpoints with an inset, and projection-based index selection,
+//    vectorized with AVX2 or SSE2 (x86, AVX2 picked at runtime) or NEON (ARM).
+//    This is the one used for cooking.
+//  - REFERENCE: principal-axis endpoints refined by least squares, with exhaustive
+//    nearest-color index selection. Slower and better, used as a baseline for the fast
+//    encoder's quality. It is written here too, so it is not an independent check: the
+//    absolute PSNR against the source image is the measure that does not depend on it.
+class BlockCompressor
+{
+public:
+    enum class Format
+    {
+        BC1, // RGB, 8 bytes per 4x4 block (alpha is ignored)
+        BC3  // RGBA, 16 bytes per 4x4 block (BC1 colors + interpolated alpha)
+    };
+
+    enum class Quality
+    {
+        FAST,
+        REFERENCE
+    };
+
+    // Bytes per 4x4 block
+    static unsigned int getBlockBytes(Format format) { return format == Format::BC1 ? 8 : 16; }
+
+    // Encode one 4x4 block of RGBA pixels (64 bytes, row-major) into out (8 or 16 bytes)
+    static void encodeBlock(Format format, Quality quality, const uint8_t rgba[64], uint8_t* out);
+
+    // Decode one block into 4x4 RGBA pixels (64 bytes, row-major)
+    static void decodeBlock(Format format, const uint8_t* block, uint8_t rgba[64]);
+
+    // Encode a whole image (any channel count; edge blocks repeat the last row/column).
+    // Rows of blocks are split across the pool's workers when a pool is given.
+    // Blocks are written row-major, the layout glCompressedTexImage2D expects.
+    static std::vector<uint8_t> compressImage(const Image& image, Format format, Quality quality, ThreadPool* pool = nullptr);
+
+    // Decode a whole image of the given size into RGBA
+    static Image decompressImage(const std::vector<uint8_t>& blocks, Format format, int width, int height);
+
+    // Name of the instruction set the fast encoder uses on this CPU ("AVX2", "SSE2", "NEON" or "scalar")
+    static const char* getInstructionSet();
+
+    // Peak signal-to-noise ratio of b against a in dB, over RGB (and alpha if both have it).
+    // Higher is better; identical images return 99.
+    static double computePSNR(const Image& a, const Image& b);
+
+private:
+    // Helper functions to encode the color half (BC1 layout) and the alpha half of a block
+    static void encodeColorFast(const uint8_t rgba[64], uint8_t out[8]);
+    static void encodeColorReference(const uint8_t rgba[64], uint8_t out[8]);
+    static void encodeAlphaFast(const uint8_t rgba[64], uint8_t out[8]);
+    static void encodeAlphaReference(const uint8_t rgba[64], uint8_t out[8]);
+
+    // Private constructor to prevent instantiation (it's a static utility class)
+    BlockCompressor() = delete;
+};
+
+#endif // BLOCKCOMPRESSOR_H
@@ -0,0 +1,326 @@
+#include "CompressedImage.h"
+
+#include <algorithm> // For std::max
+#include <cctype>    // For std::tolower
+#include <cstring>   // For std::memcmp
+#include <fstream>   // For reading the file
+#include <iostream>  // For error reporting
+
+#include "TextureCompression.h"
+
+// Read a little-endian uint32 at the given offset
+static uint32_t readU32(const unsigned char* bytes)
+{
+    return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
+// Build a DDS FourCC code from its four characters
+static constexpr uint32_t fourCC(char a, char b, char c, char d)
+{
+    return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+}
+
+// First 12 bytes of every KTX 1 file
+static const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// Check if the path names a compressed container
+bool CompressedImage::isContainerFile(const std::string& filePath)
+{
+    std::string extension = filePath.substr(filePath.find_last_of('.') + 1);
+    for (char& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == "ktx" || extension == "dds";
+}
+
+// Bytes of texture memory the surfaces take on the GPU
+size_t CompressedImage::getCompressedBytes() const
+{
+    size_t total = 0;
+    for (const Surface& surface : surfaces) {
+        total += surface.size;
+    }
+    return total;
+}
+
+// Read a KTX or DDS file
+CompressedImage CompressedImage::loadFromFile(const std::string& filePath)
+{
+    CompressedImage image;
+    image.source = filePath;
+
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        image.logError("Failed to open file: " + filePath);
+        return CompressedImage();
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    image.data.resize(static_cast<size_t>(size));
+    if (size <= 0 || !file.read(reinterpret_cast<char*>(image.data.data()), size))
+    {
+        image.logError("Failed to read file: " + filePath);
+        return CompressedImage();
+    }
+
+    // Pick the parser by signature rather than by extension
+    bool parsed = false;
+    if (image.data.size() >= 12 && std::memcmp(image.data.data(), KTX_IDENTIFIER, 12) == 0)
+        parsed = image.parseKTX();
+    else if (image.data.size() >= 4 && readU32(image.data.data()) == fourCC('D', 'D', 'S', ' '))
+        parsed = image.parseDDS();
+    else
+        image.logError("Not a KTX or DDS file: " + filePath);
+
+    if (!parsed) {
+        return CompressedImage();
+    }
+    return image;
+}
+
+// Write the image as a KTX 1 file
+bool CompressedImage::saveKTX(const std::string& filePath) const
+{
+    if (!isValid())
+    {
+        logError("Attempted to save an empty compressed image: " + filePath);
+        return false;
+    }
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        logError("Failed to open file for writing: " + filePath);
+        return false;
+    }
+    auto writeU32 = [&file](uint32_t value) {
+        unsigned char bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+        file.write(reinterpret_cast<const char*>(bytes), 4);
+    };
+
+    file.write(reinterpret_cast<const char*>(KTX_IDENTIFIER), 12);
+    writeU32(0x04030201); // Endianness
+    writeU32(0);          // glType (0 = compressed)
+    writeU32(1);          // glTypeSize
+    writeU32(0);          // glFormat (0 = compressed)
+    writeU32(internalFormat);
+    writeU32(TextureCompression::getBlockBytes(internalFormat) == 8 && internalFormat != GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? GL_RGB : GL_RGBA);
+    writeU32(static_cast<uint32_t>(width));
+    writeU32(static_cast<uint32_t>(height));
+    writeU32(0);          // pixelDepth (2D)
+    writeU32(0);          // numberOfArrayElements (not an array)
+    writeU32(static_cast<uint32_t>(faceCount));
+    writeU32(static_cast<uint32_t>(levelCount));
+    writeU32(0);          // bytesOfKeyValueData
+
+    // Mip-major: each level's size, then that level of every face
+    for (int level = 0; level < levelCount; level++)
+    {
+        bool sizeWritten = false;
+        for (int face = 0; face < faceCount; face++)
+        {
+            for (const Surface& surface : surfaces)
+            {
+                if (surface.level != level || surface.face != face) {
+                    continue;
+                }
+                if (!sizeWritten)
+                {
+                    writeU32(static_cast<uint32_t>(surface.size));
+                    sizeWritten = true;
+                }
+                file.write(reinterpret_cast<const char*>(data.data() + surface.offset), static_cast<std::streamsize>(surface.size));
+                // Block sizes are multiples of 8 bytes, so no padding is needed
+            }
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+// Parse a KTX 1 container. Layout: header, key/value data, then for each mip level
+// a uint32 imageSize followed by the faces of that level (mip-major order).
+bool CompressedImage::parseKTX()
+{
+    const size_t HEADER_SIZE = 64;
+    if (data.size() < HEADER_SIZE)
+    {
+        logError("Truncated KTX header: " + source);
+        return false;
+    }
+
+    // Header fields after the 12-byte identifier, in the writer's byte order
+    const unsigned char* header = data.data() + 12;
+    bool swap = readU32(header) == 0x01020304; // Written big-endian
+    auto field = [&](int index) {
+        uint32_t value = readU32(header + index * 4);
+        return swap ? __builtin_bswap32(value) : value;
+    };
+    uint32_t glType = field(1);
+    uint32_t glInternalFormat = field(4);
+    uint32_t pixelWidth = field(6);
+    uint32_t pixelHeight = field(7);
+    uint32_t pixelDepth = field(8);
+    uint32_t arrayElements = field(9);
+    uint32_t faces = field(10);
+    uint32_t mipLevels = std::max(field(11), 1u); // 0 means "generate at load", we only have level 0
+    uint32_t keyValueBytes = field(12);
+
+    if (glType != 0 || TextureCompression::getBlockBytes(glInternalFormat) == 0)
+    {
+        logError("KTX file is not in a supported block-compressed format: " + source);
+        return false;
+    }
+    if (pixelDepth > 1 || arrayElements > 0 || (faces != 1 && faces != 6))
+    {
+        logError("Only 2D and cubemap KTX textures are supported: " + source);
+        return false;
+    }
+
+    internalFormat = glInternalFormat;
+    width = static_cast<int>(pixelWidth);
+    height = static_cast<int>(std::max(pixelHeight, 1u));
+    faceCount = static_cast<int>(faces);
+    levelCount = static_cast<int>(mipLevels);
+
+    size_t offset = HEADER_SIZE + keyValueBytes;
+    for (int level = 0; level < levelCount; level++)
+    {
+        if (offset + 4 > data.size())
+        {
+            logError("Truncated KTX mip level " + std::to_string(level) + ": " + source);
+            return false;
+        }
+        uint32_t imageSize = readU32(data.data() + offset);
+        if (swap) {
+            imageSize = __builtin_bswap32(imageSize);
+        }
+        offset += 4;
+
+        int levelWidth = std::max(width >> level, 1);
+        int levelHeight = std::max(height >> level, 1);
+        for (int face = 0; face < faceCount; face++)
+        {
+            if (offset + imageSize > data.size())
+            {
+                logError("Truncated KTX mip level " + std::to_string(level) + ": " + source);
+                return false;
+            }
+            surfaces.push_back({ face, level, levelWidth, levelHeight, offset, imageSize });
+            // Each face is padded to 4 bytes (compressed blocks already are)
+            offset += (imageSize + 3) & ~size_t(3);
+        }
+    }
+    return true;
+}
+
+// Parse a DDS container. Layout: "DDS ", 124-byte header, optional 20-byte DX10 header,
+// then for each face all of its mip levels (face-major order).
+bool CompressedImage::parseDDS()
+{
+    const size_t HEADER_SIZE = 4 + 124;
+    if (data.size() < HEADER_SIZE)
+    {
+        logError("Truncated DDS header: " + source);
+        return false;
+    }
+
+    const unsigned char* header = data.data() + 4;
+    uint32_t ddsHeight = readU32(header + 8);
+    uint32_t ddsWidth = readU32(header + 12);
+    uint32_t mipMapCount = readU32(header + 24);
+    uint32_t pixelFormatFlags = readU32(header + 76);
+    uint32_t pixelFourCC = readU32(header + 80);
+    uint32_t caps2 = readU32(header + 108);
+
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+    if (!(pixelFormatFlags & DDPF_FOURCC))
+    {
+        logError("DDS file is not block-compressed: " + source);
+        return false;
+    }
+
+    size_t offset = HEADER_SIZE;
+    bool cubemap = (caps2 & DDSCAPS2_CUBEMAP) != 0;
+    switch (pixelFourCC)
+    {
+        case fourCC('D', 'X', 'T', '1'): internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+        case fourCC('D', 'X', 'T', '3'): internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+        case fourCC('D', 'X', 'T', '5'): internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+        case fourCC('A', 'T', 'I', '1'):
+        case fourCC('B', 'C', '4', 'U'): internalFormat = GL_COMPRESSED_RED_RGTC1; break;
+        case fourCC('A', 'T', 'I', '2'):
+        case fourCC('B', 'C', '5', 'U'): internalFormat = GL_COMPRESSED_RG_RGTC2; break;
+        case fourCC('D', 'X', '1', '0'):
+        {
+            // The extended header names the format with a DXGI_FORMAT value
+            if (data.size() < HEADER_SIZE + 20)
+            {
+                logError("Truncated DDS DX10 header: " + source);
+                return false;
+            }
+            const unsigned char* dx10 = data.data() + HEADER_SIZE;
+            uint32_t dxgiFormat = readU32(dx10);
+            uint32_t miscFlag = readU32(dx10 + 8);
+            uint32_t arraySize = readU32(dx10 + 12);
+            const uint32_t RESOURCE_MISC_TEXTURECUBE = 0x4;
+            cubemap = (miscFlag & RESOURCE_MISC_TEXTURECUBE) != 0;
+            if (arraySize > 1)
+            {
+                logError("DDS texture arrays are not supported: " + source);
+                return false;
+            }
+            switch (dxgiFormat)
+            {
+                case 71: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;        // BC1_UNORM
+                case 72: internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; break;        // BC1_UNORM_SRGB
+                case 74: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;        // BC2_UNORM
+                case 77: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;        // BC3_UNORM
+                case 78: internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;  // BC3_UNORM_SRGB
+                case 80: internalFormat = GL_COMPRESSED_RED_RGTC1; break;                 // BC4_UNORM
+                case 81: internalFormat = GL_COMPRESSED_SIGNED_RED_RGTC1; break;          // BC4_SNORM
+                case 83: internalFormat = GL_COMPRESSED_RG_RGTC2; break;                  // BC5_UNORM
+                case 84: internalFormat = GL_COMPRESSED_SIGNED_RG_RGTC2; break;           // BC5_SNORM
+                case 98: internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;           // BC7_UNORM
+                case 99: internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;     // BC7_UNORM_SRGB
+                default:
+                    logError("Unsupported DDS DXGI format " + std::to_string(dxgiFormat) + ": " + source);
+                    return false;
+            }
+            offset += 20;
+            break;
+        }
+        default:
+            logError("Unsupported DDS FourCC format: " + source);
+            return false;
+    }
+
+    width = static_cast<int>(ddsWidth);
+    height = static_cast<int>(ddsHeight);
+    faceCount = cubemap ? 6 : 1;
+    levelCount = static_cast<int>(std::max(mipMapCount, 1u));
+
+    for (int face = 0; face < faceCount; face++)
+    {
+        for (int level = 0; level < levelCount; level++)
+        {
+            int levelWidth = std::max(width >> level, 1);
+            int levelHeight = std::max(height >> level, 1);
+            size_t size = TextureCompression::getLevelSize(internalFormat, levelWidth, levelHeight);
+            if (offset + size > data.size())
+            {
+                logError("Truncated DDS mip level " + std::to_string(level) + ": " + source);
+                return false;
+            }
+            surfaces.push_back({ face, level, levelWidth, levelHeight, offset, size });
+            offset += size;
+        }
+    }
+    return true;
+}
+
+// Utility function for reporting errors
+void CompressedImage::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::COMPRESSEDIMAGE::" << message << std::endl;
+}
@@ -0,0 +1,64 @@
+#ifndef COMPRESSEDIMAGE_H
+#define COMPRESSEDIMAGE_H
+
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+// A block-compressed image with its precomputed mip chain, read from a KTX (version 1)
+// or DDS container. The file is read into one buffer and each surface (one mip level
+// of one face) is an offset into it, ready for glCompressedTexImage2D.
+//
+// Surfaces are uploaded as stored: the first row is the top of the image, while
+// Texture::load flips stb_image files so the first row is the bottom. Export
+// compressed textures vertically flipped to match.
+struct CompressedImage
+{
+    // One mip level of one face
+    struct Surface
+    {
+        int face = 0;   // 0 for 2D textures, 0..5 (+X, -X, +Y, -Y, +Z, -Z) for cubemaps
+        int level = 0;  // Mip level, 0 = full size
+        int width = 0;
+        int height = 0;
+        size_t offset = 0; // Byte offset into data
+        size_t size = 0;   // Byte size
+    };
+
+    GLenum internalFormat = 0; // e.g. GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    int width = 0;
+    int height = 0;
+    int faceCount = 0;  // 1 for 2D textures, 6 for cubemaps
+    int levelCount = 0; // Mip levels stored in the file
+    std::vector<Surface> surfaces;
+    std::vector<unsigned char> data; // The whole file
+
+    // Path the image was read from, for error messages
+    std::string source;
+
+    // Check if the image was read successfully
+    bool isValid() const { return internalFormat != 0 && !surfaces.empty(); }
+
+    // Bytes of texture memory the surfaces take on the GPU
+    size_t getCompressedBytes() const;
+
+    // Read a KTX or DDS file (chosen by its signature). No OpenGL calls, safe on a worker thread.
+    // Returns an invalid image on failure; errors will be printed to cerr.
+    static CompressedImage loadFromFile(const std::string& filePath);
+
+    // Write the image as a KTX 1 file (little-endian). Returns true on success.
+    bool saveKTX(const std::string& filePath) const;
+
+    // Check if the path names a compressed container (.ktx or .dds extension)
+    static bool isContainerFile(const std::string& filePath);
+
+private:
+    // Parse the container held in data (filled by loadFromFile)
+    bool parseKTX();
+    bool parseDDS();
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // COMPRESSEDIMAGE_H
@@ -1,6 +1,16 @@
-#include <stb_image.h>
+#include <chrono>  // For timing the load
+#include <cstring> // For std::memcpy
+#include <future>  // For the per-face decode jobs
+#include <memory>  // For handing the pixels to the streamer
 
 #include "CubeTexture.h"
+#include "RenderState.h"
+#include "ThreadPool.h"
+#include "Texture.h"            // For Texture::getFallbackPath
+#include "CompressedImage.h"
+#include "ImageDecoder.h"
+#include "TextureCompression.h"
+#include "TextureStreamer.h"
 
 // Constructor: Stores the file paths
 CubeTexture::CubeTexture(const std::vector<std::string>& faces) : faces(faces) // Initialize faces vector
@@ -12,13 +22,15 @@ CubeTexture::CubeTexture(const std::vector<std::string>& faces) : faces(faces) /
 CubeTexture::~CubeTexture()
 {
     if (ID != 0) { // Only delete if a valid texture was created
+        RenderState::onTextureDeleted(ID);
         glDeleteTextures(1, &ID);
     }
 }
 
 // Move constructor
 CubeTexture::CubeTexture(CubeTexture&& other) noexcept
-: ID(other.ID), faces(std::move(other.faces)) // Move ID and faces
+: ID(other.ID), faces(std::move(other.faces)), // Move ID and faces
+loadTimeMs(other.loadTimeMs)
 {
     other.ID = 0; // Set other's ID to 0 to prevent double deletion
 }
@@ -28,11 +40,13 @@ CubeTexture& CubeTexture::operator=(CubeTexture&& other) noexcept
 {
     if (this != &other) {
         if (ID != 0) { // Delete our own texture if it exists
+            RenderState::onTextureDeleted(ID);
             glDeleteTextures(1, &ID);
         }
         
         ID = other.ID; // Transfer ownership of ID
         faces = std::move(other.faces); // Move faces vector
+        loadTimeMs = other.loadTimeMs;
         
         other.ID = 0; // Set other's ID to 0
     }
@@ -48,41 +62,238 @@ bool CubeTexture::load()
         return false; // Already loaded
     }
     
-    if (faces.size() != 6) {
-        logError("Cubemap requires exactly 6 faces, but " + std::to_string(faces.size()) + " were provided.");
+    if (!faces.empty() && CompressedImage::isContainerFile(faces[0]))
+    {
+        if (loadCompressed()) {
+            return true;
+        }
+        
+        // Not readable or not supported by this context: use the uncompressed originals
+        std::vector<std::string> fallbackFaces;
+        for (const std::string& face : faces)
+        {
+            std::string fallbackPath = Texture::getFallbackPath(face);
+            if (fallbackPath.empty())
+            {
+                logError("No uncompressed fallback found for " + face);
+                return false;
+            }
+            fallbackFaces.push_back(fallbackPath);
+        }
+        std::cerr << "WARNING::CUBETEXTURE::LOAD::USING_FALLBACK_FACES" << std::endl;
+        return loadFaces(fallbackFaces);
+    }
+    
+    return loadFaces(faces);
+}
+
+// Load a block-compressed cubemap: one KTX / DDS cubemap file, or six single-face files
+bool CubeTexture::loadCompressed()
+{
+    auto loadStart = std::chrono::steady_clock::now();
+    
+    // Read the file(s); faceImages[i] holds face i (all point at the same image for a single file)
+    std::vector<CompressedImage> images;
+    std::vector<std::pair<const CompressedImage*, int>> faceImages; // Image and face index within it
+    if (faces.size() == 1)
+    {
+        images.push_back(CompressedImage::loadFromFile(faces[0]));
+        if (!images[0].isValid()) {
+            return false;
+        }
+        if (images[0].faceCount != 6)
+        {
+            logError("Compressed file is not a cubemap: " + faces[0]);
+            return false;
+        }
+        for (int face = 0; face < 6; face++) {
+            faceImages.push_back({ &images[0], face });
+        }
+    }
+    else if (faces.size() == 6)
+    {
+        images.reserve(6); // Keep the pointers below valid
+        for (const std::string& face : faces)
+        {
+            images.push_back(CompressedImage::loadFromFile(face));
+            if (!images.back().isValid()) {
+                return false;
+            }
+            faceImages.push_back({ &images.back(), 0 });
+        }
+    }
+    else
+    {
+        logError("Compressed cubemap requires 1 cubemap file or 6 face files, but " + std::to_string(faces.size()) + " were provided.");
+        return false;
+    }
+    
+    // Every face must be square and share the first face's size, format and mip count
+    const CompressedImage& first = *faceImages[0].first;
+    for (const auto& [image, face] : faceImages)
+    {
+        if (image->width != image->height || image->width != first.width ||
+            image->internalFormat != first.internalFormat || image->levelCount != first.levelCount)
+        {
+            logError("Compressed cubemap faces must be square and match in size, format and mip count: " + image->source);
+            return false;
+        }
+    }
+    if (!TextureCompression::isSupported(first.internalFormat))
+    {
+        std::cerr << "WARNING::CUBETEXTURE::LOAD::UNSUPPORTED_COMPRESSED_FORMAT "
+                  << TextureCompression::getFormatName(first.internalFormat) << std::endl;
         return false;
     }
     
     glGenTextures(1, &ID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, ID);
+    for (unsigned int i = 0; i < faceImages.size(); i++)
+    {
+        const auto& [image, face] = faceImages[i];
+        for (const CompressedImage::Surface& surface : image->surfaces)
+        {
+            if (surface.face != face) {
+                continue;
+            }
+            glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, surface.level, image->internalFormat,
+                                   surface.width, surface.height, 0, static_cast<GLsizei>(surface.size),
+                                   image->data.data() + surface.offset);
+        }
+    }
+    
+    // Use the stored mip chain, if there is one
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, first.levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, first.levelCount - 1);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
+    
+    std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+    loadTimeMs = loadTime.count();
+    std::cout << "Compressed cubemap (" << TextureCompression::getFormatName(first.internalFormat) << ", "
+              << first.levelCount << " levels) loaded in " << loadTimeMs << " ms" << std::endl;
+    return true;
+}
+
+// Decode six image files in parallel and upload them
+bool CubeTexture::loadFaces(const std::vector<std::string>& faces)
+{
+    if (faces.size() != 6) {
+        logError("Cubemap requires exactly 6 faces, but " + std::to_string(faces.size()) + " were provided.");
+        return false;
+    }
     
-    int width, height, nrChannels;
-    // Set stb_image to flip loaded textures vertically (important for some image formats)
-    stbi_set_flip_vertically_on_load(false); // Cubemaps should NOT be flipped vertically
+    auto loadStart = std::chrono::steady_clock::now();
     
+    // 1. Read the headers only, and check the faces match: a cubemap needs six square faces of one size
+    int width = 0, height = 0, nrChannels = 0;
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        std::string facePath = faces[i];
-        unsigned char *data = stbi_load(facePath.c_str(), &width, &height, &nrChannels, 0);
-        if (data)
+        int faceWidth, faceHeight, faceChannels;
+        if (!ImageDecoder::readInfo(faces[i], faceWidth, faceHeight, faceChannels))
         {
-            GLenum format = GL_RGB;
-            if (nrChannels == 4)
-                format = GL_RGBA;
-            
-            // Load image data into the correct cubemap face
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
+            logError("Cubemap texture failed to load at path: " + faces[i]);
+            return false;
+        }
+        if (i == 0)
+        {
+            width = faceWidth;
+            height = faceHeight;
+            nrChannels = faceChannels;
+        }
+        if (faceWidth != faceHeight || faceWidth != width || faceHeight != height)
+        {
+            logError("Cubemap faces must be square and of the same size: " + faces[i] + " is " +
+                     std::to_string(faceWidth) + "x" + std::to_string(faceHeight) + ", expected " +
+                     std::to_string(width) + "x" + std::to_string(height));
+            return false;
         }
-        else
+        // Faces with a different channel count are converted to the first face's on decode
+    }
+    
+    GLenum format = GL_RGB;
+    if (nrChannels == 4)
+        format = GL_RGBA;
+    else
+        nrChannels = 3; // Grey / grey-alpha faces are expanded to RGB
+    
+    // 2. One allocation for all six faces, each decoded into its own slice by a worker
+    const size_t faceBytes = static_cast<size_t>(width) * height * nrChannels;
+    std::vector<unsigned char> pixels(faceBytes * faces.size());
+    std::vector<std::future<bool>> decodeJobs;
+    decodeJobs.reserve(faces.size());
+    for (unsigned int i = 0; i < faces.size(); i++)
+    {
+        unsigned char* slice = pixels.data() + faceBytes * i;
+        const std::string& facePath = faces[i];
+        decodeJobs.push_back(ThreadPool::shared().submit([&facePath, slice, faceBytes, nrChannels]() {
+            // Cubemaps should NOT be flipped vertically (a per-call option, other decodes are unaffected)
+            DecodeOptions options;
+            options.flipVertically = false;
+            options.channels = nrChannels;
+            Image face = ImageDecoder::decode(facePath, options);
+            if (face.pixels.size() != faceBytes) {
+                return false;
+            }
+            std::memcpy(slice, face.pixels.data(), faceBytes);
+            return true;
+        }));
+    }
+    
+    // Wait for every job before returning: they write into 'pixels'
+    bool decoded = true;
+    for (unsigned int i = 0; i < faces.size(); i++)
+    {
+        if (!decodeJobs[i].get())
         {
             logError("Cubemap texture failed to load at path: " + faces[i]);
-            stbi_image_free(data); // Still free data even if loading failed
-            // Clean up the partially created texture to avoid issues
-            glDeleteTextures(1, &ID);
-            ID = 0; // Mark as invalid
-            return false; // Loading failed
+            decoded = false;
+        }
+    }
+    if (!decoded) {
+        return false; // Loading failed
+    }
+    auto decodeEnd = std::chrono::steady_clock::now();
+    
+    // 3. Upload all faces in one pass (or allocate them, and let the streamer fill them in)
+    glGenTextures(1, &ID);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, ID);
+    if (streamer)
+    {
+        auto streamed = std::make_shared<std::vector<unsigned char>>(std::move(pixels));
+        TextureStreamer::Upload upload;
+        upload.texture = ID;
+        upload.bindTarget = GL_TEXTURE_CUBE_MAP;
+        upload.format = format;
+        upload.channels = nrChannels;
+        for (unsigned int i = 0; i < faces.size(); i++)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+            upload.regions.push_back({ GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, width, height, streamed->data() + faceBytes * i });
+        }
+        upload.keepAlive = streamed;
+        upload.onComplete = [this, loadStart, decodeEnd, width, height]() {
+            std::chrono::duration<double, std::milli> decodeTime = decodeEnd - loadStart;
+            std::chrono::duration<double, std::milli> streamTime = std::chrono::steady_clock::now() - decodeEnd;
+            loadTimeMs = decodeTime.count() + streamTime.count();
+            std::cout << "Cubemap streamed in " << loadTimeMs << " ms (decode " << decodeTime.count()
+                      << " ms, streaming " << streamTime.count() << " ms, " << width << "x" << height << " faces)" << std::endl;
+        };
+        streamer->enqueue(std::move(upload));
+    }
+    else
+    {
+        // Rows are tightly packed, which breaks the default 4-byte alignment for odd RGB widths
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (unsigned int i = 0; i < faces.size(); i++)
+        {
+            // Load image data into the correct cubemap face
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels.data() + faceBytes * i);
         }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     }
     
     // Set texture parameters
@@ -93,7 +304,19 @@ bool CubeTexture::load()
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     
     // Unbind texture after configuration
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
+    if (streamer) {
+        return true; // Timing is reported when the last face arrives
+    }
+    
+    // Report the load time (glFinish so the upload is included, not just queued)
+    glFinish();
+    auto loadEnd = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> decodeTime = decodeEnd - loadStart;
+    std::chrono::duration<double, std::milli> uploadTime = loadEnd - decodeEnd;
+    loadTimeMs = decodeTime.count() + uploadTime.count();
+    std::cout << "Cubemap loaded in " << loadTimeMs << " ms (decode " << decodeTime.count()
+              << " ms, upload " << uploadTime.count() << " ms, " << width << "x" << height << " faces)" << std::endl;
     
     // Loading successful
     return true;
@@ -103,8 +326,7 @@ bool CubeTexture::load()
 void CubeTexture::bind(GLuint textureUnit) const
 {
     if (ID != 0) { // Only bind if valid
-        glActiveTexture(GL_TEXTURE0 + textureUnit);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+        RenderState::bindTexture(textureUnit, GL_TEXTURE_CUBE_MAP, ID);
     } else {
         logError("Attempted to bind an invalid cubemap texture.");
     }
@@ -113,10 +335,8 @@ void CubeTexture::bind(GLuint textureUnit) const
 // Unbind the cubemap texture
 void CubeTexture::unbind(unsigned int textureUnit) const
 {
-    // Activate the specified texture unit
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    // Unbind the texture from the currently active texture unit
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    // Unbind the cubemap from the specified texture unit
+    RenderState::bindTexture(textureUnit, GL_TEXTURE_CUBE_MAP, 0);
 }
 
 // Utility function for reporting errors
@@ -7,6 +7,8 @@
 
 #include <iostream>
 
+class TextureStreamer;
+
 class CubeTexture
 {
 public:
@@ -25,12 +27,23 @@ public:
     CubeTexture& operator=(CubeTexture&& other) noexcept;
 
     // Method to load the images, create the OpenGL cubemap texture, and configure it.
+    // The six faces are decoded concurrently on the shared thread pool into one
+    // contiguous block, checked to be square and of matching size, then uploaded in one pass.
+    // Block-compressed faces are also accepted: either one KTX / DDS cubemap file, or six
+    // single-face KTX / DDS files. If the context cannot sample their format, image files
+    // with the same names (.png, .jpg, .jpeg, .tga) are loaded instead.
     // This must be called AFTER creating the CubeTexture object and
     // AFTER a valid OpenGL context has been made current.
     // Returns true on success, false on failure.
     // Errors will be printed to cerr.
     bool load();
 
+    // Stream the faces of the next load() through a TextureStreamer instead of uploading them at once.
+    // load() then returns once the faces are decoded; the texture is valid immediately and its
+    // faces fill in over the following frames (the streamer must outlive the upload, and this
+    // object must not be moved before it completes). Compressed faces are always uploaded directly.
+    void setStreamer(TextureStreamer* streamer) { this->streamer = streamer; }
+
     // Bind the cubemap texture to a specific texture unit.
     // Only safe to call if isValid() is true.
     void bind(GLuint textureUnit = 0) const; // Default to texture unit 0
@@ -44,9 +57,21 @@ public:
     // Get the OpenGL texture ID.
     GLuint getID() const { return ID; }
 
+    // Get the time taken by the last load(), in milliseconds (decode + upload).
+    // When streaming, this is set once the last face has arrived.
+    double getLoadTimeMs() const { return loadTimeMs; }
+
 private:
     GLuint ID = 0; // The OpenGL texture ID (0 indicates invalid/not loaded)
     std::vector<std::string> faces; // Stored file paths to the cubemap faces
+    double loadTimeMs = 0.0; // Time taken by the last load()
+    TextureStreamer* streamer = nullptr; // Upload path for image faces (nullptr = direct)
+
+    // Helper function to load block-compressed faces with their stored mip chains
+    bool loadCompressed();
+
+    // Helper function to decode six image files in parallel and upload them
+    bool loadFaces(const std::vector<std::string>& faces);
 
     // Utility function for reporting errors
     void logError(const std::string& message) const;
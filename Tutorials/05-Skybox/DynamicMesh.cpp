@@ -0,0 +1,276 @@
+#include "DynamicMesh.h"
+
+#include <algorithm> // For std::min
+#include <chrono>    // For timing fence waits
+#include <cstring>   // For std::memcpy
+
+#include "Shader.h"
+#include "ShaderStage.h"
+#include "ProgramPipeline.h"
+#include "RenderState.h"
+
+// Longest time update() blocks on a fence before falling back to orphaning (1 second)
+static constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000ull;
+
+// Constructor: Stores the capacity and primitive type
+DynamicMesh::DynamicMesh(size_t maxVertices, GLenum primitive)
+: maxVertices(maxVertices), primitive(primitive)
+{
+    // OpenGL buffers and VAO are generated in the setup() method.
+}
+
+// Destructor: Deletes the fences, the buffer and the VAO
+DynamicMesh::~DynamicMesh()
+{
+    release();
+}
+
+// Move constructor
+DynamicMesh::DynamicMesh(DynamicMesh&& other) noexcept
+: maxVertices(other.maxVertices), primitive(other.primitive), shader(other.shader),
+pipeline(other.pipeline), vertexStage(other.vertexStage), fragmentStage(other.fragmentStage),
+VAO(other.VAO), VBO(other.VBO),
+currentSegment(other.currentSegment), currentVertexCount(other.currentVertexCount),
+currentSegmentUsed(other.currentSegmentUsed), fences(other.fences), stats(other.stats)
+{
+    // Set other's IDs to 0 to prevent double deletion
+    other.VAO = 0;
+    other.VBO = 0;
+    other.fences = {};
+    other.shader = nullptr;
+    other.pipeline = nullptr;
+}
+
+// Move assignment operator
+DynamicMesh& DynamicMesh::operator=(DynamicMesh&& other) noexcept
+{
+    if (this != &other) // Prevent self-assignment
+    {
+        release();
+
+        maxVertices = other.maxVertices;
+        primitive = other.primitive;
+        shader = other.shader;
+        pipeline = other.pipeline;
+        vertexStage = other.vertexStage;
+        fragmentStage = other.fragmentStage;
+        VAO = other.VAO;
+        VBO = other.VBO;
+        currentSegment = other.currentSegment;
+        currentVertexCount = other.currentVertexCount;
+        currentSegmentUsed = other.currentSegmentUsed;
+        fences = other.fences;
+        stats = other.stats;
+
+        other.VAO = 0;
+        other.VBO = 0;
+        other.fences = {};
+        other.shader = nullptr;
+        other.pipeline = nullptr;
+    }
+    return *this;
+}
+
+// Helper function to delete the fences and OpenGL objects
+void DynamicMesh::release()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+    if (VAO != 0)
+    {
+        RenderState::onVertexArrayDeleted(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+    }
+    VAO = VBO = 0;
+}
+
+// Create the ring buffer and VAO
+bool DynamicMesh::setup()
+{
+    if (maxVertices == 0)
+    {
+        logError("SETUP::Attempted to setup a dynamic mesh with zero capacity.");
+        return false;
+    }
+
+    // Clean up any existing OpenGL objects if setup is called multiple times
+    release();
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    if (VAO == 0 || VBO == 0)
+    {
+        logError("SETUP::Failed to generate the VAO or vertex buffer.");
+        release();
+        return false;
+    }
+
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    // Allocate every segment up front; the contents are written by update()
+    glBufferData(GL_ARRAY_BUFFER, segmentBytes() * SEGMENT_COUNT, nullptr, GL_STREAM_DRAW);
+    // Attribute offsets are relative to the buffer start: draw() selects the segment with 'first'
+    StandardVertexLayout::describe().apply();
+    RenderState::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    currentSegment = SEGMENT_COUNT - 1; // The first update() writes segment 0
+    currentVertexCount = 0;
+    currentSegmentUsed = false;
+    stats = Stats();
+    return true;
+}
+
+// Block until the GPU has finished reading the given segment
+bool DynamicMesh::waitForSegment(unsigned int segment)
+{
+    GLsync& fence = fences[segment];
+    if (!fence) {
+        return true; // Nothing pending
+    }
+
+    // Fast path: the GPU is already done with it
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        // The CPU is SEGMENT_COUNT frames ahead: wait, and record that we did
+        auto waitStart = std::chrono::steady_clock::now();
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+        stats.fenceWaits++;
+        stats.fenceWaitMs += waited.count();
+    }
+
+    glDeleteSync(fence);
+    fence = 0;
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+// Fallback: give the buffer new storage so no pending draw is affected
+void DynamicMesh::orphanBuffer()
+{
+    glBufferData(GL_ARRAY_BUFFER, segmentBytes() * SEGMENT_COUNT, nullptr, GL_STREAM_DRAW);
+    // Pending draws keep reading the old storage, so no segment of the new one is in use
+    for (GLsync& fence : fences)
+    {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+    stats.orphans++;
+}
+
+// Write this frame's vertices into the next ring segment
+void DynamicMesh::update(std::span<const Vertex> vertices)
+{
+    if (VAO == 0) {
+        logError("UPDATE::Attempted to update an invalid dynamic mesh.");
+        return;
+    }
+
+    if (vertices.size() > maxVertices) {
+        std::cerr << "WARNING::DYNAMICMESH::UPDATE::TOO_MANY_VERTICES (" << vertices.size()
+                  << " > " << maxVertices << "), extra vertices are dropped" << std::endl;
+        vertices = vertices.first(maxVertices);
+    }
+
+    // Nothing to write: keep the current segment (it is fenced by the next real update), draw() will skip
+    stats.bytesUploaded = 0;
+    if (vertices.empty()) {
+        currentVertexCount = 0;
+        return;
+    }
+
+    // The draws that read the previous segment have been issued: fence them
+    if (currentSegmentUsed)
+    {
+        fences[currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        currentSegmentUsed = false;
+    }
+
+    // Advance to the next segment
+    currentSegment = (currentSegment + 1) % SEGMENT_COUNT;
+    currentVertexCount = vertices.size();
+    currentSegmentUsed = true;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    bool segmentFree = waitForSegment(currentSegment);
+    if (!segmentFree) {
+        orphanBuffer();
+    }
+
+    // No synchronization by the driver: the fence above guarantees the GPU is not reading this range
+    GLintptr offset = static_cast<GLintptr>(currentSegment * segmentBytes());
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, vertices.size_bytes(),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped)
+    {
+        std::memcpy(mapped, vertices.data(), vertices.size_bytes());
+        if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE)
+        {
+            // The storage was lost while mapped (rare): rewrite it the slow way
+            orphanBuffer();
+            glBufferSubData(GL_ARRAY_BUFFER, offset, vertices.size_bytes(), vertices.data());
+        }
+    }
+    else
+    {
+        // Mapping failed: orphan, then the driver can take the write without waiting on pending draws
+        orphanBuffer();
+        glBufferSubData(GL_ARRAY_BUFFER, offset, vertices.size_bytes(), vertices.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    stats.bytesUploaded = vertices.size_bytes();
+    stats.totalBytesUploaded += vertices.size_bytes();
+}
+
+// Draw the vertices written by the last update()
+void DynamicMesh::draw(const glm::mat4& model) const
+{
+    if (VAO == 0) {
+        logError("DRAW::Attempted to draw an invalid dynamic mesh.");
+        return;
+    }
+
+    // Ensure a shader (or a complete set of stages) is assigned to this mesh
+    const bool useStages = pipeline && vertexStage && vertexStage->isValid() && fragmentStage && fragmentStage->isValid();
+    if (!useStages && (!shader || !shader->isValid())) {
+        std::cerr << "ERROR::DYNAMICMESH::DRAW::NO_SHADER_ASSIGNED_OR_LOADED" << std::endl;
+        return; // Cannot draw without a valid shader
+    }
+
+    if (currentVertexCount == 0) {
+        return; // Nothing to draw
+    }
+
+    if (useStages)
+    {
+        pipeline->bind(*vertexStage, *fragmentStage); // Only a stage that changed is swapped
+        vertexStage->setMat4("uModel", model);
+    }
+    else
+    {
+        shader->use();
+        shader->setMat4("uModel", model);
+    }
+
+    RenderState::bindVertexArray(VAO);
+    // Select the current segment by its first vertex
+    GLint first = static_cast<GLint>(currentSegment * maxVertices);
+    glDrawArrays(primitive, first, static_cast<GLsizei>(currentVertexCount));
+}
+
+// Utility function for reporting errors
+void DynamicMesh::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::DYNAMICMESH::" << message << std::endl;
+}
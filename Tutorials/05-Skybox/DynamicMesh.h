@@ -0,0 +1,127 @@
+#ifndef DYNAMICMESH_H
+#define DYNAMICMESH_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <span>
+#include <string>
+#include <iostream>
+
+#include "VertexLayout.h" // For Vertex and StandardVertexLayout
+
+class Shader;
+class ShaderStage;
+class ProgramPipeline;
+
+// A mesh whose vertices are rewritten every frame (debug lines, particles, deforming meshes).
+//
+// The vertex buffer is a ring of SEGMENT_COUNT segments, each large enough for maxVertices.
+// Each update() writes into the next segment with glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT),
+// so the driver never waits for the GPU to finish reading the buffer. Instead, a fence is
+// inserted after the draws that read a segment, and the segment is only reused once its
+// fence has signaled. With three segments the CPU can run two frames ahead before it waits.
+// If the buffer cannot be mapped, or a fence never signals, the whole buffer is orphaned
+// (glBufferData with nullptr) as a fallback.
+class DynamicMesh
+{
+public:
+    // Number of ring segments (frames the CPU may be ahead of the GPU, plus one)
+    static constexpr unsigned int SEGMENT_COUNT = 3;
+
+    // Upload metrics, to check that per-frame uploads do not stall
+    struct Stats
+    {
+        size_t bytesUploaded = 0;       // Bytes written by the last update()
+        size_t totalBytesUploaded = 0;  // Bytes written since setup()
+        unsigned int fenceWaits = 0;    // Updates that found their segment still in use by the GPU
+        double fenceWaitMs = 0.0;       // Total time spent blocked on those fences
+        unsigned int orphans = 0;       // Times the buffer was orphaned instead of mapped unsynchronized
+    };
+
+    // Constructor: Stores the capacity and primitive type (GL_TRIANGLES, GL_LINES, GL_POINTS, ...).
+    // Does NOT generate OpenGL buffers or VAO here.
+    DynamicMesh(size_t maxVertices, GLenum primitive = GL_TRIANGLES);
+
+    // Destructor: Deletes the fences, the buffer and the VAO.
+    ~DynamicMesh();
+
+    // Prevent copying (owns OpenGL objects)
+    DynamicMesh(const DynamicMesh&) = delete;
+    DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+    // Allow moving (transfer ownership of OpenGL IDs)
+    DynamicMesh(DynamicMesh&& other) noexcept;
+    DynamicMesh& operator=(DynamicMesh&& other) noexcept;
+
+    // Create the ring buffer and VAO (StandardVertexLayout attributes).
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure.
+    bool setup();
+
+    // Write this frame's vertices into the next ring segment.
+    // Vertices beyond maxVertices are dropped with a warning. An empty list only clears
+    // what draw() renders: the ring does not advance and no fence is inserted.
+    void update(std::span<const Vertex> vertices);
+
+    // Draw the vertices written by the last update().
+    // View and projection come from the per-frame uniform block (see FrameUniforms).
+    void draw(const glm::mat4& model) const;
+
+    // Set the shader for this mesh
+    void setShader(Shader* shader) { this->shader = shader; }
+
+    // Draw with separately compiled stages through a shared pipeline instead of a Shader
+    // (the vertex stage receives uModel). Pass nullptr to go back to the shader.
+    void setStages(ProgramPipeline* pipeline, const ShaderStage* vertexStage, const ShaderStage* fragmentStage)
+    {
+        this->pipeline = pipeline;
+        this->vertexStage = vertexStage;
+        this->fragmentStage = fragmentStage;
+    }
+
+    // Get the upload metrics
+    const Stats& getStats() const { return stats; }
+
+    // Check if the mesh was set up successfully (VAO is valid).
+    bool isValid() const { return VAO != 0; }
+
+private:
+    size_t maxVertices;
+    GLenum primitive;
+    Shader* shader = nullptr;
+    ProgramPipeline* pipeline = nullptr;
+    const ShaderStage* vertexStage = nullptr;
+    const ShaderStage* fragmentStage = nullptr;
+
+    // OpenGL objects (generated in setup)
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+
+    // Ring state: the segment written by the last update(), and one fence per segment
+    // (0 while the segment has no pending GPU reads)
+    unsigned int currentSegment = 0;
+    size_t currentVertexCount = 0;
+    bool currentSegmentUsed = false; // A segment was written since the last fence was inserted
+    std::array<GLsync, SEGMENT_COUNT> fences = {};
+
+    Stats stats;
+
+    // Size of one ring segment in bytes
+    size_t segmentBytes() const { return maxVertices * sizeof(Vertex); }
+
+    // Block until the GPU has finished reading the given segment. Returns false on timeout.
+    bool waitForSegment(unsigned int segment);
+
+    // Fallback: give the buffer new storage so no pending draw is affected, and forget all fences
+    void orphanBuffer();
+
+    // Helper function to delete the fences and OpenGL objects
+    void release();
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // DYNAMICMESH_H
@@ -0,0 +1,80 @@
+#include "FrameUniforms.h"
+
+// Destructor: deletes the uniform buffer
+FrameUniforms::~FrameUniforms()
+{
+    if (UBO != 0) {
+        glDeleteBuffers(1, &UBO);
+    }
+}
+
+// Move constructor
+FrameUniforms::FrameUniforms(FrameUniforms&& other) noexcept
+: UBO(other.UBO), data(other.data)
+{
+    other.UBO = 0; // Prevent double deletion
+}
+
+// Move assignment operator
+FrameUniforms& FrameUniforms::operator=(FrameUniforms&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (UBO != 0) {
+            glDeleteBuffers(1, &UBO);
+        }
+        UBO = other.UBO;
+        data = other.data;
+        other.UBO = 0;
+    }
+    return *this;
+}
+
+// Create the uniform buffer and bind it to BINDING_POINT
+bool FrameUniforms::setup()
+{
+    if (UBO != 0) {
+        glDeleteBuffers(1, &UBO);
+        UBO = 0;
+    }
+
+    glGenBuffers(1, &UBO);
+    if (UBO == 0)
+    {
+        logError("Failed to generate the frame uniform buffer.");
+        return false;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), &data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // The binding point stays attached to this buffer for the lifetime of the object
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, UBO);
+    return true;
+}
+
+// Upload this frame's data (one buffer update per frame)
+void FrameUniforms::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float time, float deltaTime)
+{
+    data.view = view;
+    data.projection = projection;
+    data.viewProjection = projection * view;
+    data.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+    data.time = glm::vec4(time, deltaTime, 0.0f, 0.0f);
+
+    if (UBO == 0) {
+        logError("Attempted to update an invalid frame uniform buffer.");
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Utility function for reporting errors
+void FrameUniforms::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::FRAMEUNIFORMS::" << message << std::endl;
+}
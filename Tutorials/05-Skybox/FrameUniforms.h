@@ -0,0 +1,84 @@
+#ifndef FRAMEUNIFORMS_H
+#define FRAMEUNIFORMS_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <iostream>
+
+// Per-frame constants shared by every shader program.
+// Layout matches the std140 "FrameData" uniform block the shaders include from frame_data.glsl:
+//
+//   layout (std140) uniform FrameData
+//   {
+//       mat4 uView;
+//       mat4 uProjection;
+//       mat4 uViewProjection;
+//       vec4 uCameraPosition; // xyz = camera world position
+//       vec4 uTime;           // x = seconds since start, y = frame delta time
+//   };
+//
+// Only mat4 and vec4 members are used so the C++ layout needs no std140 padding.
+// New per-frame constants go at the end, as vec4 or mat4, in both places.
+struct FrameData
+{
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec4 cameraPosition = glm::vec4(0.0f);
+    glm::vec4 time = glm::vec4(0.0f);
+};
+static_assert(sizeof(FrameData) == 3 * sizeof(glm::mat4) + 2 * sizeof(glm::vec4), "FrameData must match the std140 FrameData block");
+
+// Owns the uniform buffer holding FrameData.
+// The buffer is bound to a fixed binding point, and Shader::load() connects every
+// program that declares the "FrameData" block to it, so the data is written once
+// per frame instead of being set on each program for each draw.
+class FrameUniforms
+{
+public:
+    // Binding point of the FrameData block, shared by all programs
+    static constexpr GLuint BINDING_POINT = 0;
+
+    // Name of the uniform block in the shaders
+    static constexpr const char* BLOCK_NAME = "FrameData";
+
+    // Constructor: does NOT create the OpenGL buffer.
+    FrameUniforms() = default;
+
+    // Destructor: deletes the uniform buffer.
+    ~FrameUniforms();
+
+    // Prevent copying (owns an OpenGL buffer)
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Allow moving (transfer ownership)
+    FrameUniforms(FrameUniforms&& other) noexcept;
+    FrameUniforms& operator=(FrameUniforms&& other) noexcept;
+
+    // Create the uniform buffer and bind it to BINDING_POINT.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure.
+    bool setup();
+
+    // Upload this frame's data (one buffer update per frame).
+    // viewProjection is computed from view and projection.
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float time, float deltaTime);
+
+    // Get the data uploaded by the last update()
+    const FrameData& getData() const { return data; }
+
+    // Check if the uniform buffer was created successfully.
+    bool isValid() const { return UBO != 0; }
+
+private:
+    GLuint UBO = 0;
+    FrameData data;
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // FRAMEUNIFORMS_H
@@ -0,0 +1,27 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <vector>
+#include <string>
+
+// A decoded image in CPU memory: 8 bits per channel, rows tightly packed,
+// first row at the bottom (the order OpenGL expects) unless decoded without flipping.
+// Produced by decoding (possibly on a worker thread), consumed by the GL upload.
+struct Image
+{
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    // Path the image was decoded from, for error messages
+    std::string source;
+
+    // Check if the image holds decoded pixels
+    bool isValid() const { return !pixels.empty(); }
+
+    // Size of one row in bytes
+    size_t rowBytes() const { return static_cast<size_t>(width) * channels; }
+};
+
+#endif // IMAGE_H
@@ -0,0 +1,290 @@
+#include "ImageDecoder.h"
+
+#include <algorithm>    // For std::swap, std::equal
+#include <cstdint>      // For SIZE_MAX
+#include <fstream>      // For reading the file
+#include <iostream>     // For error reporting
+#include <mutex>        // For std::unique_lock
+#include <shared_mutex> // For the registry lock
+
+// Tell stb_image to implement the functions
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Pick the vector instruction set for the row swaps
+#if defined(__SSE2__) || defined(_M_X64)
+#define IMAGEDECODER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define IMAGEDECODER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// readInfo() reads this much of the file first: enough for the headers of every stb_image
+// format, including JPEG files with large EXIF blocks before their frame header
+static constexpr size_t INFO_READ_BYTES = 256 * 1024;
+
+// A decoder and the signature it is registered for
+struct RegisteredDecoder
+{
+    std::string name;
+    std::vector<unsigned char> signature;
+    ImageDecoder::DecodeFunction decode;
+    ImageDecoder::InfoFunction info;
+};
+
+// Decode with stb_image. The flip is left to ImageDecoder, so stb's flip setting is never touched.
+static Image decodeWithStb(std::span<const unsigned char> data, int desiredChannels)
+{
+    Image image;
+    int storedChannels = 0;
+    unsigned char* pixels = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &image.width, &image.height,
+                                                  &storedChannels, desiredChannels);
+    if (!pixels) {
+        return Image();
+    }
+    image.channels = desiredChannels != 0 ? desiredChannels : storedChannels;
+    image.pixels.assign(pixels, pixels + image.rowBytes() * image.height);
+    stbi_image_free(pixels);
+    return image;
+}
+
+static bool readStbInfo(std::span<const unsigned char> data, int& width, int& height, int& channels)
+{
+    return stbi_info_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &channels) != 0;
+}
+
+// The registered decoders, created with the stb_image ones on first use
+struct DecoderRegistry
+{
+    std::shared_mutex mutex;
+    std::vector<RegisteredDecoder> decoders;
+    RegisteredDecoder fallback;
+
+    DecoderRegistry()
+    {
+        auto add = [this](const char* name, std::vector<unsigned char> signature) {
+            decoders.push_back({ name, std::move(signature), decodeWithStb, readStbInfo });
+        };
+        add("PNG (stb_image)", { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A });
+        add("JPEG (stb_image)", { 0xFF, 0xD8, 0xFF });
+        add("BMP (stb_image)", { 'B', 'M' });
+        add("GIF (stb_image)", { 'G', 'I', 'F', '8' });
+        add("PSD (stb_image)", { '8', 'B', 'P', 'S' });
+        add("HDR (stb_image)", { '#', '?' }); // "#?RADIANCE" or "#?RGBE", tone mapped to 8 bits
+        fallback = { "stb_image", {}, decodeWithStb, readStbInfo }; // TGA and anything else stb knows
+    }
+
+    // Get a copy of the decoder for the bytes, so it runs without holding the lock
+    RegisteredDecoder find(std::span<const unsigned char> data)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const RegisteredDecoder* best = nullptr;
+        for (const RegisteredDecoder& decoder : decoders)
+        {
+            const std::vector<unsigned char>& signature = decoder.signature;
+            if (signature.size() > data.size() || (best && signature.size() <= best->signature.size())) {
+                continue;
+            }
+            if (std::equal(signature.begin(), signature.end(), data.begin())) {
+                best = &decoder;
+            }
+        }
+        return best ? *best : fallback;
+    }
+};
+
+static DecoderRegistry& getRegistry()
+{
+    static DecoderRegistry registry; // Thread-safe initialization
+    return registry;
+}
+
+// Read up to maxBytes of a file (all of it by default)
+static bool readFile(const std::string& filePath, std::vector<unsigned char>& data, size_t maxBytes = SIZE_MAX)
+{
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    data.resize(std::min(static_cast<size_t>(size), maxBytes));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+}
+
+// Register a decoder for files starting with signature
+void ImageDecoder::registerDecoder(const std::string& name, std::vector<unsigned char> signature, DecodeFunction decode, InfoFunction info)
+{
+    DecoderRegistry& registry = getRegistry();
+    std::unique_lock<std::shared_mutex> lock(registry.mutex);
+    if (signature.empty())
+    {
+        registry.fallback = { name, {}, std::move(decode), std::move(info) };
+        return;
+    }
+    // Replace any decoder with the same signature
+    std::erase_if(registry.decoders, [&signature](const RegisteredDecoder& decoder) { return decoder.signature == signature; });
+    registry.decoders.push_back({ name, std::move(signature), std::move(decode), std::move(info) });
+}
+
+// Decode an image file
+Image ImageDecoder::decode(const std::string& filePath, const DecodeOptions& options)
+{
+    std::vector<unsigned char> data;
+    if (!readFile(filePath, data))
+    {
+        std::cerr << "ERROR::IMAGEDECODER::FILE_NOT_READ " << filePath << std::endl;
+        return Image();
+    }
+    return decodeMemory(data, options, filePath);
+}
+
+// Decode image bytes already in memory
+Image ImageDecoder::decodeMemory(std::span<const unsigned char> data, const DecodeOptions& options, const std::string& source)
+{
+    if (options.channels < 0 || options.channels > 4)
+    {
+        std::cerr << "ERROR::IMAGEDECODER::INVALID_CHANNEL_COUNT " << options.channels << " for " << source << std::endl;
+        return Image();
+    }
+    RegisteredDecoder decoder = getRegistry().find(data);
+    if (!decoder.decode)
+    {
+        std::cerr << "ERROR::IMAGEDECODER::NO_DECODER for " << source << std::endl;
+        return Image();
+    }
+
+    Image image = decoder.decode(data, options.channels);
+    if (!image.isValid() || image.channels < 1 || image.channels > 4)
+    {
+        std::cerr << "ERROR::IMAGEDECODER::DECODE_FAILED (" << decoder.name << ") " << source << std::endl;
+        return Image();
+    }
+    image.source = source;
+
+    // Decoders may ignore the channel hint; core-profile GL has no grey-alpha format
+    int channels = options.channels;
+    if (channels == 0 && options.target == DecodeTarget::UPLOADABLE && image.channels == 2) {
+        channels = 4;
+    }
+    if (channels != 0 && channels != image.channels) {
+        convertChannels(image, channels);
+    }
+    if (options.flipVertically) {
+        flipVertically(image);
+    }
+    return image;
+}
+
+// Read the size and channel count of an image file without decoding it
+bool ImageDecoder::readInfo(const std::string& filePath, int& width, int& height, int& channels)
+{
+    std::vector<unsigned char> data;
+    if (!readFile(filePath, data, INFO_READ_BYTES)) {
+        return false;
+    }
+    RegisteredDecoder decoder = getRegistry().find(data);
+    if (decoder.info && decoder.info(data, width, height, channels)) {
+        return true;
+    }
+    // The header may lie beyond what was read, or the decoder cannot read headers alone: use the whole file
+    if (data.size() == INFO_READ_BYTES && !readFile(filePath, data)) {
+        return false;
+    }
+    if (decoder.info) {
+        return decoder.info(data, width, height, channels);
+    }
+    if (!decoder.decode) {
+        return false;
+    }
+    Image image = decoder.decode(data, 0);
+    width = image.width;
+    height = image.height;
+    channels = image.channels;
+    return image.isValid();
+}
+
+// Get the name of the decoder that would handle the bytes
+std::string ImageDecoder::getDecoderName(std::span<const unsigned char> data)
+{
+    RegisteredDecoder decoder = getRegistry().find(data);
+    return decoder.decode ? decoder.name : std::string();
+}
+
+// Swap two rows, 16 bytes at a time where possible
+static void swapRows(unsigned char* first, unsigned char* second, size_t bytes)
+{
+    size_t i = 0;
+#if IMAGEDECODER_SSE2
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(first + i), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(second + i), a);
+    }
+#elif IMAGEDECODER_NEON
+    for (; i + 16 <= bytes; i += 16)
+    {
+        uint8x16_t a = vld1q_u8(first + i);
+        uint8x16_t b = vld1q_u8(second + i);
+        vst1q_u8(first + i, b);
+        vst1q_u8(second + i, a);
+    }
+#endif
+    for (; i < bytes; i++) {
+        std::swap(first[i], second[i]);
+    }
+}
+
+// Reverse the row order of an image in place
+void ImageDecoder::flipVertically(Image& image)
+{
+    if (!image.isValid() || image.height < 2) {
+        return;
+    }
+    const size_t rowBytes = image.rowBytes();
+    unsigned char* top = image.pixels.data();
+    unsigned char* bottom = top + rowBytes * (image.height - 1);
+    for (int y = 0; y < image.height / 2; y++, top += rowBytes, bottom -= rowBytes) {
+        swapRows(top, bottom, rowBytes);
+    }
+}
+
+// Convert an image to another channel count
+void ImageDecoder::convertChannels(Image& image, int channels)
+{
+    if (!image.isValid() || channels < 1 || channels > 4 || channels == image.channels) {
+        return;
+    }
+    const int from = image.channels;
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    std::vector<unsigned char> converted(pixelCount * channels);
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        const unsigned char* source = image.pixels.data() + i * from;
+        unsigned char* destination = converted.data() + i * channels;
+        const bool color = from >= 3;
+        const unsigned char alpha = (from == 2 || from == 4) ? source[from - 1] : 255;
+        if (channels >= 3)
+        {
+            destination[0] = source[0];
+            destination[1] = color ? source[1] : source[0];
+            destination[2] = color ? source[2] : source[0];
+        }
+        else
+        {
+            // Same luminance weights as stb_image
+            destination[0] = color ? static_cast<unsigned char>((source[0] * 77 + source[1] * 150 + source[2] * 29) >> 8) : source[0];
+        }
+        if (channels == 2 || channels == 4) {
+            destination[channels - 1] = alpha;
+        }
+    }
+    image.pixels = std::move(converted);
+    image.channels = channels;
+}
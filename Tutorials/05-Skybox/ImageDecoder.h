@@ -0,0 +1,83 @@
+#ifndef IMAGEDECODER_H
+#define IMAGEDECODER_H
+
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+
+// Channel layouts the decoded image may have
+enum class DecodeTarget
+{
+    ANY,       // Whatever the decoder produced (1 to 4 channels)
+    UPLOADABLE // A layout with a core-profile upload format: grey-alpha is expanded to RGBA
+};
+
+// Options for ImageDecoder::decode, passed per call (no global state, safe on any thread)
+struct DecodeOptions
+{
+    // Put the first row at the bottom, the order OpenGL expects for 2D textures
+    // (cubemap faces are sampled top-first and must not be flipped)
+    bool flipVertically = true;
+
+    // Convert to this many channels (1 to 4); 0 keeps the file's channel count
+    int channels = 0;
+
+    DecodeTarget target = DecodeTarget::UPLOADABLE;
+};
+
+// Decodes image files into 8-bit CPU images through decoders registered by file signature.
+//
+// The file is read once, its first bytes are matched against the registered signatures
+// (the longest match wins, and a later registration replaces an earlier one with the same
+// signature), and the chosen decoder turns the bytes into top-first rows. Channel conversion
+// and the vertical flip are then done here, so a decoder only has to decode: the flip swaps
+// rows in place with SSE2 / NEON. Files matching no signature (e.g. TGA, which has none) go to
+// the fallback decoder. stb_image is registered for PNG, JPEG, BMP, GIF, PSD, HDR and as the
+// fallback, always called without its process-wide flip setting.
+//
+// Every function is thread-safe; decoding runs concurrently on any number of threads.
+class ImageDecoder
+{
+public:
+    // Decode file bytes into an image with top-first rows. desiredChannels is a hint
+    // (0 = as stored); a different count is converted afterwards. Returns an invalid Image on failure.
+    using DecodeFunction = std::function<Image(std::span<const unsigned char> data, int desiredChannels)>;
+
+    // Read the size and channel count from the file bytes without decoding. Returns false on failure.
+    using InfoFunction = std::function<bool(std::span<const unsigned char> data, int& width, int& height, int& channels)>;
+
+    // Register a decoder for files starting with signature (an empty signature sets the fallback).
+    // info is optional; without it, readInfo() decodes the whole file.
+    static void registerDecoder(const std::string& name, std::vector<unsigned char> signature,
+                                DecodeFunction decode, InfoFunction info = nullptr);
+
+    // Decode an image file. Returns an invalid Image on failure; errors will be printed to cerr.
+    static Image decode(const std::string& filePath, const DecodeOptions& options = DecodeOptions());
+
+    // Decode image bytes already in memory (source names the image in error messages)
+    static Image decodeMemory(std::span<const unsigned char> data, const DecodeOptions& options = DecodeOptions(),
+                              const std::string& source = "memory");
+
+    // Read the size and channel count of an image file without decoding it (if its decoder can).
+    // Returns false on failure.
+    static bool readInfo(const std::string& filePath, int& width, int& height, int& channels);
+
+    // Get the name of the decoder that would handle the bytes ("" if none would)
+    static std::string getDecoderName(std::span<const unsigned char> data);
+
+    // Reverse the row order of an image in place
+    static void flipVertically(Image& image);
+
+    // Convert an image to another channel count (1 to 4): grey is replicated to RGB,
+    // RGB is reduced to grey by luminance, and missing alpha is opaque
+    static void convertChannels(Image& image, int channels);
+
+private:
+    // Private constructor to prevent instantiation (it's a static utility class)
+    ImageDecoder() = delete;
+};
+
+#endif // IMAGEDECODER_H
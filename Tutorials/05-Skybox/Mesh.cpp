@@ -1,9 +1,14 @@
 #include "Mesh.h"
 #include <glm/glm.hpp> // For glm::vec3, glm::vec2 etc. (if not included by glad/gl.h)
-#include <cstddef> // For offsetof
+#include <algorithm> // For std::max
+#include <glm/gtc/matrix_transform.hpp> // For glm::translate, glm::scale
 
 #include "Shader.h"
+#include "ShaderStage.h"
+#include "ProgramPipeline.h"
 #include "Texture.h"
+#include "TextureArray.h"
+#include "RenderState.h"
 
 // Constructor implementation: Stores the vertex and index data.
 // Default empty indices vector allows for glDrawArrays.
@@ -12,31 +17,62 @@ Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>&
 {
     // OpenGL buffers and VAO are generated in the setupMesh() method.
     // VAO, VBO, EBO are initialized to 0 by default.
+    vertexView = this->vertices;
+    indexView = this->indices;
+}
+
+// Constructor implementation: Takes over the caller's vectors (no copy).
+Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices)
+: vertices(std::move(vertices)), indices(std::move(indices))
+{
+    vertexView = this->vertices;
+    indexView = this->indices;
+}
+
+// Constructor implementation: References the caller's memory (no copy, no ownership).
+Mesh::Mesh(std::span<const Vertex> vertices, std::span<const unsigned int> indices)
+: vertexView(vertices), indexView(indices)
+{
 }
 
 // Destructor implementation: Deletes the OpenGL buffers and VAO.
 Mesh::~Mesh()
 {
-    // Only delete if the mesh was set up successfully (VAO is not 0)
-    if (VAO != 0)
-    {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        if (EBO != 0) { // Only delete EBO if it was generated
-            glDeleteBuffers(1, &EBO);
-        }
-    }
+    deleteBuffers();
 }
 
 // Move constructor
 Mesh::Mesh(Mesh&& other) noexcept
 : vertices(std::move(other.vertices)), indices(std::move(other.indices)),
-VAO(other.VAO), VBO(other.VBO), EBO(other.EBO)
+// Moving a vector keeps its storage, so views of other's vectors stay valid
+vertexView(other.vertexView), indexView(other.indexView),
+retentionPolicy(other.retentionPolicy), vertexCount(other.vertexCount), indexCount(other.indexCount),
+shader(other.shader), pipeline(other.pipeline), vertexStage(other.vertexStage), fragmentStage(other.fragmentStage),
+textures(std::move(other.textures)), textureArray(other.textureArray),
+layout(other.layout), bounds(other.bounds), dequantization(other.dequantization),
+meshPool(other.meshPool), poolHandle(other.poolHandle),
+VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), indexType(other.indexType),
+instanceVBO(other.instanceVBO), instanceCapacity(other.instanceCapacity),
+layerVBO(other.layerVBO), layerCapacity(other.layerCapacity), layerAttributeEnabled(other.layerAttributeEnabled)
 {
     // Set other's IDs to 0 to prevent double deletion
     other.VAO = 0;
     other.VBO = 0;
     other.EBO = 0;
+    other.instanceVBO = 0;
+    other.instanceCapacity = 0;
+    other.layerVBO = 0;
+    other.layerCapacity = 0;
+    other.layerAttributeEnabled = false;
+    other.shader = nullptr;
+    other.pipeline = nullptr;
+    other.vertexStage = other.fragmentStage = nullptr;
+    other.textureArray = nullptr;
+    other.vertexView = {};
+    other.indexView = {};
+    other.vertexCount = other.indexCount = 0;
+    other.meshPool = nullptr;
+    other.poolHandle = MeshPool::MeshHandle();
 }
 
 // Move assignment operator
@@ -45,30 +81,111 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept
     if (this != &other) // Prevent self-assignment
     {
         // Delete the current OpenGL objects if this object holds any
-        if (VAO != 0)
-        {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
-            if (EBO != 0) { // Only delete EBO if it was generated
-                glDeleteBuffers(1, &EBO);
-            }
-        }
+        deleteBuffers();
         
         // Transfer ownership of data and OpenGL IDs
         vertices = std::move(other.vertices);
         indices = std::move(other.indices);
+        vertexView = other.vertexView;
+        indexView = other.indexView;
+        retentionPolicy = other.retentionPolicy;
+        vertexCount = other.vertexCount;
+        indexCount = other.indexCount;
+        shader = other.shader;
+        pipeline = other.pipeline;
+        vertexStage = other.vertexStage;
+        fragmentStage = other.fragmentStage;
+        textures = std::move(other.textures);
+        textureArray = other.textureArray;
+        layout = other.layout;
+        bounds = other.bounds;
+        dequantization = other.dequantization;
+        meshPool = other.meshPool;
+        poolHandle = other.poolHandle;
         VAO = other.VAO;
         VBO = other.VBO;
         EBO = other.EBO;
+        indexType = other.indexType;
+        instanceVBO = other.instanceVBO;
+        instanceCapacity = other.instanceCapacity;
+        layerVBO = other.layerVBO;
+        layerCapacity = other.layerCapacity;
+        layerAttributeEnabled = other.layerAttributeEnabled;
         
         // Set other's IDs to 0
         other.VAO = 0;
         other.VBO = 0;
         other.EBO = 0;
+        other.instanceVBO = 0;
+        other.instanceCapacity = 0;
+        other.layerVBO = 0;
+        other.layerCapacity = 0;
+        other.layerAttributeEnabled = false;
+        other.shader = nullptr;
+        other.pipeline = nullptr;
+        other.vertexStage = other.fragmentStage = nullptr;
+        other.textureArray = nullptr;
+        other.vertexView = {};
+        other.indexView = {};
+        other.vertexCount = other.indexCount = 0;
+        other.meshPool = nullptr;
+        other.poolHandle = MeshPool::MeshHandle();
     }
     return *this;
 }
 
+// Helper function to delete all OpenGL objects owned by this mesh
+void Mesh::deleteBuffers()
+{
+    // A pooled mesh only gives its space back: the VAO and buffers belong to the pool
+    if (poolHandle.isValid())
+    {
+        meshPool->free(poolHandle);
+        poolHandle = MeshPool::MeshHandle();
+        VAO = 0;
+    }
+    // Only delete if the mesh was set up successfully (VAO is not 0)
+    if (VAO != 0)
+    {
+        RenderState::onVertexArrayDeleted(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        if (EBO != 0) { // Only delete EBO if it was generated
+            glDeleteBuffers(1, &EBO);
+        }
+        if (instanceVBO != 0) { // Only delete the instance VBO if drawInstanced created it
+            glDeleteBuffers(1, &instanceVBO);
+        }
+        if (layerVBO != 0) { // Only delete the layer VBO if drawInstanced created it
+            glDeleteBuffers(1, &layerVBO);
+        }
+    }
+    VAO = VBO = EBO = instanceVBO = layerVBO = 0; // Reset IDs
+    instanceCapacity = layerCapacity = 0;
+    layerAttributeEnabled = false;
+}
+
+// Helper function to free the CPU-side geometry according to the retention policy
+void Mesh::releaseCpuData()
+{
+    if (retentionPolicy == RetentionPolicy::KEEP && !vertices.empty())
+    {
+        return; // Owned data is kept for a later setupMesh()
+    }
+    
+    // Swap with empty vectors: clear() alone would keep the capacity allocated
+    std::vector<Vertex>().swap(vertices);
+    std::vector<unsigned int>().swap(indices);
+    // Span-constructed meshes always forget the caller's memory, it may be freed after setupMesh()
+    vertexView = {};
+    indexView = {};
+    
+    if (retentionPolicy == RetentionPolicy::DROP_AFTER_UPLOAD)
+    {
+        bounds = PositionBounds{};
+    }
+}
+
 // Utility function for reporting errors
 void Mesh::logError(const std::string& message) const
 {
@@ -84,72 +201,162 @@ void Mesh::setupBuffers()
     glGenBuffers(1, &VBO);
     
     // If indices are provided, generate and bind the EBO
-    if (!indices.empty()) {
+    if (!indexView.empty()) {
         glGenBuffers(1, &EBO);
     }
     
     
     // Bind the Vertex Array Object first
-    glBindVertexArray(VAO);
+    RenderState::bindVertexArray(VAO);
     
     // Bind and upload vertex data to VBO
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    // Use sizeof(Vertex) and vertices.size() to calculate the buffer size
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    if (layout.native)
+    {
+        // Use sizeof(Vertex) and the vertex count to calculate the buffer size
+        glBufferData(GL_ARRAY_BUFFER, vertexView.size_bytes(), vertexView.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        // Encode into the (smaller) GPU layout first
+        std::vector<uint8_t> encoded(vertexView.size() * layout.stride);
+        layout.encode(vertexView, encoded.data(), bounds);
+        glBufferData(GL_ARRAY_BUFFER, encoded.size(), encoded.data(), GL_STATIC_DRAW);
+    }
     
     // If indices are provided, bind and upload index data to EBO
-    if (!indices.empty()) {
+    if (!indexView.empty()) {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        if (vertexView.size() <= 65536)
+        {
+            // Every index fits in 16 bits: upload half the index data
+            std::vector<uint16_t> shortIndices(indexView.begin(), indexView.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), &shortIndices[0], GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_SHORT;
+        }
+        else
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexView.size_bytes(), indexView.data(), GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_INT;
+        }
     }
     
     
     // Configure Vertex Attributes
-    
-    // Position attribute (layout (location = 0))
-    glEnableVertexAttribArray(0);
-    // Use offsetof to calculate the offset of the position member within the Vertex struct
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    
-    // Normal attribute (layout (location = 1))
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    
-    // Texture Coordinates attribute (layout (location = 2))
-    glEnableVertexAttribArray(2); // Assuming texture coords are at location 2 in your shader
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    // Position (location = 0), normal (location = 1) and texture coordinates (location = 2),
+    // with the formats, offsets and stride described by the vertex layout
+    layout.apply();
     
     // Unbind the VAO (important!)
-    glBindVertexArray(0);
+    RenderState::bindVertexArray(0);
     
     // Note: VBO is unbound when the VAO is unbound.
     // EBO remains bound to the VAO if it was generated.
 }
 
+// Helper function to create the instance VBO and its divisor-1 attributes on the VAO
+void Mesh::setupInstanceBuffer()
+{
+    glGenBuffers(1, &instanceVBO);
+    
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    
+    // A mat4 attribute occupies four consecutive locations (one vec4 column each).
+    // Instance model matrix attribute (layout (location = 3), columns at 3..6)
+    for (GLuint column = 0; column < 4; column++)
+    {
+        GLuint location = 3 + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        // Advance the attribute once per instance instead of once per vertex
+        glVertexAttribDivisor(location, 1);
+    }
+    
+    RenderState::bindVertexArray(0);
+}
+
+// Helper function to create the layer VBO and its divisor-1 integer attribute on the VAO
+void Mesh::setupLayerBuffer()
+{
+    glGenBuffers(1, &layerVBO);
+    
+    RenderState::bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, layerVBO);
+    
+    // Integer attribute (glVertexAttribIPointer): the layer reaches the shader as an exact uint
+    glVertexAttribIPointer(LAYER_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+    glVertexAttribDivisor(LAYER_ATTRIBUTE, 1);
+    // Enabled per draw by selectLayers()
+    
+    RenderState::bindVertexArray(0);
+}
+
+// Helper function to source the layer attribute from the layer VBO or a constant
+void Mesh::selectLayers(bool perInstance, uint32_t layer)
+{
+    if (perInstance != layerAttributeEnabled)
+    {
+        if (perInstance)
+            glEnableVertexAttribArray(LAYER_ATTRIBUTE);
+        else
+            glDisableVertexAttribArray(LAYER_ATTRIBUTE);
+        layerAttributeEnabled = perInstance;
+    }
+    if (!perInstance)
+    {
+        // A disabled attribute reads the current generic value: one layer for the whole draw
+        glVertexAttribI4ui(LAYER_ATTRIBUTE, layer, 0, 0, 1);
+    }
+}
+
 
 // Method to setup OpenGL buffers and VAO.
 bool Mesh::setupMesh()
 {
     // Ensure we have vertex data to setup
-    if (vertices.empty())
+    if (vertexView.empty())
     {
-        logError("Attempted to setup mesh with empty vertex data.");
+        if (vertexCount > 0)
+            logError("Attempted to setup mesh after its vertex data was released (see RetentionPolicy).");
+        else
+            logError("Attempted to setup mesh with empty vertex data.");
         return false;
     }
     
     // Clean up any existing OpenGL objects if setupMesh is called multiple times
-    if (VAO != 0)
+    deleteBuffers();
+    
+    // Compute the bounds, and the matrix mapping quantized [0, 1] positions back into them
+    bounds.min = bounds.max = vertexView[0].position;
+    for (const Vertex& vertex : vertexView)
     {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        if (EBO != 0) { // Only delete EBO if it was generated
-            glDeleteBuffers(1, &EBO);
-        }
-        VAO = VBO = EBO = 0; // Reset IDs
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+    dequantization = glm::mat4(1.0f);
+    if (layout.quantizedPositions)
+    {
+        dequantization = glm::translate(dequantization, bounds.min);
+        dequantization = glm::scale(dequantization, glm::max(bounds.max - bounds.min, glm::vec3(1e-20f)));
     }
     
-    // Perform the OpenGL buffer and VAO setup
-    setupBuffers();
+    // Perform the OpenGL buffer and VAO setup, or place the geometry in the shared pool
+    if (meshPool)
+    {
+        poolHandle = meshPool->allocate(layout, vertexView, indexView);
+        if (!poolHandle.isValid())
+        {
+            logError("Failed to allocate the mesh from its pool.");
+            return false;
+        }
+        VAO = meshPool->getVertexArray(poolHandle);
+        indexType = GL_UNSIGNED_INT; // The pool keeps 32-bit indices
+    }
+    else
+    {
+        setupBuffers();
+    }
     
     // Check if VAO was successfully created (a basic check)
     if (VAO == 0)
@@ -158,88 +365,317 @@ bool Mesh::setupMesh()
         return false;
     }
     
+    // Remember what was uploaded, so drawing does not depend on the CPU-side data
+    vertexCount = vertexView.size();
+    indexCount = indexView.size();
+    
+    // The GPU now has its own copy; free ours unless the policy says to keep it
+    releaseCpuData();
+    
     return true; // Setup successful
 }
 
 
 // Method to draw the mesh.
 // Draws using glDrawElements if indices are available, otherwise uses glDrawArrays.
-// Requires the appropriate shader to be used beforehand.
 // Only safe to call if isValid() is true.
-void Mesh::draw(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) const
+void Mesh::draw(const glm::mat4& model, uint32_t layer)
 {
     if (VAO == 0) {
         logError("ERROR::MESH::DRAW::Attempted to draw an invalid mesh.");
         return;
     }
     
-    // Ensure a shader is assigned to this mesh
-    if (!shader || !shader->isValid()) {
-        std::cerr << "ERROR::MESH::DRAW::NO_SHADER_ASSIGNED_OR_LOADED" << std::endl;
+    // Use the mesh's assigned shader (or stages)
+    if (!bindProgram("DRAW")) {
         return; // Cannot draw without a valid shader
     }
     
-    // Use the mesh's assigned shader
-    shader->use();
-    
-    // Set transformation uniforms
-    shader->setMat4("uModel", model);
-    shader->setMat4("uView", view);
-    shader->setMat4("uProjection", projection);
+    // Set the model matrix (view and projection come from the per-frame uniform block)
+    // Quantized positions are dequantized by folding the bounds into the model matrix
+    const glm::mat4 drawModel = layout.quantizedPositions ? model * dequantization : model;
+    if (usesStages()) {
+        vertexStage->setMat4("uModel", drawModel);
+    } else {
+        shader->setMat4("uModel", drawModel);
+    }
     
     // Bind textures and set uniforms
-    for (unsigned int i = 0; i < textures.size(); i++)
+    bindTextures();
+    
+    // Pooled geometry is drawn by the pool from its shared VAO (which also sets the layer)
+    if (poolHandle.isValid())
     {
-        if (textures[i]) { // Ensure the texture pointer is valid
-            textures[i]->bind(i); // Bind to texture unit 'i'
-            
-            // Set the sampler uniform in the shader
-            // Assuming your shader uses uniform names like "uTexture0", "uTexture1", etc.
-            std::string uniformName = "uTexture" + std::to_string(i);
-            shader->setInt(uniformName.c_str(), i);
-        }
+        meshPool->draw(std::span<const MeshPool::MeshHandle>(&poolHandle, 1), layer);
+        return;
     }
     
     // Bind the VAO before drawing
-    glBindVertexArray(VAO);
+    RenderState::bindVertexArray(VAO);
+    // Always give the layer attribute a value, so a shader or stage that reads it is defined without an array
+    selectLayers(false, layer);
     
-    if (!indices.empty())
+    if (indexCount > 0)
     {
         // Draw using indices (glDrawElements)
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indexCount), indexType, 0);
     }
     else
     {
         // Draw using vertex array (glDrawArrays)
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertexCount));
+    }
+    
+    // The VAO and textures are left bound: the next draw of this mesh (or anything sharing
+    // its textures) then skips the rebind in RenderState instead of ping-ponging through 0.
+}
+
+
+// Method to draw many copies of the mesh with a single instanced draw call.
+// Uploads all model matrices with one buffer update, then issues one draw call.
+void Mesh::drawInstanced(std::span<const glm::mat4> models, std::span<const uint32_t> layers)
+{
+    if (VAO == 0) {
+        logError("ERROR::MESH::DRAWINSTANCED::Attempted to draw an invalid mesh.");
+        return;
+    }
+    
+    // Ensure a shader (or a complete set of stages) is assigned to this mesh
+    if (!usesStages() && (!shader || !shader->isValid())) {
+        std::cerr << "ERROR::MESH::DRAWINSTANCED::NO_SHADER_ASSIGNED_OR_LOADED" << std::endl;
+        return; // Cannot draw without a valid shader
+    }
+    
+    if (models.empty()) {
+        return; // Nothing to draw
+    }
+    
+    if (!layers.empty() && layers.size() != models.size()) {
+        logError("ERROR::MESH::DRAWINSTANCED::Layer count does not match the instance count.");
+        return;
+    }
+    
+    // Pooled geometry: the pool uploads the instances into its own buffers and draws from its shared VAO
+    if (poolHandle.isValid())
+    {
+        bindProgram("DRAWINSTANCED");
+        bindTextures();
+        meshPool->drawInstanced(poolHandle, models, layers);
+        return;
+    }
+    
+    // Create the instance buffer on first use
+    if (instanceVBO == 0) {
+        setupInstanceBuffer();
     }
     
-    // Unbind the VAO after drawing (optional, but good practice)
-    glBindVertexArray(0);
+    // Upload the per-instance model matrices
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (models.size() > instanceCapacity)
+    {
+        // Grow geometrically so a slowly growing instance count does not reallocate every frame
+        instanceCapacity = std::max(models.size(), instanceCapacity * 2);
+    }
+    // Orphan the previous storage so the driver does not wait for the last frame's draw to finish reading it
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    if (!layout.quantizedPositions)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, models.size_bytes(), models.data());
+    }
+    else
+    {
+        // Fold the dequantization into each instance matrix while writing it
+        glm::mat4* mapped = static_cast<glm::mat4*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, models.size_bytes(),
+                                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (mapped)
+        {
+            for (size_t i = 0; i < models.size(); i++)
+            {
+                mapped[i] = models[i] * dequantization;
+            }
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else
+        {
+            logError("Failed to map the instance buffer.");
+        }
+    }
+    
+    // Upload the per-instance layers next to the matrices
+    if (!layers.empty())
+    {
+        if (layerVBO == 0) {
+            setupLayerBuffer();
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, layerVBO);
+        layerCapacity = std::max(layers.size(), layerCapacity);
+        glBufferData(GL_ARRAY_BUFFER, layerCapacity * sizeof(uint32_t), nullptr, GL_STREAM_DRAW); // Orphan
+        glBufferSubData(GL_ARRAY_BUFFER, 0, layers.size_bytes(), layers.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    // Use the mesh's assigned shader (or stages)
+    bindProgram("DRAWINSTANCED");
+    // The model matrix comes from the instance attribute,
+    // view and projection come from the per-frame uniform block
     
-    // Unbind textures after drawing
+    // Bind textures and set uniforms
+    bindTextures();
+    
+    // Bind the VAO before drawing
+    RenderState::bindVertexArray(VAO);
+    selectLayers(!layers.empty(), 0);
+    
+    GLsizei instanceCount = static_cast<GLsizei>(models.size());
+    if (indexCount > 0)
+    {
+        // Draw all instances using indices (glDrawElementsInstanced)
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indexCount), indexType, 0, instanceCount);
+    }
+    else
+    {
+        // Draw all instances using vertex array (glDrawArraysInstanced)
+        glDrawArraysInstanced(GL_TRIANGLES, 0, static_cast<GLsizei>(vertexCount), instanceCount);
+    }
+    
+    // The VAO and textures are left bound: the next draw of this mesh (or anything sharing
+    // its textures) then skips the rebind in RenderState instead of ping-ponging through 0.
+}
+
+// Sampler uniform names for each texture unit, hashed at compile time
+static constexpr Shader::UniformName textureUniformNames[Mesh::MAX_TEXTURES] = {
+    "uTexture0", "uTexture1", "uTexture2", "uTexture3",
+    "uTexture4", "uTexture5", "uTexture6", "uTexture7"
+};
+
+// Helper function to check if the mesh draws through its stages
+bool Mesh::usesStages() const
+{
+    return pipeline && vertexStage && vertexStage->isValid() && fragmentStage && fragmentStage->isValid();
+}
+
+// Helper function to bind the shader or the stages
+bool Mesh::bindProgram(const char* caller) const
+{
+    if (usesStages())
+    {
+        pipeline->bind(*vertexStage, *fragmentStage); // Only a stage that changed is swapped
+        return true;
+    }
+    if (!shader || !shader->isValid())
+    {
+        std::cerr << "ERROR::MESH::" << caller << "::NO_SHADER_ASSIGNED_OR_LOADED" << std::endl;
+        return false;
+    }
+    shader->use();
+    return true;
+}
+
+// Helper function to bind the textures and set their sampler uniforms
+void Mesh::bindTextures() const
+{
+    // Samplers belong to the fragment stage when drawing through the pipeline
+    const bool useStages = usesStages();
     for (unsigned int i = 0; i < textures.size(); i++)
     {
-        if (textures[i]) {
-            textures[i]->unbind(i);
+        if (textures[i]) { // Ensure the texture pointer is valid
+            textures[i]->bind(i); // Bind to texture unit 'i'
+            
+            // Set the sampler uniform in the shader
+            // Assuming your shader uses uniform names like "uTexture0", "uTexture1", etc.
+            // The names are hashed at compile time, so no string is built per draw.
+            if (useStages) {
+                fragmentStage->setInt(textureUniformNames[i], i);
+            } else {
+                shader->setInt(textureUniformNames[i], i);
+            }
+        }
+    }
+    if (textureArray)
+    {
+        textureArray->bind(TEXTURE_ARRAY_UNIT);
+        if (useStages) {
+            fragmentStage->setInt("uTextureArray", TEXTURE_ARRAY_UNIT);
+        } else {
+            shader->setInt("uTextureArray", TEXTURE_ARRAY_UNIT);
         }
     }
 }
 
 
+// Set the GPU vertex layout used by the next setupMesh() call
+void Mesh::setVertexLayout(const VertexLayoutDesc& layout)
+{
+    this->layout = layout;
+}
+
 // Set the shader for this mesh
 void Mesh::setShader(Shader* shader)
 {
     this->shader = shader;
 }
 
+// Key of the program (or pair of stages) this mesh draws with
+uint64_t Mesh::getProgramKey() const
+{
+    if (usesStages()) {
+        // Both stage names, kept whole; the top bit keeps pairs apart from program names
+        return (1ull << 63) | (static_cast<uint64_t>(vertexStage->getID()) << 32) | fragmentStage->getID();
+    }
+    return shader ? shader->getID() : 0;
+}
+
 // Add a texture to this mesh
 void Mesh::addTexture(Texture* texture)
 {
     // Ensure the texture pointer is not null
-    if (texture) {
+    if (textures.size() >= MAX_TEXTURES) {
+        std::cerr << "WARNING::MESH::ADDTEXURE::TOO_MANY_TEXTURES" << std::endl;
+    } else if (texture) {
         this->textures.push_back(texture);
     } else {
         std::cerr << "WARNING::MESH::ADDTEXURE::NULL_POINTER" << std::endl;
     }
 }
+
+// Get a 16-bit key identifying the set of textures bound by this mesh
+uint16_t Mesh::getTextureSetKey() const
+{
+    // FNV-1a over the texture IDs, folded down to 16 bits
+    uint32_t hash = 2166136261u;
+    for (const Texture* texture : textures)
+    {
+        hash ^= texture->getID();
+        hash *= 16777619u;
+    }
+    if (textureArray)
+    {
+        // The layer is per draw, so all meshes of one array share a key
+        hash ^= textureArray->getID();
+        hash *= 16777619u;
+    }
+    return static_cast<uint16_t>((hash >> 16) ^ (hash & 0xFFFFu));
+}
+
+// Memory held by the vertex and index vectors (capacity, not size: that is what is allocated)
+size_t Mesh::getCpuMemoryBytes() const
+{
+    return vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int);
+}
+
+// Memory held by the vertex, index and instance buffers
+size_t Mesh::getGpuMemoryBytes() const
+{
+    if (VAO == 0)
+    {
+        return 0;
+    }
+    size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(unsigned int);
+    // A pooled mesh owns its share of the pool's buffers; the instance buffers belong to the pool
+    if (poolHandle.isValid())
+    {
+        return vertexCount * layout.stride + indexCount * indexSize;
+    }
+    return vertexCount * layout.stride + indexCount * indexSize + instanceCapacity * sizeof(glm::mat4)
+         + layerCapacity * sizeof(uint32_t);
+}
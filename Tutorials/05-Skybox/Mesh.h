@@ -3,30 +3,52 @@
 
 #include <glad/gl.h> // Include glad
 #include <vector>    // For storing vertices and indices
+#include <span>      // For passing per-instance data without copying
 #include <string>    // For error messages
 #include <iostream>  // For error reporting
 #include <glm/glm.hpp> // For glm::vec3, glm::vec2 etc.
 
-
-// Define a simple Vertex structure to hold common vertex attributes
-// This makes it easier to pass vertex data around.
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
-};
+#include "VertexLayout.h" // For Vertex and the GPU vertex layouts
+#include "MeshPool.h"     // For MeshPool::MeshHandle
 
 class Texture;
+class TextureArray;
 class Shader;
+class ShaderStage;
+class ProgramPipeline;
 
 class Mesh
 {
 public:
-    // Constructor: Stores the vertex and index data.
+    // Maximum number of textures a mesh can bind (uTexture0 .. uTexture7)
+    static constexpr unsigned int MAX_TEXTURES = 8;
+
+    // Texture unit of the texture array (uTextureArray), after the 2D texture units
+    static constexpr unsigned int TEXTURE_ARRAY_UNIT = MAX_TEXTURES;
+
+    // Attribute location of the texture array layer (uint aLayer), per instance or per draw
+    static constexpr GLuint LAYER_ATTRIBUTE = 7;
+
+    // What happens to the CPU-side geometry once setupMesh() has uploaded it
+    enum class RetentionPolicy
+    {
+        KEEP,              // Keep vertices, indices and bounds (setupMesh can be called again)
+        DROP_AFTER_UPLOAD, // Free vertices, indices and bounds after the upload
+        KEEP_BOUNDS        // Free vertices and indices, keep the bounds (e.g. for culling)
+    };
+
+    // Constructor: Copies the vertex and index data.
     // Does NOT generate OpenGL buffers or VAO here.
     // If indices is empty, the mesh will be drawn using glDrawArrays.
     Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices = std::vector<unsigned int>()); // Default empty indices
 
+    // Constructor: Takes ownership of the vertex and index data without copying it.
+    Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices = std::vector<unsigned int>());
+
+    // Constructor: References caller-owned vertex and index data without copying it.
+    // The data must stay alive until setupMesh() returns; the mesh forgets it after the upload.
+    Mesh(std::span<const Vertex> vertices, std::span<const unsigned int> indices = {});
+
     // Destructor: Deletes the OpenGL buffers and VAO.
     ~Mesh();
 
@@ -47,40 +69,171 @@ public:
 
     // Method to draw the mesh.
     // Draws using glDrawElements if indices are available, otherwise uses glDrawArrays.
-    // Requires the appropriate shader to be used beforehand.
+    // View and projection come from the per-frame uniform block (see FrameUniforms).
+    // With a texture array, layer selects the array layer for this draw (see setTextureArray).
+    // Only safe to call if isValid() is true.
+    void draw(const glm::mat4& model, uint32_t layer = 0);
+
+    // Method to draw many copies of the mesh with a single instanced draw call.
+    // Uploads the per-instance model matrices into the instance VBO (one buffer update)
+    // and issues one glDrawElementsInstanced / glDrawArraysInstanced call.
+    // The assigned shader must read the model matrix from the per-instance
+    // attribute at layout (location = 3) (a mat4 occupies locations 3..6).
+    // View and projection come from the per-frame uniform block (see FrameUniforms).
+    // With a texture array, layers holds one array layer per instance, uploaded next to the
+    // matrices and read from the attribute at LAYER_ATTRIBUTE (empty = layer 0 for all).
     // Only safe to call if isValid() is true.
-    void draw(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) const;
+    void drawInstanced(std::span<const glm::mat4> models, std::span<const uint32_t> layers = {});
+
+    // Set the GPU vertex layout, e.g. CompactVertexLayout::describe() for quantized formats.
+    // Must be called BEFORE setupMesh(). Defaults to StandardVertexLayout (same as Vertex).
+    void setVertexLayout(const VertexLayoutDesc& layout);
+
+    // Store the geometry in a shared MeshPool instead of buffers of its own (nullptr = own buffers).
+    // Must be called BEFORE setupMesh(); the pool must outlive the mesh. Pooled meshes with the
+    // same layout share the pool's VAO, so draws of different meshes do not switch VAOs.
+    // Quantized layouts cannot be pooled.
+    void setMeshPool(MeshPool* pool) { meshPool = pool; }
+    bool isPooled() const { return poolHandle.isValid(); }
+
+    // Get the axis-aligned bounds of the vertex positions (computed by setupMesh).
+    // Reset to zero after setupMesh() when the retention policy is DROP_AFTER_UPLOAD.
+    const PositionBounds& getBounds() const { return bounds; }
+
+    // Set what happens to the CPU-side geometry after the upload.
+    // Must be called BEFORE setupMesh(). Defaults to KEEP.
+    void setRetentionPolicy(RetentionPolicy policy) { retentionPolicy = policy; }
+    RetentionPolicy getRetentionPolicy() const { return retentionPolicy; }
+
+    // Check if the mesh still holds its CPU-side vertex data
+    bool hasCpuData() const { return !vertexView.empty(); }
+
+    // Number of vertices and indices uploaded by setupMesh (valid after the CPU data is dropped)
+    size_t getVertexCount() const { return vertexCount; }
+    size_t getIndexCount() const { return indexCount; }
+
+    // Memory owned by this mesh, in bytes.
+    // CPU: the vertex and index vectors (caller-owned span data is not counted).
+    // GPU: the vertex, index and instance buffers (for a pooled mesh, its share of the pool).
+    size_t getCpuMemoryBytes() const;
+    size_t getGpuMemoryBytes() const;
 
     // Check if the mesh was set up successfully (VAO is valid).
     bool isValid() const { return VAO != 0; }
 
-    // Get the VAO ID (use with caution).
+    // Get the VAO ID (use with caution). Pooled meshes return the VAO shared through the pool.
     GLuint getVAO() const { return VAO; }
 
     // Set the shader for this mesh
     void setShader(Shader* shader);
+
+    // Get the shader assigned to this mesh (may be nullptr)
+    Shader* getShader() const { return shader; }
+
+    // Draw with separately compiled stages through a shared pipeline instead of the shader
+    // (the vertex stage receives uModel, the fragment stage the sampler units).
+    // Pass nullptr to go back to the shader.
+    void setStages(ProgramPipeline* pipeline, const ShaderStage* vertexStage, const ShaderStage* fragmentStage)
+    {
+        this->pipeline = pipeline;
+        this->vertexStage = vertexStage;
+        this->fragmentStage = fragmentStage;
+    }
+
+    // Identity of the program (or pair of stages) this mesh draws with, for sorting draws (0 if none).
+    // Programs and stage pairs never share a key; RenderQueue maps keys to small sort indices.
+    uint64_t getProgramKey() const;
     
     // Add a texture to this mesh
     void addTexture(Texture* texture);
+
+    // Remove all textures added to this mesh (e.g. before switching it to a texture array)
+    void clearTextures() { textures.clear(); }
+
+    // Set the texture array sampled by this mesh (bound to TEXTURE_ARRAY_UNIT as uTextureArray).
+    // Meshes sharing an array share a texture binding, whatever layer each draw uses.
+    void setTextureArray(TextureArray* textureArray) { this->textureArray = textureArray; }
+    TextureArray* getTextureArray() const { return textureArray; }
+
+    // Get a 16-bit key identifying the set of textures bound by this mesh.
+    // Meshes with the same textures (in the same units) share the same key.
+    uint16_t getTextureSetKey() const;
 private:
-    // Mesh Data (stored in the object)
+    // Mesh Data (owned by the object: copied or moved in, empty for span construction)
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     
+    // The geometry setupMesh uploads: views of the vectors above, or of caller-owned memory
+    std::span<const Vertex> vertexView;
+    std::span<const unsigned int> indexView;
+    
+    // What to keep after the upload, and the uploaded element counts used for drawing
+    RetentionPolicy retentionPolicy = RetentionPolicy::KEEP;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    
     // Poiters to textures and shader used for this mesh
-    Shader* shader;
+    Shader* shader = nullptr;
+    ProgramPipeline* pipeline = nullptr;      // With the stages below, used instead of shader
+    const ShaderStage* vertexStage = nullptr;
+    const ShaderStage* fragmentStage = nullptr;
     std::vector<Texture*> textures;
+    TextureArray* textureArray = nullptr;
+
+    // GPU vertex layout and the data needed to undo its position quantization
+    VertexLayoutDesc layout = StandardVertexLayout::describe();
+    PositionBounds bounds;
+    glm::mat4 dequantization = glm::mat4(1.0f); // Maps quantized [0, 1] positions into bounds
+
+    // Shared pool holding the geometry instead of the buffers below (optional)
+    MeshPool* meshPool = nullptr;
+    MeshPool::MeshHandle poolHandle; // Valid once setupMesh() has allocated from the pool
 
     // OpenGL Render Data (generated in setupMesh)
-    GLuint VAO = 0; // Vertex Array Object
+    GLuint VAO = 0; // Vertex Array Object (owned by the pool when pooled)
     GLuint VBO = 0; // Vertex Buffer Object
     GLuint EBO = 0; // Element Buffer Object (Index Buffer) - 0 if not used
+    GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT when all indices fit in 16 bits
+
+    // Per-instance model matrices (created lazily by the first drawInstanced call)
+    GLuint instanceVBO = 0;
+    size_t instanceCapacity = 0; // Number of matrices the instance VBO can hold
+
+    // Per-instance texture array layers (created lazily by the first drawInstanced call with layers)
+    GLuint layerVBO = 0;
+    size_t layerCapacity = 0;            // Number of layers the layer VBO can hold
+    bool layerAttributeEnabled = false;  // Whether LAYER_ATTRIBUTE reads from layerVBO (VAO state)
 
     // Utility function for reporting errors
     void logError(const std::string& message) const;
 
     // Helper function to setup the buffer objects and vertex attributes
     void setupBuffers();
+
+    // Helper function to create the instance VBO and its divisor-1 attributes on the VAO
+    void setupInstanceBuffer();
+
+    // Helper function to create the layer VBO and its divisor-1 integer attribute on the VAO
+    void setupLayerBuffer();
+
+    // Helper function to source the layer attribute (VAO must be bound): from the layer VBO
+    // when perInstance is true, otherwise the constant layer for every vertex
+    void selectLayers(bool perInstance, uint32_t layer);
+
+    // Helper function to delete all OpenGL objects owned by this mesh
+    void deleteBuffers();
+
+    // Helper function to free the CPU-side geometry according to the retention policy
+    void releaseCpuData();
+
+    // Helper function to check if the mesh draws through its stages (all set and loaded)
+    bool usesStages() const;
+
+    // Helper function to bind the shader or the stages; returns false (and reports) if neither is valid
+    bool bindProgram(const char* caller) const;
+
+    // Helper function to bind the textures and set their sampler uniforms
+    void bindTextures() const;
 };
 
 #endif // MESH_H
@@ -0,0 +1,352 @@
+#include "MeshOptimizer.h"
+
+#include <unordered_map>
+#include <cstring>   // For std::memcmp, std::memcpy
+#include <cmath>     // For std::pow, std::sqrt
+#include <iostream>
+#include <iomanip>   // For std::setprecision
+#include <numeric>   // For std::iota
+
+// Byte-wise hash and equality for Vertex, so welding treats vertices as identical only if every attribute matches exactly
+namespace
+{
+    struct VertexHash
+    {
+        size_t operator()(const Vertex& vertex) const
+        {
+            // FNV-1a over the raw bytes (Vertex is tightly packed floats)
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+            size_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < sizeof(Vertex); i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    };
+
+    struct VertexEqual
+    {
+        bool operator()(const Vertex& a, const Vertex& b) const
+        {
+            return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+        }
+    };
+}
+
+// Run the full pipeline: weld, vertex cache optimization, vertex fetch optimization
+MeshOptimizer::Report MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    Report report;
+    report.verticesBefore = vertices.size();
+
+    // Statistics of the input as it would be drawn today
+    if (indices.empty())
+    {
+        std::vector<unsigned int> sequential(vertices.size());
+        std::iota(sequential.begin(), sequential.end(), 0u);
+        report.before = analyzeVertexCache(sequential, vertices.size());
+    }
+    else
+    {
+        report.before = analyzeVertexCache(indices, vertices.size());
+    }
+
+    weldVertices(vertices, indices);
+    optimizeVertexCache(indices, vertices.size());
+    optimizeVertexFetch(vertices, indices);
+
+    report.verticesAfter = vertices.size();
+    report.triangles = indices.size() / 3;
+    report.after = analyzeVertexCache(indices, vertices.size());
+    report.fits16BitIndices = vertices.size() <= 65536;
+    return report;
+}
+
+// Merge bit-identical vertices and rewrite (or generate) the index buffer
+void MeshOptimizer::weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    // Triangle list without indices: every vertex is referenced once, in order
+    if (indices.empty())
+    {
+        indices.resize(vertices.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+    }
+
+    std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> uniqueVertices;
+    uniqueVertices.reserve(vertices.size());
+
+    // remap[old] = new index of the first identical vertex
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        auto [it, inserted] = uniqueVertices.try_emplace(vertices[i], static_cast<unsigned int>(welded.size()));
+        if (inserted)
+        {
+            welded.push_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    for (unsigned int& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices = std::move(welded);
+}
+
+// Forsyth vertex score
+float MeshOptimizer::vertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+    {
+        return -1.0f; // No triangle left to use this vertex
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // The last triangle's vertices get a fixed score, so the next triangle does not simply reuse them all
+            score = 0.75f;
+        }
+        else
+        {
+            const float scale = 1.0f / (SCORING_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, 1.5f);
+        }
+    }
+
+    // Prefer vertices with few remaining triangles, so lone triangles are not left behind
+    score += 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+    return score;
+}
+
+// Reorder triangles to maximize post-transform vertex cache hits (Forsyth's linear-speed algorithm)
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Vertex -> triangle adjacency in compressed form (offsets + flat list)
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+    {
+        remaining[index]++;
+    }
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (size_t k = 0; k < 3; k++)
+            {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> newCache;
+    cache.reserve(SCORING_CACHE_SIZE + 3);
+    newCache.reserve(SCORING_CACHE_SIZE + 3);
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    size_t scanCursor = 0; // Fallback scan position for when the cache offers no candidate
+    long bestTriangle = -1;
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle < 0)
+        {
+            // Nothing in the cache: take the best remaining triangle
+            float bestScore = -1.0f;
+            for (size_t t = scanCursor; t < triangleCount; t++)
+            {
+                if (!emitted[t] && triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = static_cast<long>(t);
+                }
+            }
+            while (scanCursor < triangleCount && emitted[scanCursor]) scanCursor++;
+        }
+
+        const size_t t = static_cast<size_t>(bestTriangle);
+        emitted[t] = true;
+
+        // Emit the triangle and detach it from its vertices' remaining lists
+        for (size_t k = 0; k < 3; k++)
+        {
+            unsigned int v = indices[t * 3 + k];
+            output.push_back(v);
+
+            unsigned int* begin = adjacency.data() + adjacencyOffset[v];
+            unsigned int* end = begin + remaining[v];
+            for (unsigned int* it = begin; it != end; ++it)
+            {
+                if (*it == t)
+                {
+                    *it = *(end - 1);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        newCache.clear();
+        for (size_t k = 0; k < 3; k++)
+        {
+            newCache.push_back(indices[t * 3 + k]);
+        }
+        for (unsigned int v : cache)
+        {
+            if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+            {
+                newCache.push_back(v);
+            }
+        }
+
+        // Vertices pushed out of the cache lose their cache bonus, and so do their triangles
+        for (size_t i = SCORING_CACHE_SIZE; i < newCache.size(); i++)
+        {
+            unsigned int v = newCache[i];
+            cachePosition[v] = -1;
+            score[v] = vertexScore(-1, remaining[v]);
+
+            const unsigned int* begin = adjacency.data() + adjacencyOffset[v];
+            for (unsigned int j = 0; j < remaining[v]; j++)
+            {
+                unsigned int triangle = begin[j];
+                triangleScore[triangle] = score[indices[triangle * 3]] + score[indices[triangle * 3 + 1]] + score[indices[triangle * 3 + 2]];
+            }
+        }
+        if (newCache.size() > SCORING_CACHE_SIZE)
+        {
+            newCache.resize(SCORING_CACHE_SIZE);
+        }
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            cachePosition[newCache[i]] = static_cast<int>(i);
+            score[newCache[i]] = vertexScore(static_cast<int>(i), remaining[newCache[i]]);
+        }
+        cache.swap(newCache);
+
+        // Rescore the triangles around cached vertices and pick the best one as the next candidate
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache)
+        {
+            const unsigned int* begin = adjacency.data() + adjacencyOffset[v];
+            for (unsigned int i = 0; i < remaining[v]; i++)
+            {
+                unsigned int candidate = begin[i];
+                float candidateScore = score[indices[candidate * 3]] + score[indices[candidate * 3 + 1]] + score[indices[candidate * 3 + 2]];
+                triangleScore[candidate] = candidateScore;
+                if (candidateScore > bestScore)
+                {
+                    bestScore = candidateScore;
+                    bestTriangle = candidate;
+                }
+            }
+        }
+    }
+
+    indices = std::move(output);
+}
+
+// Reorder vertices in the order the index buffer first references them
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    const unsigned int unassigned = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(vertices.size(), unassigned);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices)
+    {
+        if (remap[index] == unassigned)
+        {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    // Unreferenced vertices are dropped
+    vertices = std::move(reordered);
+}
+
+// Simulate a FIFO post-transform cache and compute ACMR / ATVR
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    CacheStats stats;
+    if (indices.empty() || vertexCount == 0)
+    {
+        return stats;
+    }
+
+    // timestamp[v] = value of the miss counter when v entered the cache; v is cached while it is within cacheSize misses
+    std::vector<size_t> timestamp(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t misses = 0;
+    size_t uniqueVertices = 0;
+    for (unsigned int index : indices)
+    {
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            uniqueVertices++;
+        }
+        if (timestamp[index] == 0 || misses - timestamp[index] >= cacheSize)
+        {
+            misses++;
+            timestamp[index] = misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    return stats;
+}
+
+// Print a report to stdout
+void MeshOptimizer::printReport(const std::string& name, const Report& report)
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << "[MeshOptimizer] " << name << ": "
+              << report.verticesBefore << " -> " << report.verticesAfter << " vertices, "
+              << report.triangles << " triangles, "
+              << "ACMR " << report.before.acmr << " -> " << report.after.acmr << ", "
+              << "ATVR " << report.before.atvr << " -> " << report.after.atvr << ", "
+              << (report.fits16BitIndices ? "16-bit" : "32-bit") << " indices"
+              << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,69 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "Mesh.h" // For Vertex
+
+// Offline-style geometry optimization for Mesh data, run before Mesh::setupMesh().
+//   1. Welds identical vertices and generates an index buffer.
+//   2. Reorders triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm).
+//   3. Reorders vertices in first-use order for vertex fetch locality.
+// Mesh::setupMesh() then uploads 16-bit indices whenever the vertex count allows it.
+class MeshOptimizer
+{
+public:
+    // Post-transform vertex cache efficiency of an index buffer
+    struct CacheStats
+    {
+        float acmr = 0.0f; // Average cache miss ratio: transformed vertices per triangle (lower is better, >= 0.5)
+        float atvr = 0.0f; // Average transformed vertex ratio: transformed per unique vertex (1.0 is optimal)
+    };
+
+    // What optimize() did to a mesh
+    struct Report
+    {
+        size_t verticesBefore = 0;
+        size_t verticesAfter = 0;
+        size_t triangles = 0;
+        CacheStats before;
+        CacheStats after;
+        bool fits16BitIndices = false;
+    };
+
+    // Size of the simulated FIFO cache used by analyzeVertexCache (typical of current GPUs)
+    static constexpr unsigned int ANALYSIS_CACHE_SIZE = 16;
+
+    // Run the full pipeline: weld, vertex cache optimization, vertex fetch optimization.
+    // If indices is empty, vertices are treated as a triangle list and indices are generated.
+    static Report optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Merge bit-identical vertices and rewrite (or generate) the index buffer accordingly.
+    static void weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Reorder triangles to maximize post-transform vertex cache hits.
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+    // Reorder vertices in the order the index buffer first references them.
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Simulate a FIFO post-transform cache and compute ACMR / ATVR.
+    static CacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = ANALYSIS_CACHE_SIZE);
+
+    // Print a report to stdout
+    static void printReport(const std::string& name, const Report& report);
+
+private:
+    // Size of the LRU cache modelled by the Forsyth scoring function
+    static constexpr int SCORING_CACHE_SIZE = 32;
+
+    // Forsyth vertex score from the vertex's cache position (-1 if not cached) and remaining triangle count
+    static float vertexScore(int cachePosition, unsigned int remainingTriangles);
+
+    // Private constructor to prevent instantiation (it's a static utility class)
+    MeshOptimizer() = delete;
+};
+
+#endif // MESHOPTIMIZER_H
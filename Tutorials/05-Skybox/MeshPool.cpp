@@ -0,0 +1,527 @@
+#include "MeshPool.h"
+
+#include <algorithm> // For std::max, std::lower_bound, std::find_if
+#include <numeric>   // For std::iota
+
+#include "Mesh.h" // For Mesh::LAYER_ATTRIBUTE
+#include "RenderState.h"
+
+// Constructor: stores the initial capacities
+MeshPool::MeshPool(size_t vertexCapacity, size_t indexCapacity)
+: initialVertexCapacity(vertexCapacity), initialIndexCapacity(indexCapacity)
+{
+    // OpenGL objects are created per layout by allocate()
+}
+
+// Destructor: deletes the VAOs and buffers of all arenas
+MeshPool::~MeshPool()
+{
+    for (Arena& arena : arenas)
+    {
+        RenderState::onVertexArrayDeleted(arena.VAO);
+        glDeleteVertexArrays(1, &arena.VAO);
+        glDeleteBuffers(1, &arena.VBO);
+        glDeleteBuffers(1, &arena.EBO);
+        glDeleteBuffers(1, &arena.instanceVBO);
+        glDeleteBuffers(1, &arena.layerVBO);
+    }
+}
+
+// Find the arena of a layout, creating it on first use
+MeshPool::Arena* MeshPool::findOrCreateArena(const VertexLayoutDesc& layout, uint32_t& outIndex)
+{
+    auto it = std::find_if(arenas.begin(), arenas.end(), [&](const Arena& arena) { return arena.layout == layout; });
+    if (it != arenas.end())
+    {
+        outIndex = static_cast<uint32_t>(it - arenas.begin());
+        return &*it;
+    }
+
+    Arena arena;
+    arena.layout = layout;
+    arena.vertexCapacity = initialVertexCapacity;
+    arena.indexCapacity = initialIndexCapacity;
+
+    glGenVertexArrays(1, &arena.VAO);
+    glGenBuffers(1, &arena.VBO);
+    glGenBuffers(1, &arena.EBO);
+    if (arena.VAO == 0 || arena.VBO == 0 || arena.EBO == 0)
+    {
+        logError("Failed to generate the arena VAO or buffers.");
+        glDeleteVertexArrays(1, &arena.VAO);
+        glDeleteBuffers(1, &arena.VBO);
+        glDeleteBuffers(1, &arena.EBO);
+        return nullptr;
+    }
+
+    // Allocate the storage once; meshes are written into it with glBufferSubData
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, arena.vertexCapacity * layout.stride, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, arena.indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    arena.freeVertexRanges = { { 0, arena.vertexCapacity } };
+    arena.freeIndexRanges = { { 0, arena.indexCapacity } };
+
+    setupVertexArray(arena);
+    setupInstanceAttributes(arena);
+
+    outIndex = static_cast<uint32_t>(arenas.size());
+    arenas.push_back(std::move(arena));
+    return &arenas.back();
+}
+
+// Point the arena VAO's vertex attributes and element buffer at its current VBO/EBO
+void MeshPool::setupVertexArray(const Arena& arena)
+{
+    RenderState::bindVertexArray(arena.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, arena.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.EBO); // Recorded in the VAO
+
+    // Position (location = 0), normal (location = 1) and texture coordinates (location = 2),
+    // with the formats, offsets and stride described by the arena's layout
+    arena.layout.apply();
+
+    RenderState::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Create the arena's instance buffers and their divisor-1 attributes
+void MeshPool::setupInstanceAttributes(Arena& arena)
+{
+    glGenBuffers(1, &arena.instanceVBO);
+    glGenBuffers(1, &arena.layerVBO);
+
+    RenderState::bindVertexArray(arena.VAO);
+
+    // Instance model matrix attribute (layout (location = 3), columns at 3..6), as in Mesh
+    glBindBuffer(GL_ARRAY_BUFFER, arena.instanceVBO);
+    for (GLuint column = 0; column < 4; column++)
+    {
+        GLuint location = 3 + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // Integer layer attribute, read as an exact uint
+    glBindBuffer(GL_ARRAY_BUFFER, arena.layerVBO);
+    glVertexAttribIPointer(Mesh::LAYER_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+    glVertexAttribDivisor(Mesh::LAYER_ATTRIBUTE, 1);
+
+    // All left disabled: they are enabled per draw by selectInstanceAttributes()
+    RenderState::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Enable or disable the per-instance attributes of the bound arena VAO
+void MeshPool::selectInstanceAttributes(Arena& arena, bool instanced, bool perInstanceLayers, uint32_t layer)
+{
+    if (instanced != arena.instanceAttributesEnabled)
+    {
+        for (GLuint location = 3; location < 7; location++)
+        {
+            if (instanced)
+                glEnableVertexAttribArray(location);
+            else
+                glDisableVertexAttribArray(location);
+        }
+        arena.instanceAttributesEnabled = instanced;
+    }
+    if (perInstanceLayers != arena.layerAttributeEnabled)
+    {
+        if (perInstanceLayers)
+            glEnableVertexAttribArray(Mesh::LAYER_ATTRIBUTE);
+        else
+            glDisableVertexAttribArray(Mesh::LAYER_ATTRIBUTE);
+        arena.layerAttributeEnabled = perInstanceLayers;
+    }
+    if (!perInstanceLayers)
+    {
+        // A disabled attribute reads the current generic value: one layer for the whole draw
+        glVertexAttribI4ui(Mesh::LAYER_ATTRIBUTE, layer, 0, 0, 1);
+    }
+}
+
+// Copy a mesh into the arena of its layout
+MeshPool::MeshHandle MeshPool::allocate(const VertexLayoutDesc& layout, std::span<const Vertex> vertices,
+                                        std::span<const unsigned int> indices)
+{
+    if (vertices.empty())
+    {
+        logError("Attempted to allocate a mesh with empty vertex data.");
+        return MeshHandle();
+    }
+    if (layout.quantizedPositions)
+    {
+        logError("Quantized vertex layouts cannot be pooled (positions are relative to each mesh's bounds).");
+        return MeshHandle();
+    }
+
+    uint32_t arenaIndex = 0;
+    if (!findOrCreateArena(layout, arenaIndex))
+    {
+        return MeshHandle();
+    }
+
+    // Pooled meshes are always drawn with indices: give triangle lists a sequential index buffer
+    std::vector<unsigned int> sequentialIndices;
+    if (indices.empty())
+    {
+        sequentialIndices.resize(vertices.size());
+        std::iota(sequentialIndices.begin(), sequentialIndices.end(), 0u);
+        indices = sequentialIndices;
+    }
+
+    Allocation allocation;
+    allocation.arena = arenaIndex;
+    allocation.vertices.count = vertices.size();
+    allocation.indices.count = indices.size();
+    allocation.live = true;
+
+    Arena* arena = &arenas[arenaIndex];
+    bool vertexFit = allocateRange(arena->freeVertexRanges, allocation.vertices.count, allocation.vertices.offset);
+    bool indexFit = allocateRange(arena->freeIndexRanges, allocation.indices.count, allocation.indices.offset);
+    if (!vertexFit || !indexFit)
+    {
+        // Undo the half that succeeded, then make room
+        if (vertexFit) releaseRange(arena->freeVertexRanges, allocation.vertices);
+        if (indexFit) releaseRange(arena->freeIndexRanges, allocation.indices);
+
+        size_t neededVertices = arena->usedVertices + allocation.vertices.count;
+        size_t neededIndices = arena->usedIndices + allocation.indices.count;
+        if (neededVertices <= arena->vertexCapacity && neededIndices <= arena->indexCapacity)
+        {
+            // Enough space in total, it is just fragmented
+            relocate(arenaIndex, arena->vertexCapacity, arena->indexCapacity);
+        }
+        else
+        {
+            relocate(arenaIndex, std::max(arena->vertexCapacity * 2, neededVertices),
+                     std::max(arena->indexCapacity * 2, neededIndices));
+        }
+
+        if (!allocateRange(arena->freeVertexRanges, allocation.vertices.count, allocation.vertices.offset) ||
+            !allocateRange(arena->freeIndexRanges, allocation.indices.count, allocation.indices.offset))
+        {
+            logError("Failed to allocate " + std::to_string(vertices.size()) + " vertices after compaction.");
+            return MeshHandle();
+        }
+    }
+
+    // Upload through the copy-write target so no VAO's element buffer binding is touched
+    const size_t stride = arena->layout.stride;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena->VBO);
+    if (arena->layout.native)
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.vertices.offset * stride, vertices.size_bytes(), vertices.data());
+    }
+    else
+    {
+        // Encode into the (smaller) GPU layout first
+        std::vector<uint8_t> encoded(vertices.size() * stride);
+        arena->layout.encode(vertices, encoded.data(), PositionBounds{});
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.vertices.offset * stride, encoded.size(), encoded.data());
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena->EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.indices.offset * sizeof(unsigned int), indices.size_bytes(), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    arena->usedVertices += allocation.vertices.count;
+    arena->usedIndices += allocation.indices.count;
+
+    MeshHandle handle;
+    if (!freeIds.empty())
+    {
+        handle.id = freeIds.back();
+        freeIds.pop_back();
+        allocations[handle.id] = allocation;
+    }
+    else
+    {
+        handle.id = static_cast<uint32_t>(allocations.size());
+        allocations.push_back(allocation);
+    }
+    return handle;
+}
+
+// Check that a handle refers to a live allocation
+bool MeshPool::isLive(MeshHandle handle) const
+{
+    return handle.isValid() && handle.id < allocations.size() && allocations[handle.id].live;
+}
+
+// Release a mesh
+void MeshPool::free(MeshHandle handle)
+{
+    if (!isLive(handle))
+    {
+        logError("Attempted to free an invalid mesh handle.");
+        return;
+    }
+
+    Allocation& allocation = allocations[handle.id];
+    Arena& arena = arenas[allocation.arena];
+    releaseRange(arena.freeVertexRanges, allocation.vertices);
+    releaseRange(arena.freeIndexRanges, allocation.indices);
+    arena.usedVertices -= allocation.vertices.count;
+    arena.usedIndices -= allocation.indices.count;
+    allocation.live = false;
+    freeIds.push_back(handle.id);
+}
+
+// Repack all live meshes of every arena to the front of its buffers
+void MeshPool::compact()
+{
+    for (uint32_t i = 0; i < arenas.size(); i++)
+    {
+        relocate(i, arenas[i].vertexCapacity, arenas[i].indexCapacity);
+    }
+}
+
+// Move the live meshes of an arena, packed, into new buffers of the given capacities
+void MeshPool::relocate(uint32_t arenaIndex, size_t newVertexCapacity, size_t newIndexCapacity)
+{
+    Arena& arena = arenas[arenaIndex];
+    const size_t stride = arena.layout.stride;
+
+    GLuint newVBO = 0;
+    GLuint newEBO = 0;
+    glGenBuffers(1, &newVBO);
+    glGenBuffers(1, &newEBO);
+
+    // Copy the live vertex ranges, packed, with GPU-side copies (no CPU round trip)
+    glBindBuffer(GL_COPY_READ_BUFFER, arena.VBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, newVertexCapacity * stride, nullptr, GL_STATIC_DRAW);
+    size_t vertexCursor = 0;
+    for (Allocation& allocation : allocations)
+    {
+        if (!allocation.live || allocation.arena != arenaIndex) continue;
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            allocation.vertices.offset * stride, vertexCursor * stride,
+                            allocation.vertices.count * stride);
+        allocation.vertices.offset = vertexCursor;
+        vertexCursor += allocation.vertices.count;
+    }
+
+    // Same for the index ranges (indices are mesh-relative, so they need no rewriting)
+    glBindBuffer(GL_COPY_READ_BUFFER, arena.EBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, newIndexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+    size_t indexCursor = 0;
+    for (Allocation& allocation : allocations)
+    {
+        if (!allocation.live || allocation.arena != arenaIndex) continue;
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            allocation.indices.offset * sizeof(unsigned int), indexCursor * sizeof(unsigned int),
+                            allocation.indices.count * sizeof(unsigned int));
+        allocation.indices.offset = indexCursor;
+        indexCursor += allocation.indices.count;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Re-point the same VAO at the new buffers before the old ones go away
+    GLuint oldVBO = arena.VBO;
+    GLuint oldEBO = arena.EBO;
+    arena.VBO = newVBO;
+    arena.EBO = newEBO;
+    setupVertexArray(arena);
+    glDeleteBuffers(1, &oldVBO);
+    glDeleteBuffers(1, &oldEBO);
+    arena.vertexCapacity = newVertexCapacity;
+    arena.indexCapacity = newIndexCapacity;
+
+    // All free space is now one block at the end of each buffer
+    arena.freeVertexRanges.clear();
+    arena.freeIndexRanges.clear();
+    if (vertexCursor < arena.vertexCapacity) arena.freeVertexRanges.push_back({ vertexCursor, arena.vertexCapacity - vertexCursor });
+    if (indexCursor < arena.indexCapacity) arena.freeIndexRanges.push_back({ indexCursor, arena.indexCapacity - indexCursor });
+}
+
+// Draw the given pooled meshes with one multi-draw call per arena
+void MeshPool::draw(std::span<const MeshHandle> meshes, uint32_t layer)
+{
+    for (uint32_t arenaIndex = 0; arenaIndex < arenas.size(); arenaIndex++)
+    {
+        drawCounts.clear();
+        drawOffsets.clear();
+        drawBaseVertices.clear();
+        for (const MeshHandle& handle : meshes)
+        {
+            if (!isLive(handle) || allocations[handle.id].arena != arenaIndex)
+            {
+                continue; // Skip freed or invalid handles, and meshes of other arenas
+            }
+            const Allocation& allocation = allocations[handle.id];
+            drawCounts.push_back(static_cast<GLsizei>(allocation.indices.count));
+            drawOffsets.push_back(reinterpret_cast<const void*>(allocation.indices.offset * sizeof(unsigned int)));
+            drawBaseVertices.push_back(static_cast<GLint>(allocation.vertices.offset));
+        }
+
+        if (drawCounts.empty())
+        {
+            continue; // Nothing to draw from this arena
+        }
+
+        Arena& arena = arenas[arenaIndex];
+        RenderState::bindVertexArray(arena.VAO);
+        selectInstanceAttributes(arena, false, false, layer);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT,
+                                      drawOffsets.data(),
+                                      static_cast<GLsizei>(drawCounts.size()), drawBaseVertices.data());
+    }
+}
+
+// Draw instances of one pooled mesh
+void MeshPool::drawInstanced(MeshHandle mesh, std::span<const glm::mat4> models, std::span<const uint32_t> layers)
+{
+    if (!isLive(mesh))
+    {
+        logError("Attempted to draw an invalid mesh handle.");
+        return;
+    }
+    if (models.empty())
+    {
+        return; // Nothing to draw
+    }
+    if (!layers.empty() && layers.size() != models.size())
+    {
+        logError("Layer count does not match the instance count.");
+        return;
+    }
+
+    const Allocation& allocation = allocations[mesh.id];
+    Arena& arena = arenas[allocation.arena];
+
+    // Upload the per-instance model matrices, orphaning the previous storage so the driver
+    // does not wait for the last draw to finish reading it
+    glBindBuffer(GL_ARRAY_BUFFER, arena.instanceVBO);
+    arena.instanceCapacity = std::max(models.size(), arena.instanceCapacity);
+    glBufferData(GL_ARRAY_BUFFER, arena.instanceCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, models.size_bytes(), models.data());
+    if (!layers.empty())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, arena.layerVBO);
+        arena.layerCapacity = std::max(layers.size(), arena.layerCapacity);
+        glBufferData(GL_ARRAY_BUFFER, arena.layerCapacity * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, layers.size_bytes(), layers.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderState::bindVertexArray(arena.VAO);
+    selectInstanceAttributes(arena, true, !layers.empty(), 0);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(allocation.indices.count), GL_UNSIGNED_INT,
+                                      reinterpret_cast<const void*>(allocation.indices.offset * sizeof(unsigned int)),
+                                      static_cast<GLsizei>(models.size()), static_cast<GLint>(allocation.vertices.offset));
+}
+
+// VAO shared by the meshes of the handle's arena
+GLuint MeshPool::getVertexArray(MeshHandle handle) const
+{
+    return isLive(handle) ? arenas[allocations[handle.id].arena].VAO : 0;
+}
+
+// Memory statistics, summed over all arenas
+size_t MeshPool::getVertexCapacity() const
+{
+    size_t total = 0;
+    for (const Arena& arena : arenas) total += arena.vertexCapacity;
+    return total;
+}
+
+size_t MeshPool::getIndexCapacity() const
+{
+    size_t total = 0;
+    for (const Arena& arena : arenas) total += arena.indexCapacity;
+    return total;
+}
+
+size_t MeshPool::getUsedVertices() const
+{
+    size_t total = 0;
+    for (const Arena& arena : arenas) total += arena.usedVertices;
+    return total;
+}
+
+size_t MeshPool::getUsedIndices() const
+{
+    size_t total = 0;
+    for (const Arena& arena : arenas) total += arena.usedIndices;
+    return total;
+}
+
+// Number of meshes currently allocated
+size_t MeshPool::getLiveMeshCount() const
+{
+    return allocations.size() - freeIds.size();
+}
+
+// Memory of all arena buffers
+size_t MeshPool::getGpuMemoryBytes() const
+{
+    size_t total = 0;
+    for (const Arena& arena : arenas)
+    {
+        total += arena.vertexCapacity * arena.layout.stride + arena.indexCapacity * sizeof(unsigned int)
+               + arena.instanceCapacity * sizeof(glm::mat4) + arena.layerCapacity * sizeof(uint32_t);
+    }
+    return total;
+}
+
+// First-fit allocation from a free list
+bool MeshPool::allocateRange(std::vector<Range>& freeRanges, size_t count, size_t& outOffset)
+{
+    for (size_t i = 0; i < freeRanges.size(); i++)
+    {
+        Range& range = freeRanges[i];
+        if (range.count >= count)
+        {
+            outOffset = range.offset;
+            range.offset += count;
+            range.count -= count;
+            if (range.count == 0)
+            {
+                freeRanges.erase(freeRanges.begin() + i);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Return a range to a free list, merging it with its neighbours
+void MeshPool::releaseRange(std::vector<Range>& freeRanges, Range range)
+{
+    auto it = std::lower_bound(freeRanges.begin(), freeRanges.end(), range.offset,
+                               [](const Range& r, size_t offset) { return r.offset < offset; });
+    it = freeRanges.insert(it, range);
+
+    // Merge with the following range
+    auto next = it + 1;
+    if (next != freeRanges.end() && it->offset + it->count == next->offset)
+    {
+        it->count += next->count;
+        freeRanges.erase(next);
+    }
+
+    // Merge with the preceding range
+    if (it != freeRanges.begin())
+    {
+        auto prev = it - 1;
+        if (prev->offset + prev->count == it->offset)
+        {
+            prev->count += it->count;
+            freeRanges.erase(it);
+        }
+    }
+}
+
+// Utility function for reporting errors
+void MeshPool::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::MESHPOOL::" << message << std::endl;
+}
@@ -0,0 +1,174 @@
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "VertexLayout.h" // For Vertex and VertexLayoutDesc
+
+// Shared geometry arena for meshes.
+// Vertices and indices of many meshes are suballocated from a few large buffers: one
+// VBO, EBO and VAO per vertex layout (an "arena"), so meshes with the same layout share
+// one VAO and any set of them is drawn with one glMultiDrawElementsBaseVertex call.
+// Meshes can be freed at any time; compact() (or running out of space) repacks the
+// live meshes to the front of the buffers so streaming meshes in and out does not
+// fragment GPU memory. Handles and VAOs stay valid across compaction and growth.
+//
+// Each arena's VAO also carries the per-instance attributes Mesh uses (the model matrix at
+// locations 3..6 and the layer at Mesh::LAYER_ATTRIBUTE), sourced from buffers owned by
+// the arena, so pooled meshes can be drawn instanced from the shared VAO. GL 4.1 has no
+// base instance, so every instanced draw rewrites those buffers from instance 0.
+//
+// GL 4.1 has no gl_DrawID either, so all meshes in one draw() share the model matrix:
+// multi-draws are meant for static geometry stored in world (or a shared object) space.
+// Quantized layouts keep their positions relative to each mesh's bounds, so they are rejected.
+class MeshPool
+{
+public:
+    // Handle to a mesh allocated in the pool
+    struct MeshHandle
+    {
+        uint32_t id = INVALID_ID;
+        bool isValid() const { return id != INVALID_ID; }
+    };
+
+    static constexpr uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+    // Constructor: stores the initial capacities of each arena (in vertices and indices).
+    // Does NOT create any OpenGL objects: an arena is created by the first allocation with its layout.
+    MeshPool(size_t vertexCapacity = 1 << 16, size_t indexCapacity = 1 << 18);
+
+    // Destructor: deletes the VAOs and buffers of all arenas.
+    ~MeshPool();
+
+    // Prevent copying (owns OpenGL objects)
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // Copy a mesh into the arena of the given layout (encoding it if the layout is not native).
+    // Empty indices means the vertices are a plain triangle list.
+    // Grows the buffers (after trying compaction) if there is not enough contiguous space.
+    // Must be called with a valid OpenGL context current. Returns an invalid handle on failure.
+    MeshHandle allocate(const VertexLayoutDesc& layout, std::span<const Vertex> vertices,
+                        std::span<const unsigned int> indices = {});
+
+    // Release a mesh. Its space is reused by later allocations.
+    void free(MeshHandle handle);
+
+    // Repack all live meshes of every arena to the front of its buffers, merging all free space into one block.
+    void compact();
+
+    // Draw the given pooled meshes with one glMultiDrawElementsBaseVertex call per arena
+    // (a single call when they share a layout). layer is the constant value of the layer attribute.
+    // Requires the appropriate shader to be used (and its model matrix set) beforehand.
+    void draw(std::span<const MeshHandle> meshes, uint32_t layer = 0);
+
+    // Draw instances of one pooled mesh with glDrawElementsInstancedBaseVertex.
+    // The model matrices (and the per-instance layers, if not empty) are uploaded into the arena's
+    // instance buffers. Requires the appropriate shader to be used beforehand.
+    void drawInstanced(MeshHandle mesh, std::span<const glm::mat4> models, std::span<const uint32_t> layers = {});
+
+    // VAO shared by the meshes of the handle's arena (0 for an invalid handle)
+    GLuint getVertexArray(MeshHandle handle) const;
+
+    // Memory statistics (in vertices / indices, summed over all arenas)
+    size_t getVertexCapacity() const;
+    size_t getIndexCapacity() const;
+    size_t getUsedVertices() const;
+    size_t getUsedIndices() const;
+    size_t getLiveMeshCount() const;
+    size_t getArenaCount() const { return arenas.size(); }
+
+    // Memory of all arena buffers (vertex, index and instance), in bytes
+    size_t getGpuMemoryBytes() const;
+
+private:
+    // A contiguous range of elements (vertices or indices)
+    struct Range
+    {
+        size_t offset;
+        size_t count;
+    };
+
+    // The buffers and VAO shared by all meshes of one vertex layout
+    struct Arena
+    {
+        VertexLayoutDesc layout;
+        size_t vertexCapacity = 0;
+        size_t indexCapacity = 0;
+        size_t usedVertices = 0;
+        size_t usedIndices = 0;
+
+        GLuint VAO = 0;
+        GLuint VBO = 0;
+        GLuint EBO = 0;
+
+        // Per-instance model matrices and layers, rewritten by every drawInstanced
+        GLuint instanceVBO = 0;
+        GLuint layerVBO = 0;
+        size_t instanceCapacity = 0;
+        size_t layerCapacity = 0;
+        bool instanceAttributesEnabled = false; // VAO state: locations 3..6 read the instance VBO
+        bool layerAttributeEnabled = false;     // VAO state: the layer attribute reads the layer VBO
+
+        std::vector<Range> freeVertexRanges; // Sorted by offset, coalesced
+        std::vector<Range> freeIndexRanges;  // Sorted by offset, coalesced
+    };
+
+    // Where a mesh lives in the pool
+    struct Allocation
+    {
+        uint32_t arena = 0;
+        Range vertices;
+        Range indices;
+        bool live = false;
+    };
+
+    size_t initialVertexCapacity;
+    size_t initialIndexCapacity;
+
+    std::vector<Arena> arenas;           // One per vertex layout, found by layout
+    std::vector<Allocation> allocations; // Indexed by MeshHandle::id
+    std::vector<uint32_t> freeIds;       // Reusable allocation slots
+
+    // Scratch arrays for draw(), kept to avoid per-frame allocations
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+    std::vector<GLint> drawBaseVertices;
+
+    // Find the arena of a layout, creating it on first use. Returns nullptr on failure.
+    Arena* findOrCreateArena(const VertexLayoutDesc& layout, uint32_t& outIndex);
+
+    // Check that a handle refers to a live allocation
+    bool isLive(MeshHandle handle) const;
+
+    // First-fit allocation from a free list. Returns false if no range is large enough.
+    static bool allocateRange(std::vector<Range>& freeRanges, size_t count, size_t& outOffset);
+
+    // Return a range to a free list, merging it with its neighbours
+    static void releaseRange(std::vector<Range>& freeRanges, Range range);
+
+    // Move the live meshes of an arena, packed, into new buffers of the given capacities
+    void relocate(uint32_t arenaIndex, size_t newVertexCapacity, size_t newIndexCapacity);
+
+    // Point the arena VAO's vertex attributes and element buffer at its current VBO/EBO
+    static void setupVertexArray(const Arena& arena);
+
+    // Create the arena's instance buffers and their divisor-1 attributes (left disabled)
+    static void setupInstanceAttributes(Arena& arena);
+
+    // Enable or disable the per-instance attributes (arena VAO must be bound); a disabled
+    // layer attribute reads the constant layer instead
+    static void selectInstanceAttributes(Arena& arena, bool instanced, bool perInstanceLayers, uint32_t layer);
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // MESHPOOL_H
@@ -0,0 +1,362 @@
+#include "MipGenerator.h"
+
+#include <algorithm> // For std::min, std::max, std::clamp
+#include <cmath>     // For std::sin, std::sqrt, std::pow, std::floor, std::ceil
+#include <functional>
+#include <future>    // For waiting on the worker jobs
+
+#include "ThreadPool.h"
+
+// Pick the vector instruction set for the filter kernels
+#if defined(__SSE2__) || defined(_M_X64)
+#define MIPGENERATOR_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define MIPGENERATOR_NEON 1
+#include <arm_neon.h>
+#endif
+
+// A level being filtered: RGBA float per pixel, color in linear light if gamma-correct
+struct FloatImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> pixels; // width * height * 4
+};
+
+// Filter taps of one output pixel along one axis
+struct FilterTaps
+{
+    std::vector<int> start;    // Per output pixel: first entry in index / weight
+    std::vector<int> count;    // Per output pixel: number of taps
+    std::vector<int> index;    // Source pixel of each tap (clamped to the edge)
+    std::vector<float> weight; // Normalized weight of each tap
+};
+
+// ---------------------------------------------------------------------------
+// Filter kernels
+// ---------------------------------------------------------------------------
+
+static float sinc(float x)
+{
+    if (std::abs(x) < 1e-5f) {
+        return 1.0f;
+    }
+    x *= 3.14159265358979f;
+    return std::sin(x) / x;
+}
+
+// Modified Bessel function of the first kind, order 0 (series expansion)
+static float bessel0(float x)
+{
+    float sum = 1.0f, term = 1.0f;
+    for (int k = 1; k < 32; k++)
+    {
+        float factor = x / (2.0f * k);
+        term *= factor * factor;
+        sum += term;
+        if (term < sum * 1e-8f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Radius of the filter, in destination pixels
+static float filterRadius(MipFilter filter)
+{
+    return filter == MipFilter::BOX ? 0.5f : 3.0f;
+}
+
+// Weight at distance t from the output pixel center, in destination pixels
+static float filterWeight(MipFilter filter, float t)
+{
+    const float radius = filterRadius(filter);
+    if (std::abs(t) >= radius) {
+        return 0.0f;
+    }
+    switch (filter)
+    {
+        case MipFilter::BOX:
+            return 1.0f;
+        case MipFilter::LANCZOS:
+            return sinc(t) * sinc(t / radius);
+        case MipFilter::KAISER:
+        default:
+        {
+            const float alpha = 4.0f;
+            float ratio = t / radius;
+            return sinc(t) * bessel0(alpha * std::sqrt(1.0f - ratio * ratio)) / bessel0(alpha);
+        }
+    }
+}
+
+// Compute the taps mapping sourceSize pixels onto destinationSize pixels
+static FilterTaps computeTaps(MipFilter filter, int sourceSize, int destinationSize)
+{
+    FilterTaps taps;
+    const float scale = static_cast<float>(sourceSize) / destinationSize;
+    const float support = filterRadius(filter) * scale;
+    for (int i = 0; i < destinationSize; i++)
+    {
+        float center = (i + 0.5f) * scale; // In source pixels
+        int first = static_cast<int>(std::floor(center - support));
+        int last = static_cast<int>(std::ceil(center + support));
+
+        taps.start.push_back(static_cast<int>(taps.index.size()));
+        float total = 0.0f;
+        for (int j = first; j <= last; j++)
+        {
+            float w = filterWeight(filter, ((j + 0.5f) - center) / scale);
+            if (w == 0.0f) {
+                continue;
+            }
+            taps.index.push_back(std::clamp(j, 0, sourceSize - 1));
+            taps.weight.push_back(w);
+            total += w;
+        }
+        int count = static_cast<int>(taps.index.size()) - taps.start.back();
+        for (int k = 0; k < count; k++) {
+            taps.weight[taps.start.back() + k] /= total;
+        }
+        taps.count.push_back(count);
+    }
+    return taps;
+}
+
+// ---------------------------------------------------------------------------
+// Vectorized passes
+// ---------------------------------------------------------------------------
+
+// Horizontal pass over source rows [firstRow, endRow): each output pixel is a weighted sum of RGBA source pixels
+static void filterRows(const FloatImage& source, FloatImage& destination, const FilterTaps& taps, int firstRow, int endRow)
+{
+    for (int y = firstRow; y < endRow; y++)
+    {
+        const float* sourceRow = source.pixels.data() + static_cast<size_t>(y) * source.width * 4;
+        float* destinationRow = destination.pixels.data() + static_cast<size_t>(y) * destination.width * 4;
+        for (int x = 0; x < destination.width; x++)
+        {
+            const int* index = taps.index.data() + taps.start[x];
+            const float* weight = taps.weight.data() + taps.start[x];
+            const int count = taps.count[x];
+#if MIPGENERATOR_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < count; k++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(sourceRow + 4 * index[k]), _mm_set1_ps(weight[k])));
+            }
+            _mm_storeu_ps(destinationRow + 4 * x, sum);
+#elif MIPGENERATOR_NEON
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (int k = 0; k < count; k++) {
+                sum = vmlaq_n_f32(sum, vld1q_f32(sourceRow + 4 * index[k]), weight[k]);
+            }
+            vst1q_f32(destinationRow + 4 * x, sum);
+#else
+            float sum[4] = { 0, 0, 0, 0 };
+            for (int k = 0; k < count; k++) {
+                for (int c = 0; c < 4; c++) sum[c] += sourceRow[4 * index[k] + c] * weight[k];
+            }
+            for (int c = 0; c < 4; c++) destinationRow[4 * x + c] = sum[c];
+#endif
+        }
+    }
+}
+
+// Vertical pass over output rows [firstRow, endRow): each output row is a weighted sum of source rows
+static void filterColumns(const FloatImage& source, FloatImage& destination, const FilterTaps& taps, int firstRow, int endRow)
+{
+    const int rowFloats = destination.width * 4; // Same width in source and destination
+    for (int y = firstRow; y < endRow; y++)
+    {
+        float* destinationRow = destination.pixels.data() + static_cast<size_t>(y) * rowFloats;
+        std::fill(destinationRow, destinationRow + rowFloats, 0.0f);
+        for (int k = 0; k < taps.count[y]; k++)
+        {
+            const float* sourceRow = source.pixels.data() + static_cast<size_t>(taps.index[taps.start[y] + k]) * rowFloats;
+            const float w = taps.weight[taps.start[y] + k];
+            // Rows are whole RGBA pixels, so always a multiple of 4 floats
+#if MIPGENERATOR_SSE2
+            const __m128 weight = _mm_set1_ps(w);
+            for (int i = 0; i < rowFloats; i += 4) {
+                _mm_storeu_ps(destinationRow + i, _mm_add_ps(_mm_loadu_ps(destinationRow + i), _mm_mul_ps(_mm_loadu_ps(sourceRow + i), weight)));
+            }
+#elif MIPGENERATOR_NEON
+            for (int i = 0; i < rowFloats; i += 4) {
+                vst1q_f32(destinationRow + i, vmlaq_n_f32(vld1q_f32(destinationRow + i), vld1q_f32(sourceRow + i), w));
+            }
+#else
+            for (int i = 0; i < rowFloats; i++) {
+                destinationRow[i] += sourceRow[i] * w;
+            }
+#endif
+        }
+    }
+}
+
+// Run rowFunction over [0, rowCount) in chunks on the pool (or inline without one)
+static void forEachRowRange(int rowCount, ThreadPool* pool, const std::function<void(int, int)>& rowFunction)
+{
+    // Small levels are not worth the scheduling overhead
+    if (!pool || rowCount < 64)
+    {
+        rowFunction(0, rowCount);
+        return;
+    }
+    int chunkCount = std::min(rowCount / 16, static_cast<int>(pool->getThreadCount()) * 4);
+    std::vector<std::future<void>> jobs;
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+        int first = rowCount * chunk / chunkCount;
+        int end = rowCount * (chunk + 1) / chunkCount;
+        jobs.push_back(pool->submit([&rowFunction, first, end]() { rowFunction(first, end); }));
+    }
+    for (std::future<void>& job : jobs) {
+        job.get();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Conversion between 8-bit images and float levels
+// ---------------------------------------------------------------------------
+
+// Number of leading channels holding color (the rest is alpha)
+static int colorChannelCount(int channels)
+{
+    return (channels == 2 || channels == 4) ? channels - 1 : channels;
+}
+
+// 8-bit sRGB to linear
+static const float* srgbToLinearTable()
+{
+    static const std::vector<float> table = []() {
+        std::vector<float> values(256);
+        for (int i = 0; i < 256; i++)
+        {
+            float v = i / 255.0f;
+            values[i] = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+// Linear (quantized to 12 bits) to 8-bit sRGB
+static const unsigned char* linearToSrgbTable()
+{
+    static const std::vector<unsigned char> table = []() {
+        std::vector<unsigned char> values(4096);
+        for (int i = 0; i < 4096; i++)
+        {
+            float v = i / 4095.0f;
+            float s = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+            values[i] = static_cast<unsigned char>(std::clamp(s * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+// Expand an 8-bit image to RGBA float (unused channels are 0)
+static FloatImage toFloat(const Image& image, bool gammaCorrect)
+{
+    FloatImage result;
+    result.width = image.width;
+    result.height = image.height;
+    result.pixels.assign(static_cast<size_t>(image.width) * image.height * 4, 0.0f);
+    const float* toLinear = srgbToLinearTable();
+    const int colorChannels = colorChannelCount(image.channels);
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (int c = 0; c < image.channels; c++)
+        {
+            unsigned char value = image.pixels[i * image.channels + c];
+            result.pixels[i * 4 + c] = (gammaCorrect && c < colorChannels) ? toLinear[value] : value / 255.0f;
+        }
+    }
+    return result;
+}
+
+// Quantize a float level back to an 8-bit image with the given channel count
+static Image toImage(const FloatImage& level, int channels, bool gammaCorrect, const std::string& source)
+{
+    Image image;
+    image.width = level.width;
+    image.height = level.height;
+    image.channels = channels;
+    image.source = source;
+    image.pixels.resize(static_cast<size_t>(level.width) * level.height * channels);
+    const unsigned char* toSrgb = linearToSrgbTable();
+    const int colorChannels = colorChannelCount(channels);
+    const size_t pixelCount = static_cast<size_t>(level.width) * level.height;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            // Sharpening filters overshoot: clamp to [0, 1]
+            float value = std::clamp(level.pixels[i * 4 + c], 0.0f, 1.0f);
+            image.pixels[i * channels + c] = (gammaCorrect && c < colorChannels)
+                ? toSrgb[static_cast<int>(value * 4095.0f + 0.5f)]
+                : static_cast<unsigned char>(value * 255.0f + 0.5f);
+        }
+    }
+    return image;
+}
+
+// ---------------------------------------------------------------------------
+// Public interface
+// ---------------------------------------------------------------------------
+
+// Number of levels in a full chain
+int MipGenerator::getLevelCount(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+        levels++;
+    }
+    return levels;
+}
+
+// Generate mip levels 1..N from a base image
+std::vector<Image> MipGenerator::generate(const Image& base, const MipOptions& options, ThreadPool* pool)
+{
+    std::vector<Image> levels;
+    if (!base.isValid()) {
+        return levels;
+    }
+
+    FloatImage current = toFloat(base, options.gammaCorrect);
+    while (current.width > 1 || current.height > 1)
+    {
+        const int width = std::max(current.width / 2, 1);
+        const int height = std::max(current.height / 2, 1);
+
+        // Horizontal pass: current.width -> width, on every source row
+        FloatImage horizontal;
+        horizontal.width = width;
+        horizontal.height = current.height;
+        horizontal.pixels.resize(static_cast<size_t>(width) * current.height * 4);
+        const FilterTaps columnTaps = computeTaps(options.filter, current.width, width);
+        forEachRowRange(current.height, pool, [&](int first, int end) {
+            filterRows(current, horizontal, columnTaps, first, end);
+        });
+
+        // Vertical pass: current.height -> height
+        FloatImage next;
+        next.width = width;
+        next.height = height;
+        next.pixels.resize(static_cast<size_t>(width) * height * 4);
+        const FilterTaps rowTaps = computeTaps(options.filter, current.height, height);
+        forEachRowRange(height, pool, [&](int first, int end) {
+            filterColumns(horizontal, next, rowTaps, first, end);
+        });
+
+        levels.push_back(toImage(next, base.channels, options.gammaCorrect, base.source));
+        current = std::move(next);
+    }
+    return levels;
+}
@@ -0,0 +1,53 @@
+#ifndef MIPGENERATOR_H
+#define MIPGENERATOR_H
+
+#include <vector>
+
+#include "Image.h"
+
+class ThreadPool;
+
+// Downsampling filter used to build each mip level from the one above it
+enum class MipFilter
+{
+    BOX,     // 2x2 average: cheapest, slightly blurry
+    KAISER,  // Kaiser-windowed sinc (radius 3, alpha 4): sharp with little ringing
+    LANCZOS  // Lanczos-3: sharpest, can ring on hard edges
+};
+
+// Options for MipGenerator::generate
+struct MipOptions
+{
+    MipFilter filter = MipFilter::KAISER;
+
+    // Filter color channels in linear light (decode sRGB first, re-encode after).
+    // Averaging sRGB values directly darkens mips; disable for non-color data (normals, masks).
+    // Alpha is always filtered as stored.
+    bool gammaCorrect = true;
+};
+
+// Builds mip chains on the CPU, so the result is the same on every driver and the
+// work can run on worker threads instead of glGenerateMipmap on the GL thread.
+//
+// Each level is filtered from the previous one in 32-bit float (RGBA per pixel, one SIMD
+// register with SSE or NEON), in two separable passes: horizontal, then vertical.
+// Levels are only quantized to 8 bits for output, so errors do not accumulate down the chain.
+class MipGenerator
+{
+public:
+    // Generate mip levels 1..N (halving each time, down to 1x1) from a base image.
+    // The returned levels have the base image's channel count; level 0 is not included.
+    // When a pool is given, rows are split across its workers. Do NOT pass the pool the
+    // caller is running on (a job waiting on jobs in its own pool can deadlock it);
+    // inside a pool job, pass nullptr and let other jobs provide the parallelism.
+    static std::vector<Image> generate(const Image& base, const MipOptions& options = MipOptions(), ThreadPool* pool = nullptr);
+
+    // Number of levels in a full chain for the given size, including level 0
+    static int getLevelCount(int width, int height);
+
+private:
+    // Private constructor to prevent instantiation (it's a static utility class)
+    MipGenerator() = delete;
+};
+
+#endif // MIPGENERATOR_H
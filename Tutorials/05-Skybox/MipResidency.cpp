@@ -0,0 +1,242 @@
+#include "MipResidency.h"
+
+#include <algorithm> // For std::sort, std::clamp
+#include <cmath>     // For std::log2, std::floor
+#include <iostream>  // For error reporting
+
+#include "Texture.h"
+#include "TextureStreamer.h"
+
+// Levels a texture may keep beyond its required one before they are dropped, so a camera
+// hovering near a level boundary does not stream the same level in and out
+static constexpr int DROP_HYSTERESIS = 1;
+
+// Most levels started per update(), bounding the upload work of one frame without a streamer
+static constexpr int MAX_LEVELS_PER_UPDATE = 4;
+
+// Distance below which a surface counts as touching the camera (avoids dividing by zero)
+static constexpr float MIN_DISTANCE = 0.01f;
+
+// Constructor: Stores the budget, streamer and resident size
+MipResidency::MipResidency(size_t budgetBytes, TextureStreamer* streamer, int residentSize)
+: budgetBytes(budgetBytes), streamer(streamer), residentSize(std::max(residentSize, 1))
+{
+}
+
+// Destructor: Finishes the levels still streaming
+MipResidency::~MipResidency()
+{
+    bool streaming = std::any_of(entries.begin(), entries.end(), [](const auto& entry) { return entry.second.streamingBytes > 0; });
+    if (streamer && streaming) {
+        streamer->flush();
+    }
+}
+
+// Upload the coarse levels of a decoded image and manage the rest
+bool MipResidency::add(Texture* texture, Image image, std::vector<Image> mipLevels)
+{
+    if (!texture || !image.isValid())
+    {
+        logError("ADD::Invalid texture or image.");
+        return false;
+    }
+    remove(texture); // Adding again replaces the chain
+
+    auto chain = std::make_shared<MipChain>();
+    chain->image = std::move(image);
+    chain->mipLevels = std::move(mipLevels);
+
+    // The finest level no larger than residentSize stays resident for good
+    const int lastLevel = static_cast<int>(chain->mipLevels.size());
+    int residentLevel = 0;
+    while (residentLevel < lastLevel && std::max(chain->getLevel(residentLevel).width, chain->getLevel(residentLevel).height) > residentSize) {
+        residentLevel++;
+    }
+    if (!texture->upload(chain->image, chain->mipLevels, residentLevel)) {
+        return false; // Error already printed by upload
+    }
+
+    Entry entry;
+    entry.texture = texture;
+    entry.chain = std::move(chain);
+    entry.residentLevel = residentLevel;
+    entry.requiredLevel = residentLevel;
+    entries[texture] = std::move(entry);
+    return true;
+}
+
+// Stop managing a texture
+void MipResidency::remove(Texture* texture)
+{
+    auto found = entries.find(texture);
+    if (found == entries.end()) {
+        return;
+    }
+    // The streaming callback refers to the entry: let it complete first
+    if (found->second.streamingBytes > 0 && streamer) {
+        streamer->flush();
+    }
+    entries.erase(texture);
+}
+
+// Record a surface textured by the texture
+void MipResidency::addUsage(Texture* texture, const glm::vec3& center, float worldSize)
+{
+    usages[texture].push_back({ center, worldSize });
+}
+
+// Forget every usage of a texture
+void MipResidency::clearUsages(Texture* texture)
+{
+    usages.erase(texture);
+}
+
+// Get the finest level update() last estimated for a texture
+int MipResidency::getRequiredLevel(const Texture* texture) const
+{
+    auto found = entries.find(texture);
+    return found != entries.end() ? found->second.requiredLevel : -1;
+}
+
+// Bytes of one level of an entry's chain
+size_t MipResidency::getLevelBytes(const Entry& entry, int level)
+{
+    return entry.chain->getLevel(level).pixels.size();
+}
+
+// Finest level the usages of a texture need
+int MipResidency::estimateRequiredLevel(const Entry& entry, const glm::vec3& cameraPosition, float pixelScale) const
+{
+    auto found = usages.find(entry.texture);
+    if (found == usages.end() || found->second.empty()) {
+        return entry.residentLevel; // Not drawn anywhere: the coarse levels are enough
+    }
+
+    // The largest projection of any usage decides (usages behind the camera count too,
+    // so turning around does not have to wait for the levels to stream in again)
+    float largestPixels = 0.0f;
+    for (const Usage& usage : found->second)
+    {
+        float distance = std::max(glm::length(usage.center - cameraPosition) - 0.5f * usage.worldSize, MIN_DISTANCE);
+        largestPixels = std::max(largestPixels, usage.worldSize * pixelScale / distance);
+    }
+    if (largestPixels <= 0.0f) {
+        return entry.residentLevel;
+    }
+
+    // Each level halves the texels across the surface: stop at the first one with about a texel per pixel
+    const Image& image = entry.chain->image;
+    float texelsPerPixel = static_cast<float>(std::max(image.width, image.height)) / largestPixels;
+    int level = texelsPerPixel > 1.0f ? static_cast<int>(std::floor(std::log2(texelsPerPixel))) : 0;
+    return std::clamp(level, 0, entry.residentLevel);
+}
+
+// Start making the next finer level of an entry resident
+bool MipResidency::streamInLevel(Entry& entry)
+{
+    const int level = entry.texture->getBaseLevel() - 1;
+    const size_t bytes = getLevelBytes(entry, level);
+    Texture* texture = entry.texture;
+    auto onComplete = [this, texture]() {
+        auto found = entries.find(texture);
+        if (found != entries.end()) {
+            found->second.streamingBytes = 0;
+        }
+        stats.levelsStreamedIn++;
+    };
+    // The chain owns the pixels, and the streamer keeps it alive until the level is in
+    if (streamer) {
+        entry.streamingBytes = bytes;
+    }
+    if (!texture->streamInLevel(entry.chain->getLevel(level), streamer, entry.chain, onComplete))
+    {
+        entry.streamingBytes = 0;
+        return false;
+    }
+    return true;
+}
+
+// Estimate the required levels, then stream levels in or drop them under the budget
+void MipResidency::update(const Camera& camera, const glm::mat4& projection, int viewportHeight)
+{
+    // projection[1][1] is cot(fovY / 2): a size s at distance d covers s * projection[1][1] / d
+    // of the [-1, 1] clip range, so this converts s / d to pixels
+    const float pixelScale = 0.5f * static_cast<float>(viewportHeight) * projection[1][1];
+
+    // 1. Estimate the required level of every texture, and drop the levels it no longer needs
+    std::vector<Entry*> managed;
+    managed.reserve(entries.size());
+    size_t residentBytes = 0;
+    stats.requiredBytes = 0;
+    for (auto& [key, entry] : entries)
+    {
+        Texture* texture = entry.texture;
+        entry.requiredLevel = estimateRequiredLevel(entry, camera.position, pixelScale);
+        const int baseLevel = texture->getBaseLevel();
+        if (entry.streamingBytes == 0 && baseLevel < entry.requiredLevel - DROP_HYSTERESIS)
+        {
+            texture->dropLevelsBelow(entry.requiredLevel);
+            stats.levelsDropped += entry.requiredLevel - baseLevel;
+        }
+        residentBytes += texture->getGpuMemoryBytes() + entry.streamingBytes;
+        for (int level = entry.requiredLevel; level < texture->getLevelCount(); level++) {
+            stats.requiredBytes += getLevelBytes(entry, level);
+        }
+        managed.push_back(&entry);
+    }
+
+    // How many levels an entry is short of (negative: more than it needs)
+    auto missingLevels = [](const Entry* entry) { return entry->texture->getBaseLevel() - entry->requiredLevel; };
+
+    // 2. Over budget (e.g. after setBudget): the textures closest to (or past) their required
+    // level give up their finest level first, so quality degrades evenly
+    while (residentBytes > budgetBytes)
+    {
+        Entry* victim = nullptr;
+        for (Entry* entry : managed)
+        {
+            if (entry->streamingBytes > 0 || entry->texture->getBaseLevel() >= entry->residentLevel) {
+                continue; // Busy, or down to its coarse levels
+            }
+            if (!victim || missingLevels(entry) < missingLevels(victim)) {
+                victim = entry;
+            }
+        }
+        if (!victim) {
+            break; // Only coarse levels left: the budget is too small for them
+        }
+        const int baseLevel = victim->texture->getBaseLevel();
+        residentBytes -= getLevelBytes(*victim, baseLevel);
+        victim->texture->dropLevelsBelow(baseLevel + 1);
+        stats.levelsDropped++;
+    }
+
+    // 3. Stream in the next finer level of the textures missing the most, while it fits
+    std::sort(managed.begin(), managed.end(), [&](const Entry* a, const Entry* b) { return missingLevels(a) > missingLevels(b); });
+    int started = 0;
+    for (Entry* entry : managed)
+    {
+        if (started == MAX_LEVELS_PER_UPDATE || missingLevels(entry) <= 0) {
+            break; // Sorted: no later entry is missing a level either
+        }
+        if (entry->streamingBytes > 0) {
+            continue; // One level at a time per texture
+        }
+        const size_t bytes = getLevelBytes(*entry, entry->texture->getBaseLevel() - 1);
+        if (residentBytes + bytes > budgetBytes) {
+            continue; // A smaller level of another texture may still fit
+        }
+        if (streamInLevel(*entry))
+        {
+            residentBytes += bytes;
+            started++;
+        }
+    }
+    stats.residentBytes = residentBytes;
+}
+
+// Utility function for reporting errors
+void MipResidency::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::MIPRESIDENCY::" << message << std::endl;
+}
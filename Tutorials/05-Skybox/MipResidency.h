@@ -0,0 +1,130 @@
+#ifndef MIPRESIDENCY_H
+#define MIPRESIDENCY_H
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Camera.h"
+#include "Image.h"
+
+class Texture;
+class TextureStreamer;
+
+// Keeps only the mip levels each texture needs on screen resident on the GPU.
+//
+// A texture added here is uploaded with only its coarse levels (those no larger than
+// residentSize texels), with GL_TEXTURE_BASE_LEVEL clamped to the finest of them, while
+// the full CPU mip chain is kept as the source for streaming. Once per frame, update()
+// estimates the finest level each texture can show from the projected screen size of its
+// usages (see addUsage): a surface covering N pixels needs about log2(textureSize / N)
+// levels less than the full resolution. Finer levels are then streamed in one at a time
+// (through the TextureStreamer if one is given) while the resident bytes stay under the
+// budget, and levels no longer needed are dropped by raising the base level.
+// When the budget is short, the textures closest to their required level give up a level first.
+//
+// All methods must be called on the GL thread. Textures must stay alive while added.
+class MipResidency
+{
+public:
+    // Residency metrics
+    struct Stats
+    {
+        size_t residentBytes = 0;       // GPU bytes of the resident levels (including levels streaming in)
+        size_t requiredBytes = 0;       // GPU bytes if every texture had its required levels
+        unsigned int levelsStreamedIn = 0;
+        unsigned int levelsDropped = 0;
+    };
+
+    // Constructor: Stores the GPU budget for the managed textures, the streamer used for the
+    // finer levels (nullptr uploads them directly) and the size of the levels always resident.
+    explicit MipResidency(size_t budgetBytes = 64u << 20, TextureStreamer* streamer = nullptr, int residentSize = 64);
+
+    // Destructor: Finishes the levels still streaming (their callbacks refer to this object)
+    ~MipResidency();
+
+    // Prevent copying (streaming callbacks refer to this object)
+    MipResidency(const MipResidency&) = delete;
+    MipResidency& operator=(const MipResidency&) = delete;
+
+    // Upload the coarse levels of a decoded image and manage the rest.
+    // mipLevels are levels 1..N (e.g. from MipGenerator::generate); they are kept on the CPU.
+    // Returns true on success, false on failure (errors will be printed to cerr).
+    bool add(Texture* texture, Image image, std::vector<Image> mipLevels);
+
+    // Stop managing a texture (e.g. before destroying it). Its resident levels stay as they are.
+    void remove(Texture* texture);
+
+    // Record a surface textured by the texture: its world-space center and size (the extent
+    // the texture is mapped over). Usages can be added before the texture itself.
+    void addUsage(Texture* texture, const glm::vec3& center, float worldSize);
+
+    // Forget every usage of a texture (it then only needs its coarse levels)
+    void clearUsages(Texture* texture);
+
+    // Estimate the required levels from the camera and projection, then stream levels in
+    // or drop them under the budget. Call once per frame, before drawing.
+    void update(const Camera& camera, const glm::mat4& projection, int viewportHeight);
+
+    // Get the finest level update() last estimated for a texture (-1 if it is not managed)
+    int getRequiredLevel(const Texture* texture) const;
+
+    // Set the GPU budget (takes effect at the next update())
+    void setBudget(size_t budgetBytes) { this->budgetBytes = budgetBytes; }
+    size_t getBudget() const { return budgetBytes; }
+
+    // Number of managed textures
+    size_t getTextureCount() const { return entries.size(); }
+
+    // Get the residency metrics (as of the last update())
+    const Stats& getStats() const { return stats; }
+
+private:
+    // The CPU copy of a chain: the source of every level streamed in
+    struct MipChain
+    {
+        Image image;
+        std::vector<Image> mipLevels;
+
+        const Image& getLevel(int level) const { return level == 0 ? image : mipLevels[level - 1]; }
+    };
+
+    struct Usage
+    {
+        glm::vec3 center;
+        float worldSize;
+    };
+
+    struct Entry
+    {
+        Texture* texture = nullptr;
+        std::shared_ptr<const MipChain> chain; // Shared with the streamer while a level is in flight
+        int residentLevel = 0;                 // Finest level uploaded by add(), never dropped
+        int requiredLevel = 0;                 // Finest level needed on screen
+        size_t streamingBytes = 0;             // Bytes of the level in flight (0 if none)
+    };
+
+    size_t budgetBytes;
+    TextureStreamer* streamer;
+    int residentSize;
+    std::unordered_map<const Texture*, Entry> entries;
+    std::unordered_map<const Texture*, std::vector<Usage>> usages; // Kept apart: usages can precede add()
+    Stats stats;
+
+    // Finest level the usages of a texture need (pixelScale converts size / distance to pixels)
+    int estimateRequiredLevel(const Entry& entry, const glm::vec3& cameraPosition, float pixelScale) const;
+
+    // Start making the next finer level of an entry resident
+    bool streamInLevel(Entry& entry);
+
+    // Bytes of one level of an entry's chain
+    static size_t getLevelBytes(const Entry& entry, int level);
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // MIPRESIDENCY_H
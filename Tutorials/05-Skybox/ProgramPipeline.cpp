@@ -0,0 +1,111 @@
+#include "ProgramPipeline.h"
+#include "RenderState.h"
+#include "ShaderStage.h"
+
+#include <algorithm> // For std::max
+#include <vector>
+
+// Destructor: Deletes the pipeline object
+ProgramPipeline::~ProgramPipeline()
+{
+    if (ID != 0)
+    {
+        RenderState::onProgramPipelineDeleted(ID);
+        glDeleteProgramPipelines(1, &ID);
+    }
+}
+
+// Move constructor
+ProgramPipeline::ProgramPipeline(ProgramPipeline&& other) noexcept
+: ID(other.ID), attachedVertex(other.attachedVertex), attachedFragment(other.attachedFragment), stats(other.stats)
+{
+    other.ID = 0;
+    other.attachedVertex = 0;
+    other.attachedFragment = 0;
+}
+
+// Move assignment operator
+ProgramPipeline& ProgramPipeline::operator=(ProgramPipeline&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (ID != 0)
+        {
+            RenderState::onProgramPipelineDeleted(ID);
+            glDeleteProgramPipelines(1, &ID);
+        }
+        ID = other.ID;
+        attachedVertex = other.attachedVertex;
+        attachedFragment = other.attachedFragment;
+        stats = other.stats;
+        other.ID = 0;
+        other.attachedVertex = 0;
+        other.attachedFragment = 0;
+    }
+    return *this;
+}
+
+// Create the pipeline object
+bool ProgramPipeline::setup()
+{
+    if (ID != 0) {
+        return true;
+    }
+    glGenProgramPipelines(1, &ID);
+    if (ID == 0)
+    {
+        logError("SETUP::Failed to generate program pipeline.");
+        return false;
+    }
+    return true;
+}
+
+// Attach the stages (only those not already attached) and bind the pipeline
+void ProgramPipeline::bind(const ShaderStage& vertex, const ShaderStage& fragment)
+{
+    if (ID == 0)
+    {
+        logError("BIND::Attempted to bind a pipeline that was not set up.");
+        return;
+    }
+    useStage(vertex, attachedVertex);
+    useStage(fragment, attachedFragment);
+    RenderState::bindProgramPipeline(ID);
+}
+
+// Attach one stage unless it is already attached
+void ProgramPipeline::useStage(const ShaderStage& stage, GLuint& attached)
+{
+    if (attached == stage.getID())
+    {
+        stats.stageSkips++;
+        return;
+    }
+    glUseProgramStages(ID, stage.getStageBit(), stage.getID());
+    attached = stage.getID();
+    stats.stageSwaps++;
+}
+
+// Check that the attached stages work together
+bool ProgramPipeline::validate() const
+{
+    glValidateProgramPipeline(ID);
+    GLint valid = GL_FALSE;
+    glGetProgramPipelineiv(ID, GL_VALIDATE_STATUS, &valid);
+    if (valid == GL_TRUE) {
+        return true;
+    }
+
+    GLint logLength = 0;
+    glGetProgramPipelineiv(ID, GL_INFO_LOG_LENGTH, &logLength);
+    std::vector<GLchar> infoLog(std::max(logLength, 1), '\0');
+    glGetProgramPipelineInfoLog(ID, static_cast<GLsizei>(infoLog.size()), NULL, infoLog.data());
+    logError("VALIDATION_FAILED\n" + std::string(infoLog.data()));
+    return false;
+}
+
+// Utility function for reporting errors
+void ProgramPipeline::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::PROGRAMPIPELINE::" << message << std::endl;
+}
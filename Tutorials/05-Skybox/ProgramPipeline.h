@@ -0,0 +1,79 @@
+#ifndef PROGRAMPIPELINE_H
+#define PROGRAMPIPELINE_H
+
+#include <glad/gl.h>
+
+#include <string>
+#include <iostream>
+
+class ShaderStage;
+
+// A program pipeline object that combines separately compiled ShaderStages when drawing.
+//
+// One pipeline is shared by every draw that uses stages: bind() attaches the requested
+// vertex and fragment stages with glUseProgramStages, but only for a stage that differs
+// from the one already attached, so consecutive draws that change only the fragment stage
+// (or nothing) cost one call (or none). The pipeline itself is bound through RenderState.
+class ProgramPipeline
+{
+public:
+    // Stage swap metrics since setup()
+    struct Stats
+    {
+        unsigned int stageSwaps = 0; // glUseProgramStages calls issued
+        unsigned int stageSkips = 0; // Stages that were already attached
+    };
+
+    // Constructor: Does NOT create the pipeline object
+    ProgramPipeline() = default;
+
+    // Destructor: Deletes the pipeline object
+    ~ProgramPipeline();
+
+    // Prevent copying (owns an OpenGL object)
+    ProgramPipeline(const ProgramPipeline&) = delete;
+    ProgramPipeline& operator=(const ProgramPipeline&) = delete;
+
+    // Allow moving (transfer ownership of the OpenGL ID)
+    ProgramPipeline(ProgramPipeline&& other) noexcept;
+    ProgramPipeline& operator=(ProgramPipeline&& other) noexcept;
+
+    // Create the pipeline object.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure.
+    bool setup();
+
+    // Attach the stages (only those not already attached) and bind the pipeline.
+    // The stages must be loaded and stay alive while attached.
+    void bind(const ShaderStage& vertex, const ShaderStage& fragment);
+
+    // Check that the attached stages work together (matching interfaces).
+    // Call after bind(); returns false and prints the driver's log if they do not.
+    bool validate() const;
+
+    // Get the stage swap metrics
+    const Stats& getStats() const { return stats; }
+
+    // Get the pipeline ID
+    GLuint getID() const { return ID; }
+
+    // Check if the pipeline was set up successfully
+    bool isValid() const { return ID != 0; }
+
+private:
+    GLuint ID = 0;
+
+    // Programs currently attached to each stage (0 = none)
+    GLuint attachedVertex = 0;
+    GLuint attachedFragment = 0;
+
+    Stats stats;
+
+    // Attach one stage unless it is already attached
+    void useStage(const ShaderStage& stage, GLuint& attached);
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // PROGRAMPIPELINE_H
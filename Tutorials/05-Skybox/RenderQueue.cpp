@@ -0,0 +1,187 @@
+#include "RenderQueue.h"
+
+#include <algorithm> // For std::clamp, std::min
+#include <iostream>
+
+#include "Mesh.h"
+
+// Set the view-space depth range used to quantize draw depth
+void RenderQueue::setDepthRange(float nearPlane, float farPlane)
+{
+    this->nearPlane = nearPlane;
+    this->farPlane = farPlane;
+}
+
+// Start a new frame: clears the queued draws, keeps the allocated storage
+void RenderQueue::begin(const glm::mat4& view)
+{
+    this->view = view;
+    items.clear();
+    transforms.clear();
+    entries.clear();
+}
+
+// Queue a single draw of a mesh
+void RenderQueue::push(Mesh* mesh, const glm::mat4& model, RenderPass pass, uint32_t layer)
+{
+    if (!mesh || !mesh->isValid()) {
+        std::cerr << "WARNING::RENDERQUEUE::PUSH::INVALID_MESH" << std::endl;
+        return;
+    }
+
+    transforms.push_back(model);
+    DrawItem item = { mesh, nullptr, static_cast<uint32_t>(transforms.size() - 1), 1, nullptr, layer };
+    pushItem(item, std::span<const glm::mat4>(&model, 1), pass);
+}
+
+// Queue an instanced draw of a mesh (the matrices and layers are referenced, not copied)
+void RenderQueue::pushInstanced(Mesh* mesh, std::span<const glm::mat4> models, RenderPass pass, std::span<const uint32_t> layers)
+{
+    if (!mesh || !mesh->isValid()) {
+        std::cerr << "WARNING::RENDERQUEUE::PUSHINSTANCED::INVALID_MESH" << std::endl;
+        return;
+    }
+    if (models.empty()) {
+        return; // Nothing to draw
+    }
+
+    if (!layers.empty() && layers.size() != models.size()) {
+        std::cerr << "WARNING::RENDERQUEUE::PUSHINSTANCED::LAYER_COUNT_MISMATCH" << std::endl;
+        return;
+    }
+
+    DrawItem item = { mesh, models.data(), 0, static_cast<uint32_t>(models.size()), layers.empty() ? nullptr : layers.data(), 0 };
+    pushItem(item, models, pass);
+}
+
+// Queue an item with a key computed from the mesh state and the view depth of its nearest instance
+void RenderQueue::pushItem(const DrawItem& item, std::span<const glm::mat4> models, RenderPass pass)
+{
+    float depth = 1.0f;
+    for (const glm::mat4& model : models)
+    {
+        depth = std::min(depth, viewDepth(model));
+    }
+
+    uint64_t key = makeSortKey(pass, getProgramIndex(item.mesh->getProgramKey()), item.mesh->getTextureSetKey(), item.mesh->getVAO(), depth);
+
+    entries.push_back({ key, static_cast<uint32_t>(items.size()) });
+    items.push_back(item);
+}
+
+// Get the sort index of a program key, assigning the next one on first use
+uint16_t RenderQueue::getProgramIndex(uint64_t programKey)
+{
+    if (programKey == 0) {
+        return 0; // No program
+    }
+    auto found = programIndices.find(programKey);
+    if (found != programIndices.end()) {
+        return found->second;
+    }
+    if (programIndices.size() + 1 >= MAX_PROGRAM_INDICES)
+    {
+        // Out of sort bits: the remaining programs share the last bucket (still drawn correctly)
+        if (!programIndicesFullReported) {
+            std::cerr << "WARNING::RENDERQUEUE::TOO_MANY_PROGRAMS (" << MAX_PROGRAM_INDICES << "), later ones share a sort bucket" << std::endl;
+            programIndicesFullReported = true;
+        }
+        return MAX_PROGRAM_INDICES;
+    }
+    // Indices start at 1 in first-seen order (0 is kept for meshes without a program)
+    uint16_t index = static_cast<uint16_t>(programIndices.size() + 1);
+    programIndices.emplace(programKey, index);
+    return index;
+}
+
+// Normalized [0, 1] view depth of a model matrix's origin
+float RenderQueue::viewDepth(const glm::mat4& model) const
+{
+    // The camera looks down -Z in view space
+    float distance = -(view * model[3]).z;
+    return std::clamp((distance - nearPlane) / (farPlane - nearPlane), 0.0f, 1.0f);
+}
+
+// Build a sort key
+uint64_t RenderQueue::makeSortKey(RenderPass pass, uint16_t programIndex, uint16_t textureSet, GLuint vao, float depth)
+{
+    const uint64_t passBits = static_cast<uint64_t>(pass) & 0x3u;
+    const uint64_t shaderBits = programIndex & 0xFFFu;
+    const uint64_t textureBits = textureSet;
+    const uint64_t vaoBits = vao & 0x3FFu;
+    const uint64_t depthBits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF) & 0xFFFFFFu;
+
+    if (pass == RenderPass::TRANSPARENT)
+    {
+        // Back-to-front first (blending needs it), state second
+        return (passBits << 62) | ((0xFFFFFFu - depthBits) << 38) | (shaderBits << 26) | (textureBits << 10) | vaoBits;
+    }
+
+    // State first to minimize switches, front-to-back within the same state for early-Z
+    return (passBits << 62) | (shaderBits << 50) | (textureBits << 34) | (vaoBits << 24) | depthBits;
+}
+
+// LSD radix sort of entries by key, 8 bits per pass
+void RenderQueue::radixSort()
+{
+    const size_t count = entries.size();
+    scratch.resize(count);
+
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const SortEntry& entry : entries)
+        {
+            histogram[(entry.key >> shift) & 0xFF]++;
+        }
+
+        // Every key has the same byte here: this pass would not move anything
+        if (histogram[(entries[0].key >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        // Exclusive prefix sum gives each bucket's start offset
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        // Stable scatter into the scratch buffer
+        for (const SortEntry& entry : entries)
+        {
+            scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+// Sort the queued draws once and submit them in key order
+void RenderQueue::submit()
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    radixSort();
+
+    for (const SortEntry& entry : entries)
+    {
+        const DrawItem& item = items[entry.item];
+        if (item.instances)
+        {
+            std::span<const uint32_t> layers;
+            if (item.layers) {
+                layers = std::span<const uint32_t>(item.layers, item.instanceCount);
+            }
+            item.mesh->drawInstanced(std::span<const glm::mat4>(item.instances, item.instanceCount), layers);
+        }
+        else
+        {
+            item.mesh->draw(transforms[item.transformIndex], item.layer);
+        }
+    }
+}
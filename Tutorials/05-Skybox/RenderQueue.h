@@ -0,0 +1,110 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+
+// Render passes, submitted in this order
+enum class RenderPass : uint8_t
+{
+    OPAQUE = 0,      // Sorted by state, then front-to-back (early-Z)
+    TRANSPARENT = 1  // Sorted back-to-front, then by state
+};
+
+// Collects the draws of a frame, sorts them by a 64-bit key and submits them in order.
+// Replaces immediate Mesh::draw calls: instead of drawing in loop order, callers push
+// draw items and the queue orders them to minimize program/texture/VAO switches
+// (which RenderState then skips) and to draw opaque geometry front-to-back.
+//
+// Sort key layout (most significant bits first):
+//   OPAQUE:      pass:2 | program:12 | textureSet:16 | vao:10 | depth:24
+//   TRANSPARENT: pass:2 | ~depth:24 | program:12 | textureSet:16 | vao:10
+// program is a small index the queue assigns to each program or stage pair the first time it
+// is queued (see Mesh::getProgramKey), so distinct programs never share a sort bucket.
+class RenderQueue
+{
+public:
+    RenderQueue() = default;
+
+    // Set the view-space depth range used to quantize draw depth (usually the camera near/far planes).
+    void setDepthRange(float nearPlane, float farPlane);
+
+    // Start a new frame: clears the queued draws, keeps the allocated storage.
+    // The view matrix is only used to compute draw depth; shaders read it from FrameUniforms.
+    void begin(const glm::mat4& view);
+
+    // Queue a single draw of a mesh. layer selects the layer of the mesh's texture array, if any.
+    void push(Mesh* mesh, const glm::mat4& model, RenderPass pass = RenderPass::OPAQUE, uint32_t layer = 0);
+
+    // Queue an instanced draw of a mesh, with optional per-instance texture array layers.
+    // The model matrices and layers are NOT copied: they must stay alive until submit() returns.
+    void pushInstanced(Mesh* mesh, std::span<const glm::mat4> models, RenderPass pass = RenderPass::OPAQUE,
+                       std::span<const uint32_t> layers = {});
+
+    // Sort the queued draws once and submit them in key order.
+    void submit();
+
+    // Number of draws queued this frame
+    size_t size() const { return items.size(); }
+
+    // Build a sort key. programIndex comes from getProgramIndex(); depth is the normalized view depth in [0, 1].
+    static uint64_t makeSortKey(RenderPass pass, uint16_t programIndex, uint16_t textureSet, GLuint vao, float depth);
+
+    // Number of distinct programs (or stage pairs) the sort key can tell apart
+    static constexpr uint16_t MAX_PROGRAM_INDICES = 0xFFF;
+
+private:
+    // A queued draw. Either a single draw (model in transforms[transformIndex])
+    // or an instanced draw (instances points at externally owned matrices).
+    struct DrawItem
+    {
+        Mesh* mesh;
+        const glm::mat4* instances; // nullptr for single draws
+        uint32_t transformIndex;    // Index into transforms for single draws
+        uint32_t instanceCount;
+        const uint32_t* layers;     // Per-instance texture array layers, or nullptr
+        uint32_t layer;             // Texture array layer of single draws
+    };
+
+    // What the radix sort moves around: the key and the index of its item
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    glm::mat4 view = glm::mat4(1.0f);
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+
+    std::vector<DrawItem> items;
+    std::vector<glm::mat4> transforms; // Model matrices of single draws
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;    // Ping-pong buffer for the radix sort
+
+    // Sort index of each program key seen so far, kept across frames so indices stay stable
+    std::unordered_map<uint64_t, uint16_t> programIndices;
+    bool programIndicesFullReported = false;
+
+    // Get the sort index of a program key, assigning the next one on first use
+    // (keys beyond MAX_PROGRAM_INDICES share the last index)
+    uint16_t getProgramIndex(uint64_t programKey);
+
+    // Queue an item with a key computed from the mesh state and the view depth of its nearest instance
+    void pushItem(const DrawItem& item, std::span<const glm::mat4> models, RenderPass pass);
+
+    // Normalized [0, 1] view depth of a model matrix's origin
+    float viewDepth(const glm::mat4& model) const;
+
+    // LSD radix sort of entries by key, 8 bits per pass, skipping passes where all keys share the byte
+    void radixSort();
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,168 @@
+#include "RenderState.h"
+
+// Define and initialize the static cached state (everything unknown until first set)
+GLuint RenderState::currentProgram = RenderState::UNKNOWN;
+GLuint RenderState::currentProgramPipeline = RenderState::UNKNOWN;
+GLuint RenderState::currentVertexArray = RenderState::UNKNOWN;
+GLuint RenderState::activeTextureUnit = RenderState::UNKNOWN;
+GLenum RenderState::currentDepthFunc = RenderState::UNKNOWN;
+std::array<std::array<GLuint, RenderState::TARGET_COUNT>, RenderState::MAX_TEXTURE_UNITS> RenderState::boundTextures = [] {
+    std::array<std::array<GLuint, TARGET_COUNT>, MAX_TEXTURE_UNITS> textures;
+    for (auto& unit : textures) unit.fill(UNKNOWN);
+    return textures;
+}();
+RenderState::Counters RenderState::frameCounters;
+
+// Reset the per-frame counters
+void RenderState::beginFrame()
+{
+    frameCounters = Counters();
+}
+
+// glUseProgram, skipped if the program is already current
+void RenderState::useProgram(GLuint program)
+{
+    if (currentProgram == program)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glUseProgram(program);
+    currentProgram = program;
+    frameCounters.issued++;
+}
+
+// glBindProgramPipeline, skipped if the pipeline is already bound
+void RenderState::bindProgramPipeline(GLuint pipeline)
+{
+    useProgram(0); // Otherwise the current program is used instead of the pipeline
+    if (currentProgramPipeline == pipeline)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glBindProgramPipeline(pipeline);
+    currentProgramPipeline = pipeline;
+    frameCounters.issued++;
+}
+
+// Select the active texture unit, skipped if already active
+void RenderState::activeTexture(GLuint unit)
+{
+    if (activeTextureUnit == unit)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeTextureUnit = unit;
+    frameCounters.issued++;
+}
+
+// glActiveTexture + glBindTexture, each skipped if already in that state
+void RenderState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = targetIndex(target);
+    if (unit >= MAX_TEXTURE_UNITS || slot < 0)
+    {
+        // Untracked unit or target: always issue, and forget the active unit we no longer know
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        activeTextureUnit = unit < MAX_TEXTURE_UNITS ? unit : UNKNOWN;
+        frameCounters.issued += 2;
+        return;
+    }
+
+    // Always leave the unit active, even when the binding is skipped: callers follow up with
+    // glTexParameter / glTexImage / glGenerateMipmap, which act on the active unit's texture
+    activeTexture(unit);
+    if (boundTextures[unit][slot] == texture)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glBindTexture(target, texture);
+    boundTextures[unit][slot] = texture;
+    frameCounters.issued++;
+}
+
+// glBindVertexArray, skipped if the VAO is already bound
+void RenderState::bindVertexArray(GLuint vao)
+{
+    if (currentVertexArray == vao)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glBindVertexArray(vao);
+    currentVertexArray = vao;
+    frameCounters.issued++;
+}
+
+// glDepthFunc, skipped if the function is already set
+void RenderState::setDepthFunc(GLenum func)
+{
+    if (currentDepthFunc == func)
+    {
+        frameCounters.skipped++;
+        return;
+    }
+    glDepthFunc(func);
+    currentDepthFunc = func;
+    frameCounters.issued++;
+}
+
+// A deleted current program stays in use until another is bound, but its name may be reused,
+// so treat the cached state as unknown.
+void RenderState::onProgramDeleted(GLuint program)
+{
+    if (currentProgram == program)
+        currentProgram = UNKNOWN;
+}
+
+// Deleting the bound pipeline reverts the binding to 0
+void RenderState::onProgramPipelineDeleted(GLuint pipeline)
+{
+    if (currentProgramPipeline == pipeline)
+        currentProgramPipeline = 0;
+}
+
+// Deleting a bound texture reverts that binding to 0 on every unit
+void RenderState::onTextureDeleted(GLuint texture)
+{
+    for (auto& unit : boundTextures)
+        for (GLuint& bound : unit)
+            if (bound == texture)
+                bound = 0;
+}
+
+// Deleting the bound VAO reverts the binding to 0
+void RenderState::onVertexArrayDeleted(GLuint vao)
+{
+    if (currentVertexArray == vao)
+        currentVertexArray = 0;
+}
+
+// Forget all cached state
+void RenderState::invalidate()
+{
+    currentProgram = UNKNOWN;
+    currentProgramPipeline = UNKNOWN;
+    currentVertexArray = UNKNOWN;
+    activeTextureUnit = UNKNOWN;
+    currentDepthFunc = UNKNOWN;
+    for (auto& unit : boundTextures)
+        unit.fill(UNKNOWN);
+}
+
+// Map a GL texture target to the tracked slot, or -1 if it is not tracked
+int RenderState::targetIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_2D: return TARGET_2D;
+        case GL_TEXTURE_2D_ARRAY: return TARGET_2D_ARRAY;
+        case GL_TEXTURE_CUBE_MAP: return TARGET_CUBE_MAP;
+        default: return -1;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include <glad/gl.h>
+#include <array>
+
+// Central cache of the OpenGL binding state.
+// Every program, texture, VAO and depth-function change should go through this class,
+// so that calls which would not change the current state are skipped instead of reaching the driver.
+// The cache assumes all GL state changes are made through it; call invalidate() after
+// running code that talks to OpenGL directly.
+class RenderState
+{
+public:
+    // Number of issued vs skipped state changes since the last beginFrame()
+    struct Counters
+    {
+        unsigned int issued = 0;
+        unsigned int skipped = 0;
+    };
+
+    // Reset the per-frame counters. Call once at the start of each frame.
+    static void beginFrame();
+
+    // Get the counters accumulated since the last beginFrame().
+    static const Counters& getFrameCounters() { return frameCounters; }
+
+    // glUseProgram, skipped if the program is already current
+    static void useProgram(GLuint program);
+
+    // glBindProgramPipeline, skipped if the pipeline is already bound.
+    // A current program overrides the bound pipeline, so this also makes program 0 current.
+    static void bindProgramPipeline(GLuint pipeline);
+
+    // glActiveTexture + glBindTexture, each skipped if already in that state.
+    // The unit is always left active, so texture edits after this call reach this texture.
+    // Binding texture 0 unbinds the target on that unit.
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    // glBindVertexArray, skipped if the VAO is already bound
+    static void bindVertexArray(GLuint vao);
+
+    // glDepthFunc, skipped if the function is already set
+    static void setDepthFunc(GLenum func);
+
+    // Notify the cache that an object was deleted.
+    // OpenGL reverts bindings of deleted objects to 0, so the cache must do the same.
+    static void onProgramDeleted(GLuint program);
+    static void onProgramPipelineDeleted(GLuint pipeline);
+    static void onTextureDeleted(GLuint texture);
+    static void onVertexArrayDeleted(GLuint vao);
+
+    // Forget all cached state; the next call of each kind is always issued.
+    static void invalidate();
+
+private:
+    // Number of texture units tracked by the cache (GL 4.1 guarantees at least 16 per stage)
+    static constexpr GLuint MAX_TEXTURE_UNITS = 16;
+
+    // Texture targets tracked per unit
+    enum TextureTarget
+    {
+        TARGET_2D,
+        TARGET_2D_ARRAY,
+        TARGET_CUBE_MAP,
+        TARGET_COUNT
+    };
+
+    // Sentinel for "unknown" cached state, forces the next call to be issued
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    static GLuint currentProgram;
+    static GLuint currentProgramPipeline;
+    static GLuint currentVertexArray;
+    static GLuint activeTextureUnit;
+    static GLenum currentDepthFunc;
+    static std::array<std::array<GLuint, TARGET_COUNT>, MAX_TEXTURE_UNITS> boundTextures;
+
+    static Counters frameCounters;
+
+    // Map a GL texture target to the tracked slot, or -1 if it is not tracked
+    static int targetIndex(GLenum target);
+
+    // Select the active texture unit, skipped if already active
+    static void activeTexture(GLuint unit);
+
+    // Private constructor to prevent instantiation (it's a static utility class)
+    RenderState() = delete;
+};
+
+#endif // RENDERSTATE_H
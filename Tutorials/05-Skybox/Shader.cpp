@@ -1,4 +1,8 @@
 #include "Shader.h"
+#include "RenderState.h"
+#include "FrameUniforms.h"
+#include "ShaderBinaryCache.h"
+#include "ShaderPreprocessor.h"
 
 // Include necessary headers for file operations and error handling
 #include <iostream>
@@ -20,16 +24,25 @@ Shader::~Shader()
 {
     if (ID != 0) // Only delete if a valid program was created (ID is not 0)
     {
+        RenderState::onProgramDeleted(ID);
         glDeleteProgram(ID);
     }
+    discardPendingLoad();
 }
 
 // Move constructor: Transfers ownership of the OpenGL program ID and file paths.
 Shader::Shader(Shader&& other) noexcept
-    : ID(other.ID), vertexFilePath(std::move(other.vertexFilePath)), fragmentFilePath(std::move(other.fragmentFilePath))
+    : ID(other.ID), vertexFilePath(std::move(other.vertexFilePath)), fragmentFilePath(std::move(other.fragmentFilePath)),
+      defines(std::move(other.defines)), vertexSourceFiles(std::move(other.vertexSourceFiles)),
+      fragmentSourceFiles(std::move(other.fragmentSourceFiles)),
+      binaryCache(other.binaryCache), pendingVertex(other.pendingVertex), pendingFragment(other.pendingFragment),
+      pendingBinaryKey(other.pendingBinaryKey), loadStart(other.loadStart), compileTimeMs(other.compileTimeMs),
+      loadedFromBinary(other.loadedFromBinary), uniforms(std::move(other.uniforms))
 {
     // Set the other object's ID to 0 so its destructor doesn't delete the transferred program.
     other.ID = 0;
+    other.pendingVertex = 0;
+    other.pendingFragment = 0;
 }
 
 // Move assignment operator: Transfers ownership and cleans up the current program if it exists.
@@ -39,49 +52,36 @@ Shader& Shader::operator=(Shader&& other) noexcept
     {
         if (ID != 0) // Delete the current program if this object holds one
         {
+            RenderState::onProgramDeleted(ID);
             glDeleteProgram(ID);
         }
+        discardPendingLoad();
 
         // Transfer ownership of the program ID and file paths
         ID = other.ID;
         vertexFilePath = std::move(other.vertexFilePath);
         fragmentFilePath = std::move(other.fragmentFilePath);
+        defines = std::move(other.defines);
+        vertexSourceFiles = std::move(other.vertexSourceFiles);
+        fragmentSourceFiles = std::move(other.fragmentSourceFiles);
+        binaryCache = other.binaryCache;
+        pendingVertex = other.pendingVertex;
+        pendingFragment = other.pendingFragment;
+        pendingBinaryKey = other.pendingBinaryKey;
+        loadStart = other.loadStart;
+        compileTimeMs = other.compileTimeMs;
+        loadedFromBinary = other.loadedFromBinary;
+        uniforms = std::move(other.uniforms);
 
         // Set the other object's ID to 0
         other.ID = 0;
+        other.pendingVertex = 0;
+        other.pendingFragment = 0;
     }
     return *this; // Return reference to this object
 }
 
 
-// Helper function to read shader file source code into a string.
-// Returns true on success, false on failure (prints error to cerr).
-bool Shader::readShaderFile(const std::string& filePath, std::string& outCode)
-{
-    std::ifstream shaderFile;
-    // Ensure ifstream objects can throw exceptions on failure
-    shaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        // Open the file
-        shaderFile.open(filePath);
-        // Use stringstream to efficiently read the entire file content
-        std::stringstream shaderStream;
-        shaderStream << shaderFile.rdbuf();
-        // Close the file handler
-        shaderFile.close();
-        // Convert the stream buffer into a string
-        outCode = shaderStream.str();
-        return true; // File read successfully
-    }
-    catch (std::ifstream::failure& e)
-    {
-        // Report error if file reading failed
-        logError("SHADER::FILE_NOT_SUCCESFULLY_READ: " + filePath + " - " + e.what());
-        return false; // Indicate failure
-    }
-}
-
 // Internal logging function for standardized error output
 void Shader::logError(const std::string& message) const
 {
@@ -112,7 +112,13 @@ bool Shader::checkCompileErrors(GLuint shader, ShaderType type)
         if (!success)
         {
             glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            logError("SHADER_COMPILATION_ERROR of type: " + typeString + "\n" + infoLog + "\n -- --------------------------------------------------- -- ");
+            // Messages read "<file index>:<line>", so list the files by index
+            std::string fileList;
+            const std::vector<std::string>& files = type == ShaderType::VERTEX ? vertexSourceFiles : fragmentSourceFiles;
+            for (size_t i = 0; i < files.size(); i++) {
+                fileList += "  " + std::to_string(i) + ": " + files[i] + "\n";
+            }
+            logError("SHADER_COMPILATION_ERROR of type: " + typeString + "\n" + fileList + infoLog + "\n -- --------------------------------------------------- -- ");
         }
     }
     else // Checking Shader Program linking errors
@@ -133,83 +139,162 @@ bool Shader::checkCompileErrors(GLuint shader, ShaderType type)
 // This method performs the actual OpenGL API calls.
 // Returns true on success, false on failure.
 bool Shader::load()
+{
+    // Submitting and immediately finishing blocks on this program alone (see ShaderBatch for many)
+    return beginLoad() && finishLoad();
+}
+
+// Read the sources and submit the compile and link, without querying any status
+bool Shader::beginLoad()
 {
     // Clean up any existing program if load() is called multiple times on the same object
+    discardPendingLoad();
     if (ID != 0)
     {
+        RenderState::onProgramDeleted(ID);
         glDeleteProgram(ID);
         ID = 0; // Reset ID to 0 before attempting to load a new program
     }
+    uniforms.clear();
+    loadedFromBinary = false;
+    compileTimeMs = 0.0;
+    loadStart = std::chrono::steady_clock::now();
 
-    // 1. Retrieve the vertex/fragment source code from stored file paths
+    // 1. Retrieve the vertex/fragment source code from stored file paths,
+    // with includes resolved and the defines inserted
     std::string vertexCode;
     std::string fragmentCode;
 
-    // Read vertex shader file
-    if (!readShaderFile(vertexFilePath, vertexCode))
+    // Preprocess vertex shader file
+    if (!ShaderPreprocessor::process(vertexFilePath, defines, vertexCode, &vertexSourceFiles))
     {
-        // Error already reported by readShaderFile
+        // Error already reported by ShaderPreprocessor
         return false; // Indicate failure
     }
-    // Read fragment shader file
-    if (!readShaderFile(fragmentFilePath, fragmentCode))
+    // Preprocess fragment shader file
+    if (!ShaderPreprocessor::process(fragmentFilePath, defines, fragmentCode, &fragmentSourceFiles))
     {
-        // Error already reported by readShaderFile
+        // Error already reported by ShaderPreprocessor
         return false; // Indicate failure
     }
 
+    // With a binary cache, a program linked from the same sources on the same driver loads directly.
+    // The key hashes the preprocessed sources, so editing an include or changing a define misses.
+    const bool useBinaryCache = binaryCache && binaryCache->isEnabled();
+    if (useBinaryCache)
+    {
+        pendingBinaryKey = binaryCache->makeKey({ vertexCode, fragmentCode });
+        ID = glCreateProgram();
+        if (binaryCache->load(pendingBinaryKey, ID))
+        {
+            setupLinkedProgram();
+            loadedFromBinary = true;
+            compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+            return true; // No compiling or linking needed
+        }
+        // A miss, or a binary the driver rejected: compile from source as usual
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
-    // 2. Compile shaders
-    GLuint vertex, fragment;
+    // 2. Submit both compiles. The status is NOT queried here: asking for it would make the
+    // driver finish this compile before returning, serializing every program behind it.
+    pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+    glCompileShader(pendingVertex);
 
-    // Vertex shader compilation
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    // Check for compilation errors using the utility function
-    if (!checkCompileErrors(vertex, ShaderType::VERTEX)) // Use enum class
-    {
-        glDeleteShader(vertex); // Clean up the shader object on error
-        return false; // Indicate failure
+    pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+    glCompileShader(pendingFragment);
+
+    // 3. Create and Link Shader Program (a failed compile shows up as a failed link)
+    ID = glCreateProgram(); // Create the shader program
+    glAttachShader(ID, pendingVertex); // Attach the vertex shader
+    glAttachShader(ID, pendingFragment); // Attach the fragment shader
+    if (useBinaryCache) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // Keep the binary around for store()
     }
+    glLinkProgram(ID); // Link the program
 
-    // Fragment shader compilation
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    // Check for compilation errors using the utility function
-    if (!checkCompileErrors(fragment, ShaderType::FRAGMENT)) // Use enum class
-    {
-        glDeleteShader(vertex); // Clean up the vertex shader (if successful)
-        glDeleteShader(fragment); // Clean up the fragment shader on error
-        return false; // Indicate failure
+    return true; // Submitted; finishLoad() reports the result
+}
+
+// Wait for the submitted compile and link, report errors, and set the program up
+bool Shader::finishLoad()
+{
+    if (!isLoadPending()) {
+        return ID != 0; // Nothing submitted, or loaded from the binary cache
     }
 
-    // 3. Create and Link Shader Program
-    ID = glCreateProgram(); // Create the shader program
-    glAttachShader(ID, vertex); // Attach the compiled vertex shader
-    glAttachShader(ID, fragment); // Attach the compiled fragment shader
-    glLinkProgram(ID); // Link the program
+    // Check for compilation errors first: the link log of a program with a broken stage is just noise
+    bool compiled = checkCompileErrors(pendingVertex, ShaderType::VERTEX);
+    compiled = checkCompileErrors(pendingFragment, ShaderType::FRAGMENT) && compiled;
+    const bool linked = compiled && checkCompileErrors(ID, ShaderType::PROGRAM);
 
-    // Check for linking errors using the utility function
-    if (!checkCompileErrors(ID, ShaderType::PROGRAM)) // Use enum class
+    // Delete the shader objects as they are now linked into the program and no longer needed
+    glDeleteShader(pendingVertex);
+    glDeleteShader(pendingFragment);
+    pendingVertex = 0;
+    pendingFragment = 0;
+
+    if (!linked)
     {
         glDeleteProgram(ID); // Clean up the program object on error
-        glDeleteShader(vertex); // Clean up the attached shader objects
-        glDeleteShader(fragment);
         ID = 0; // Reset ID to 0 to indicate an invalid program
         return false; // Indicate failure
     }
 
-    // Delete the shader objects as they are now linked into the program and no longer needed
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    // Save the linked program for the next launch
+    if (binaryCache && binaryCache->isEnabled()) {
+        binaryCache->store(pendingBinaryKey, ID);
+    }
 
+    setupLinkedProgram();
+    compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
     return true; // Shader program loaded and linked successfully
 }
 
+// Delete the shader objects of a submitted but unfinished load
+void Shader::discardPendingLoad()
+{
+    if (pendingVertex != 0) {
+        glDeleteShader(pendingVertex);
+    }
+    if (pendingFragment != 0) {
+        glDeleteShader(pendingFragment);
+    }
+    pendingVertex = 0;
+    pendingFragment = 0;
+}
+
+// Set up a freshly linked (or binary-loaded) program
+void Shader::setupLinkedProgram()
+{
+    // 4. Resolve all uniform locations once, so setting uniforms never queries the driver
+    if (!uniforms.build(ID)) {
+        // Two distinct names hashing to the same value would silently alias each other
+        logError("SHADER::UNIFORM_HASH_COLLISION in " + vertexFilePath + " / " + fragmentFilePath);
+    }
+
+    // 5. Connect the shared per-frame uniform block, if the program uses it
+    // (block bindings are not part of a program binary, so this runs for cached programs too)
+    GLuint frameBlockIndex = glGetUniformBlockIndex(ID, FrameUniforms::BLOCK_NAME);
+    if (frameBlockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(ID, frameBlockIndex, FrameUniforms::BINDING_POINT);
+    }
+}
+
+
+// Resolve a uniform location by a name only known at runtime
+GLint Shader::getUniformLocation(std::string_view name) const
+{
+    return uniforms.find(hashName(name));
+}
+
 
 // Activate the shader program for rendering.
 // Only safe to call if isValid() is true (ID != 0).
@@ -217,7 +302,7 @@ void Shader::use() const
 {
     if (ID != 0) // Check if the shader program is valid
     {
-        glUseProgram(ID);
+        RenderState::useProgram(ID); // Skipped if the program is already in use
     }
     else
     {
@@ -226,9 +311,9 @@ void Shader::use() const
 }
 
 // Helper function to print a warning when attempting to set a uniform on an invalid shader.
-void Shader::warnInvalidUniformSet(const std::string& name) const
+void Shader::warnInvalidUniformSet(std::string_view name) const
 {
-    logError("Attempted to set uniform '" + name + "' on an invalid shader program.");
+    logError("Attempted to set uniform '" + std::string(name) + "' on an invalid shader program.");
 }
 
 
@@ -237,17 +322,30 @@ void Shader::warnInvalidUniformSet(const std::string& name) const
 // They are only safe to call if the shader program is valid (ID != 0) and currently in use (glUseProgram(ID)).
 // A basic check for ID != 0 is included for safety.
 
-void Shader::setBool(const std::string& name, bool value) const { if(ID) glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); else { warnInvalidUniformSet(name); } }
-void Shader::setInt(const std::string& name, int value) const { if(ID) glUniform1i(glGetUniformLocation(ID, name.c_str()), value); else { warnInvalidUniformSet(name); } }
-void Shader::setFloat(const std::string& name, float value) const { if(ID) glUniform1f(glGetUniformLocation(ID, name.c_str()), value); else { warnInvalidUniformSet(name); } }
-void Shader::setVec2(const std::string& name, const glm::vec2& value) const { if(ID) glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); else { warnInvalidUniformSet(name); } }
-void Shader::setVec2(const std::string& name, float x, float y) const { if(ID) glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); else { warnInvalidUniformSet(name); } }
-void Shader::setVec3(const std::string& name, const glm::vec3& value) const { if(ID) glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); else { warnInvalidUniformSet(name); } }
-void Shader::setVec3(const std::string& name, float x, float y, float z) const { if(ID) glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); else { warnInvalidUniformSet(name); } }
-void Shader::setVec4(const std::string& name, const glm::vec4& value) const { if(ID) glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); else { warnInvalidUniformSet(name); } }
-void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const { if(ID) glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); else { warnInvalidUniformSet(name); } }
-void Shader::setMat2(const std::string& name, const glm::mat2& mat) const { if(ID) glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(name); } }
-void Shader::setMat3(const std::string& name, const glm::mat3& mat) const { if(ID) glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(name); } }
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const { if(ID) glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(name); } }
-
-
+// Compile-time hashed names: resolved through the location table, no driver lookup.
+void Shader::setBool(UniformName name, bool value) const { if(ID) setBool(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setInt(UniformName name, int value) const { if(ID) setInt(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setFloat(UniformName name, float value) const { if(ID) setFloat(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec2(UniformName name, const glm::vec2& value) const { if(ID) setVec2(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec2(UniformName name, float x, float y) const { if(ID) setVec2(uniforms.find(name.hash), x, y); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec3(UniformName name, const glm::vec3& value) const { if(ID) setVec3(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec3(UniformName name, float x, float y, float z) const { if(ID) setVec3(uniforms.find(name.hash), x, y, z); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec4(UniformName name, const glm::vec4& value) const { if(ID) setVec4(uniforms.find(name.hash), value); else { warnInvalidUniformSet(name.name); } }
+void Shader::setVec4(UniformName name, float x, float y, float z, float w) const { if(ID) setVec4(uniforms.find(name.hash), x, y, z, w); else { warnInvalidUniformSet(name.name); } }
+void Shader::setMat2(UniformName name, const glm::mat2& mat) const { if(ID) setMat2(uniforms.find(name.hash), mat); else { warnInvalidUniformSet(name.name); } }
+void Shader::setMat3(UniformName name, const glm::mat3& mat) const { if(ID) setMat3(uniforms.find(name.hash), mat); else { warnInvalidUniformSet(name.name); } }
+void Shader::setMat4(UniformName name, const glm::mat4& mat) const { if(ID) setMat4(uniforms.find(name.hash), mat); else { warnInvalidUniformSet(name.name); } }
+
+// Pre-resolved locations: go straight to the driver.
+void Shader::setBool(GLint location, bool value) const { if(ID) glUniform1i(location, (int)value); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setInt(GLint location, int value) const { if(ID) glUniform1i(location, value); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setFloat(GLint location, float value) const { if(ID) glUniform1f(location, value); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec2(GLint location, const glm::vec2& value) const { if(ID) glUniform2fv(location, 1, &value[0]); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec2(GLint location, float x, float y) const { if(ID) glUniform2f(location, x, y); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec3(GLint location, const glm::vec3& value) const { if(ID) glUniform3fv(location, 1, &value[0]); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec3(GLint location, float x, float y, float z) const { if(ID) glUniform3f(location, x, y, z); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec4(GLint location, const glm::vec4& value) const { if(ID) glUniform4fv(location, 1, &value[0]); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setVec4(GLint location, float x, float y, float z, float w) const { if(ID) glUniform4f(location, x, y, z, w); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setMat2(GLint location, const glm::mat2& mat) const { if(ID) glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setMat3(GLint location, const glm::mat3& mat) const { if(ID) glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(std::to_string(location)); } }
+void Shader::setMat4(GLint location, const glm::mat4& mat) const { if(ID) glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat)); else { warnInvalidUniformSet(std::to_string(location)); } }
@@ -6,13 +6,45 @@
 #include <glm/gtc/type_ptr.hpp> // For glm::value_ptr to pass matrices to OpenGL
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "UniformTable.h"
+
+class ShaderBinaryCache;
+
 class Shader
 {
 public:
+    // Compile-time FNV-1a hash of a uniform name.
+    // Used as the key of the uniform location table built by load().
+    static constexpr uint32_t hashName(std::string_view name)
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // A uniform name hashed at compile time.
+    // String literals convert implicitly, so setMat4("uModel", m) does no string building,
+    // no hashing and no driver lookup at runtime - only a search of the location table.
+    struct UniformName
+    {
+        uint32_t hash;
+        std::string_view name; // Kept for error messages only
+
+        consteval UniformName(const char* str) : hash(hashName(str)), name(str) {}
+    };
+
     // Constructor stores the file paths but does NOT load or compile the shaders.
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
 
@@ -33,29 +65,83 @@ public:
     // Returns true on success, false on failure.
     bool load(); // Error logging is handled internally
 
+    // load() in two steps, so many programs can compile at once (see ShaderBatch):
+    // beginLoad() reads the sources and submits the compile and link without querying
+    // any status (a status query waits for the driver to finish); finishLoad() then waits,
+    // reports errors and sets the program up. Programs found in the binary cache are
+    // complete after beginLoad(). Each returns true on success, false on failure.
+    bool beginLoad();
+    bool finishLoad();
+
+    // Check if a compile and link was submitted by beginLoad() and not finished yet
+    bool isLoadPending() const { return pendingVertex != 0; }
+
+    // Wall time from beginLoad() until the program was ready, in milliseconds
+    // (programs in a batch compile concurrently, so their times overlap)
+    double getCompileTimeMs() const { return compileTimeMs; }
+
+    // Check if the last load came from the program binary cache
+    bool wasLoadedFromBinary() const { return loadedFromBinary; }
+
+    // Load linked programs from (and store them into) a program binary cache, skipping the
+    // GLSL compiler when the sources and driver are unchanged. nullptr (the default) always compiles.
+    // The cache must outlive the calls to load().
+    void setBinaryCache(ShaderBinaryCache* cache) { binaryCache = cache; }
+
+    // Defines inserted after the #version line of both stages on the next load
+    // (each entry becomes "#define <entry>", e.g. "TEXTURE_ARRAY 1"; see ShaderPreprocessor)
+    void setDefines(const std::vector<std::string>& defines) { this->defines = defines; }
+    const std::vector<std::string>& getDefines() const { return defines; }
+
     // Use/activate the shader
     // Only safe to call if isValid() is true
     void use() const;
 
+    // Resolve a uniform location from the table built by load().
+    // Names that are only known at runtime can be resolved once (e.g. at setup time)
+    // and the returned handle passed to the setters below.
+    // Returns -1 if the program has no active uniform with that name (setting -1 is a no-op in OpenGL).
+    GLint getUniformLocation(std::string_view name) const;
+    GLint getUniformLocation(UniformName name) const { return uniforms.find(name.hash); }
+
     // Utility uniform functions
     // These methods allow setting uniform values from your C++ code
     // Only safe to call if isValid() is true
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
+    // The UniformName overloads take compile-time hashed names (string literals),
+    // the GLint overloads take pre-resolved locations from getUniformLocation().
+    void setBool(UniformName name, bool value) const;
+    void setInt(UniformName name, int value) const;
+    void setFloat(UniformName name, float value) const;
+
+    void setVec2(UniformName name, const glm::vec2& value) const;
+    void setVec2(UniformName name, float x, float y) const;
 
-    void setVec2(const std::string& name, const glm::vec2& value) const;
-    void setVec2(const std::string& name, float x, float y) const;
+    void setVec3(UniformName name, const glm::vec3& value) const;
+    void setVec3(UniformName name, float x, float y, float z) const;
 
-    void setVec3(const std::string& name, const glm::vec3& value) const;
-    void setVec3(const std::string& name, float x, float y, float z) const;
+    void setVec4(UniformName name, const glm::vec4& value) const;
+    void setVec4(UniformName name, float x, float y, float z, float w) const;
 
-    void setVec4(const std::string& name, const glm::vec4& value) const;
-    void setVec4(const std::string& name, float x, float y, float z, float w) const;
+    void setMat2(UniformName name, const glm::mat2& mat) const;
+    void setMat3(UniformName name, const glm::mat3& mat) const;
+    void setMat4(UniformName name, const glm::mat4& mat) const;
 
-    void setMat2(const std::string& name, const glm::mat2& mat) const;
-    void setMat3(const std::string& name, const glm::mat3& mat) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    void setBool(GLint location, bool value) const;
+    void setInt(GLint location, int value) const;
+    void setFloat(GLint location, float value) const;
+
+    void setVec2(GLint location, const glm::vec2& value) const;
+    void setVec2(GLint location, float x, float y) const;
+
+    void setVec3(GLint location, const glm::vec3& value) const;
+    void setVec3(GLint location, float x, float y, float z) const;
+
+    void setVec4(GLint location, const glm::vec4& value) const;
+    void setVec4(GLint location, float x, float y, float z, float w) const;
+
+    void setMat2(GLint location, const glm::mat2& mat) const;
+    void setMat3(GLint location, const glm::mat3& mat) const;
+    void setMat4(GLint location, const glm::mat4& mat) const;
 
     // Get the program ID
     // Check this after calling load() to see if it was successful.
@@ -79,18 +165,41 @@ private:
     std::string vertexFilePath;
     std::string fragmentFilePath;
 
+    // Defines for both stages, and the files each stage was preprocessed from
+    // (compile errors name a file by its index in these lists)
+    std::vector<std::string> defines;
+    std::vector<std::string> vertexSourceFiles;
+    std::vector<std::string> fragmentSourceFiles;
+
+    // Optional program binary cache (not owned)
+    ShaderBinaryCache* binaryCache = nullptr;
+
+    // State of a load between beginLoad() and finishLoad()
+    GLuint pendingVertex = 0;
+    GLuint pendingFragment = 0;
+    uint64_t pendingBinaryKey = 0;
+    std::chrono::steady_clock::time_point loadStart;
+    double compileTimeMs = 0.0;
+    bool loadedFromBinary = false;
+
+    // Uniform locations by name hash, built once in load()
+    UniformTable uniforms;
+
+    // Set up a freshly linked (or binary-loaded) program: uniform table and uniform block binding
+    void setupLinkedProgram();
+
+    // Delete the shader objects of a submitted but unfinished load
+    void discardPendingLoad();
+
     // Utility function for checking shader compilation/linking errors.
     // Reports errors using the internal logging function and returns true on success, false on failure.
     bool checkCompileErrors(GLuint shader, ShaderType type); // Updated signature
 
-    // Helper function to read shader file source
-    bool readShaderFile(const std::string& filePath, std::string& outCode);
-
     // Internal logging function for standardized error output
     void logError(const std::string& message) const;
 
     // Helper function to print a warning when attempting to set a uniform on an invalid shader.
-    void warnInvalidUniformSet(const std::string& name) const;
+    void warnInvalidUniformSet(std::string_view name) const;
 };
 
 #endif
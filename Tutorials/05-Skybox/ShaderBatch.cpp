@@ -0,0 +1,126 @@
+#include "ShaderBatch.h"
+
+#include <chrono>  // For timing the batch
+#include <cstring> // For std::strcmp
+#include <iomanip> // For formatting the report
+#include <thread>  // For yielding while polling
+
+bool ShaderBatch::parallelCompile = false;
+
+// glMaxShaderCompilerThreadsKHR / ARB: the number of driver threads (0xFFFFFFFF = driver's choice)
+typedef void (GLAD_API_PTR *MaxShaderCompilerThreadsFunction)(GLuint count);
+
+// Add a program to the batch
+void ShaderBatch::add(Shader* shader, const std::string& name)
+{
+    Result result;
+    result.shader = shader;
+    result.name = name.empty() ? "program " + std::to_string(results.size()) : name;
+    results.push_back(std::move(result));
+}
+
+// Add a separable stage to the batch
+void ShaderBatch::add(ShaderStage* stage, const std::string& name)
+{
+    Result result;
+    result.stage = stage;
+    result.name = name.empty() ? "stage " + std::to_string(results.size()) : name;
+    results.push_back(std::move(result));
+}
+
+// Submit every program, then wait for all of them
+bool ShaderBatch::compile()
+{
+    auto batchStart = std::chrono::steady_clock::now();
+
+    // 1. Submit everything before asking about anything
+    std::vector<Result*> pending;
+    bool allSucceeded = true;
+    for (Result& result : results)
+    {
+        result.succeeded = visit(result, [](auto& program) { return program.beginLoad(); });
+        if (!result.succeeded) {
+            allSucceeded = false; // Unreadable file (error already printed)
+        } else if (visit(result, [](auto& program) { return program.isLoadPending(); })) {
+            pending.push_back(&result);
+        }
+    }
+
+    // 2. Finish each program once the driver reports it complete. Without the extension
+    // there is no way to ask, so finish in order (each finishLoad waits for its program).
+    while (!pending.empty())
+    {
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            GLint complete = GL_TRUE;
+            if (parallelCompile) {
+                glGetProgramiv(visit(**it, [](auto& program) { return program.getID(); }), GL_COMPLETION_STATUS_KHR, &complete);
+            }
+            if (!complete)
+            {
+                ++it;
+                continue;
+            }
+            (*it)->succeeded = visit(**it, [](auto& program) { return program.finishLoad(); });
+            allSucceeded = allSucceeded && (*it)->succeeded;
+            it = pending.erase(it);
+        }
+        if (!pending.empty()) {
+            std::this_thread::yield(); // The driver's threads are doing the work
+        }
+    }
+
+    for (Result& result : results)
+    {
+        result.fromBinaryCache = visit(result, [](auto& program) { return program.wasLoadedFromBinary(); });
+        result.compileMs = visit(result, [](auto& program) { return program.getCompileTimeMs(); });
+    }
+    totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+    return allSucceeded;
+}
+
+// Print one line per program and the total
+void ShaderBatch::printReport() const
+{
+    std::cout << "Shader batch: " << results.size() << " programs and stages in " << std::fixed << std::setprecision(2) << totalMs
+              << " ms (" << (parallelCompile ? "parallel" : "serial") << " compile)" << std::endl;
+    for (const Result& result : results)
+    {
+        std::cout << "  " << std::left << std::setw(40) << result.name << std::right << std::setw(8) << result.compileMs << " ms"
+                  << (result.fromBinaryCache ? "  (binary cache)" : "") << (result.succeeded ? "" : "  FAILED") << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Let the driver compile on its own threads
+bool ShaderBatch::enableParallelCompile(GLADloadfunc loadFunction, GLuint threadCount)
+{
+    parallelCompile = false;
+    bool hasKHR = false;
+    bool hasARB = false;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (!extension) {
+            continue;
+        }
+        hasKHR = hasKHR || std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0;
+        hasARB = hasARB || std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0;
+    }
+    if (!hasKHR && !hasARB) {
+        return false; // Programs still batch, they just finish in submission order
+    }
+
+    auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(
+        loadFunction(hasKHR ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB"));
+    if (!maxThreads)
+    {
+        std::cerr << "WARNING::SHADERBATCH::PARALLEL_COMPILE_ENTRY_POINT_MISSING" << std::endl;
+        return false;
+    }
+    maxThreads(threadCount);
+    parallelCompile = true;
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef SHADERBATCH_H
+#define SHADERBATCH_H
+
+#include <glad/gl.h>
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "Shader.h"
+#include "ShaderStage.h"
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile are not in the core 4.1 header
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Loads many shader programs at once.
+//
+// Shader::load() queries the compile status right after each compile, which makes the
+// driver finish that program before the next one is even submitted. A batch instead
+// submits every compile and link first (Shader::beginLoad) and only then collects the
+// results (Shader::finishLoad). With KHR_parallel_shader_compile (enabled by
+// enableParallelCompile) the driver compiles on its own threads, and the batch polls
+// GL_COMPLETION_STATUS_KHR so each program is finished as soon as it is ready; without
+// it, drivers that compile lazily still overlap the work between submission and the
+// first status query.
+//
+// Separable ShaderStages load the same way and can share a batch with whole programs.
+class ShaderBatch
+{
+public:
+    // Outcome of one program
+    struct Result
+    {
+        Shader* shader = nullptr;     // Set for a whole program
+        ShaderStage* stage = nullptr; // Set for a separable stage
+        std::string name;             // Shown in the report
+        bool succeeded = false;
+        bool fromBinaryCache = false;
+        double compileMs = 0.0;    // Wall time from submission until ready (overlaps within a batch)
+    };
+
+    // Add a program to the batch (its file paths and binary cache must be set)
+    void add(Shader* shader, const std::string& name = "");
+
+    // Add a separable stage to the batch (its defines and binary cache must be set)
+    void add(ShaderStage* stage, const std::string& name = "");
+
+    // Submit every program, then wait for all of them.
+    // Must be called on the GL thread. Returns true if every program linked;
+    // errors are printed per program, and the other programs still load.
+    bool compile();
+
+    // Per-program results of the last compile(), in the order added
+    const std::vector<Result>& getResults() const { return results; }
+
+    // Wall time of the last compile() in milliseconds
+    double getTotalMs() const { return totalMs; }
+
+    // Print one line per program and the total
+    void printReport() const;
+
+    // Let the driver compile on its own threads if it supports KHR_parallel_shader_compile
+    // (or the ARB version). loadFunction resolves the entry point, e.g. glfwGetProcAddress.
+    // Must be called on the GL thread after the context is current. Returns true if enabled.
+    static bool enableParallelCompile(GLADloadfunc loadFunction, GLuint threadCount = 0xFFFFFFFFu);
+
+    // Check if parallel compilation was enabled
+    static bool isParallelCompileEnabled() { return parallelCompile; }
+
+private:
+    std::vector<Result> results;
+
+    // Call f with the Shader or the ShaderStage of a result (both have the same load interface)
+    template <typename Function>
+    static auto visit(const Result& result, Function f) { return result.shader ? f(*result.shader) : f(*result.stage); }
+    double totalMs = 0.0;
+
+    static bool parallelCompile;
+};
+
+#endif // SHADERBATCH_H
@@ -0,0 +1,205 @@
+#include "ShaderBinaryCache.h"
+
+#include <cstdio>     // For std::snprintf
+#include <cstring>    // For std::memcmp
+#include <filesystem> // For the cache directory
+#include <fstream>    // For reading and writing entries
+#include <vector>
+
+// Bump when the entry layout changes, so old files are ignored instead of misread
+static constexpr uint32_t ENTRY_VERSION = 1;
+static constexpr char ENTRY_MAGIC[4] = { 'G', 'L', 'P', 'B' };
+
+// Fixed-size start of every entry file, followed by the driver id and the binary
+struct EntryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t driverIdLength;
+    uint32_t binaryLength;
+};
+
+// 64-bit FNV-1a, continued from hash
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Constructor: Stores the directory
+ShaderBinaryCache::ShaderBinaryCache(const std::string& directory)
+: directory(directory)
+{
+    // Ensure the directory ends with a slash for easier concatenation
+    if (!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\') {
+        this->directory += "/";
+    }
+}
+
+// Read the driver strings and create the directory
+bool ShaderBinaryCache::setup()
+{
+    enabled = false;
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0)
+    {
+        std::cerr << "WARNING::SHADERBINARYCACHE::NO_BINARY_FORMATS (programs will always compile from source)" << std::endl;
+        return false;
+    }
+
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    const GLubyte* version = glGetString(GL_VERSION);
+    driverId = std::string(renderer ? reinterpret_cast<const char*>(renderer) : "") + "|"
+             + std::string(version ? reinterpret_cast<const char*>(version) : "");
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        logError("SETUP::Failed to create " + directory + " - " + error.message());
+        return false;
+    }
+    enabled = true;
+    return true;
+}
+
+// Key of a program
+uint64_t ShaderBinaryCache::makeKey(std::initializer_list<std::string_view> sources) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (std::string_view source : sources)
+    {
+        // The length separates the sources, so moving text from one stage to the next changes the key
+        const uint64_t length = source.size();
+        hash = hashBytes(hash, &length, sizeof(length));
+        hash = hashBytes(hash, source.data(), source.size());
+    }
+    return hashBytes(hash, driverId.data(), driverId.size());
+}
+
+// Path of the file holding a key's binary
+std::string ShaderBinaryCache::getEntryPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + name;
+}
+
+// Load a cached binary into program
+bool ShaderBinaryCache::load(uint64_t key, GLuint program)
+{
+    if (!enabled) {
+        return false;
+    }
+
+    // 1. Read the entry, checking it belongs to this key and driver
+    std::ifstream file(getEntryPath(key), std::ios::binary);
+    EntryHeader header {};
+    std::string storedDriverId;
+    std::vector<char> binary;
+    bool readable = file && file.read(reinterpret_cast<char*>(&header), sizeof(header))
+                    && std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0
+                    && header.version == ENTRY_VERSION && header.key == key && header.driverIdLength == driverId.size();
+    if (readable)
+    {
+        storedDriverId.resize(header.driverIdLength);
+        binary.resize(header.binaryLength);
+        readable = file.read(storedDriverId.data(), storedDriverId.size()) && file.read(binary.data(), binary.size())
+                   && storedDriverId == driverId && !binary.empty();
+    }
+    if (!readable)
+    {
+        stats.misses++;
+        return false;
+    }
+
+    // 2. Hand it to the driver, which may still refuse it (e.g. after an update that kept the version string)
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        stats.rejected++;
+        stats.misses++;
+        return false;
+    }
+    stats.hits++;
+    return true;
+}
+
+// Write the binary of a linked program
+bool ShaderBinaryCache::store(uint64_t key, GLuint program)
+{
+    if (!enabled) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        logError("STORE::The driver returned no binary for program " + std::to_string(program));
+        return false;
+    }
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+    EntryHeader header {};
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    header.version = ENTRY_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.driverIdLength = static_cast<uint32_t>(driverId.size());
+    header.binaryLength = static_cast<uint32_t>(length);
+
+    // Write to a temporary file first, so a crash never leaves a truncated entry behind
+    const std::string path = getEntryPath(key);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(driverId.data(), driverId.size());
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            logError("STORE::Failed to write " + temporaryPath);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        logError("STORE::Failed to replace " + path + " - " + error.message());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    stats.stored++;
+    return true;
+}
+
+// Delete every cached binary
+void ShaderBinaryCache::clear()
+{
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == ".bin") {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+// Utility function for reporting errors
+void ShaderBinaryCache::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::SHADERBINARYCACHE::" << message << std::endl;
+}
@@ -0,0 +1,78 @@
+#ifndef SHADERBINARYCACHE_H
+#define SHADERBINARYCACHE_H
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <iostream>
+
+// Persistent cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+//
+// A program is keyed by a 64-bit hash of its shader sources plus the GL_RENDERER and
+// GL_VERSION strings, so a driver update or another GPU simply misses instead of loading
+// an incompatible binary. Each program is one file, named after its key, in the cache
+// directory. On the next launch Shader::load() hands the stored binary to the driver and
+// skips compiling and linking; if the driver rejects it (binaries may be invalidated at any
+// time), the shader compiles from source as usual and the entry is rewritten.
+class ShaderBinaryCache
+{
+public:
+    // Cache metrics
+    struct Stats
+    {
+        unsigned int hits = 0;     // Programs loaded from a binary
+        unsigned int misses = 0;   // Programs with no usable binary (compiled from source)
+        unsigned int rejected = 0; // Binaries found but refused by the driver (counted as misses too)
+        unsigned int stored = 0;   // Binaries written
+    };
+
+    // Constructor: Stores the cache directory. Does NOT touch the disk or OpenGL.
+    explicit ShaderBinaryCache(const std::string& directory);
+
+    // Prevent copying (shaders keep a pointer to their cache)
+    ShaderBinaryCache(const ShaderBinaryCache&) = delete;
+    ShaderBinaryCache& operator=(const ShaderBinaryCache&) = delete;
+
+    // Read the renderer and version strings and create the directory.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns false (and leaves the cache disabled) if the driver has no binary formats
+    // or the directory cannot be created.
+    bool setup();
+
+    // Key of a program: hash of its sources (in order) and of the renderer and version
+    uint64_t makeKey(std::initializer_list<std::string_view> sources) const;
+
+    // Load a cached binary into program (a new, empty program object).
+    // Returns true if the program is now linked; false on a miss or if the driver rejected the binary.
+    bool load(uint64_t key, GLuint program);
+
+    // Write the binary of a linked program. The program should have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set. Returns true on success.
+    bool store(uint64_t key, GLuint program);
+
+    // Delete every cached binary (e.g. after changing shaders outside the source hash)
+    void clear();
+
+    // Check if setup() succeeded
+    bool isEnabled() const { return enabled; }
+
+    // Get the cache metrics
+    const Stats& getStats() const { return stats; }
+
+private:
+    std::string directory;
+    std::string driverId; // GL_RENDERER + GL_VERSION, stored in each file and part of every key
+    bool enabled = false;
+    Stats stats;
+
+    // Path of the file holding a key's binary
+    std::string getEntryPath(uint64_t key) const;
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // SHADERBINARYCACHE_H
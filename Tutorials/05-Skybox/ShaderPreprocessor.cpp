@@ -0,0 +1,132 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>  // For std::find
+#include <filesystem> // For resolving include paths
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+// If line is a preprocessor directive named directive, return the text after it (else false)
+static bool matchDirective(std::string_view line, std::string_view directive, std::string_view& rest)
+{
+    size_t position = line.find_first_not_of(" \t");
+    if (position == std::string_view::npos || line[position] != '#') {
+        return false;
+    }
+    position = line.find_first_not_of(" \t", position + 1);
+    if (position == std::string_view::npos || line.substr(position, directive.size()) != directive) {
+        return false;
+    }
+    rest = line.substr(position + directive.size());
+    return rest.empty() || rest.front() == ' ' || rest.front() == '\t' || rest.front() == '"' || rest.front() == '<';
+}
+
+// Preprocess a shader file
+bool ShaderPreprocessor::process(const std::string& filePath, const std::vector<std::string>& defines,
+                                 std::string& outCode, std::vector<std::string>* outFiles)
+{
+    std::vector<std::string> files;
+    outCode.clear();
+    const bool success = appendFile(filePath, defines, outCode, files);
+    if (outFiles) {
+        *outFiles = std::move(files);
+    }
+    return success;
+}
+
+// Append a file to outCode, expanding its includes
+bool ShaderPreprocessor::appendFile(const std::string& filePath, const std::vector<std::string>& defines,
+                                    std::string& outCode, std::vector<std::string>& files)
+{
+    std::string source;
+    if (!readFile(filePath, source)) {
+        return false; // Error already reported by readFile
+    }
+    const std::string fileIndex = std::to_string(files.size());
+    files.push_back(std::filesystem::path(filePath).lexically_normal().string());
+
+    std::string defineBlock;
+    for (const std::string& define : defines) {
+        defineBlock += "#define " + define + "\n";
+    }
+    bool definesPending = !defineBlock.empty();
+    const size_t sectionStart = outCode.size();
+
+    std::istringstream lines(source);
+    std::string line;
+    for (int lineNumber = 1; std::getline(lines, line); lineNumber++)
+    {
+        std::string_view rest;
+        const std::string resumeLine = "#line " + std::to_string(lineNumber + 1) + " " + fileIndex + "\n";
+
+        // Defines go right after #version, which must stay the first directive
+        if (definesPending && matchDirective(line, "version", rest))
+        {
+            outCode += line + "\n" + defineBlock + resumeLine;
+            definesPending = false;
+            continue;
+        }
+        if (!matchDirective(line, "include", rest))
+        {
+            outCode += line + "\n";
+            continue;
+        }
+
+        // #include "name" or #include <name>, relative to this file
+        const size_t open = rest.find_first_of("\"<");
+        const size_t close = open == std::string_view::npos ? open : rest.find_first_of("\">", open + 1);
+        if (close == std::string_view::npos)
+        {
+            logError("MALFORMED_INCLUDE in " + filePath + " line " + std::to_string(lineNumber) + ": " + line);
+            return false;
+        }
+        const std::string includePath = (std::filesystem::path(filePath).parent_path()
+                                         / std::string(rest.substr(open + 1, close - open - 1))).lexically_normal().string();
+        if (std::find(files.begin(), files.end(), includePath) != files.end())
+        {
+            outCode += "\n"; // Already included: keep the line so the numbering holds
+            continue;
+        }
+        outCode += "#line 1 " + std::to_string(files.size()) + "\n";
+        if (!appendFile(includePath, {}, outCode, files)) {
+            logError("INCLUDED_FROM " + filePath + " line " + std::to_string(lineNumber));
+            return false;
+        }
+        outCode += resumeLine;
+    }
+
+    // No #version line: the defines simply go first
+    if (definesPending) {
+        outCode.insert(sectionStart, defineBlock + "#line 1 " + fileIndex + "\n");
+    }
+    return true;
+}
+
+// Read a whole file into outCode
+bool ShaderPreprocessor::readFile(const std::string& filePath, std::string& outCode)
+{
+    std::ifstream shaderFile;
+    // Ensure ifstream objects can throw exceptions on failure
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        shaderFile.open(filePath);
+        // Use stringstream to efficiently read the entire file content
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        outCode = shaderStream.str();
+        return true; // File read successfully
+    }
+    catch (std::ifstream::failure& e)
+    {
+        logError("FILE_NOT_SUCCESFULLY_READ: " + filePath + " - " + e.what());
+        return false;
+    }
+}
+
+// Utility function for reporting errors
+void ShaderPreprocessor::logError(const std::string& message)
+{
+    std::cerr << "ERROR::SHADERPREPROCESSOR::" << message << std::endl;
+}
@@ -0,0 +1,48 @@
+#ifndef SHADERPREPROCESSOR_H
+#define SHADERPREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Turns a shader file into the source handed to glShaderSource.
+//
+// GLSL has no #include, so shared code had to be copied into every file. The preprocessor
+// replaces each line of the form
+//
+//   #include "frame_data.glsl"
+//
+// with the named file, resolved relative to the file that includes it. A file is inserted at
+// most once per source (later includes of it are dropped, as with #pragma once), which also
+// makes include cycles harmless. Included files must not have a #version line.
+//
+// Defines are inserted right after the #version line (which must stay first), one
+// "#define <define>" per entry, so "TEXTURE_ARRAY 1" or "MAX_LIGHTS 4" both work.
+//
+// "#line <line> <file index>" directives keep compiler messages pointing at the right line:
+// an error reported as "2:14" is on line 14 of the file at index 2 of the returned file list
+// (index 0 is the file itself).
+class ShaderPreprocessor
+{
+public:
+    // Preprocess a shader file. outFiles (optional) receives every file read, in source string
+    // order. Returns false if any file cannot be read; errors will be printed to cerr.
+    static bool process(const std::string& filePath, const std::vector<std::string>& defines,
+                        std::string& outCode, std::vector<std::string>* outFiles = nullptr);
+
+private:
+    // Private constructor to prevent instantiation (it's a static utility class)
+    ShaderPreprocessor() = delete;
+
+    // Append a file to outCode, expanding its includes
+    static bool appendFile(const std::string& filePath, const std::vector<std::string>& defines,
+                           std::string& outCode, std::vector<std::string>& files);
+
+    // Read a whole file into outCode
+    static bool readFile(const std::string& filePath, std::string& outCode);
+
+    // Utility function for reporting errors
+    static void logError(const std::string& message);
+};
+
+#endif // SHADERPREPROCESSOR_H
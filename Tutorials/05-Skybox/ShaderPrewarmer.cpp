@@ -0,0 +1,91 @@
+#include "ShaderPrewarmer.h"
+
+#include <chrono>  // For timing the draws
+#include <iomanip> // For formatting the report
+
+// Register a combination
+void ShaderPrewarmer::add(const std::string& name, std::function<void()> draw)
+{
+    Result result;
+    result.name = name;
+    results.push_back(std::move(result));
+    draws.push_back(std::move(draw));
+}
+
+// Draw every combination into an offscreen target and time it
+bool ShaderPrewarmer::prewarm()
+{
+    auto prewarmStart = std::chrono::steady_clock::now();
+
+    // 1. A tiny target with the formats of the window's framebuffer, since some drivers
+    // specialize the generated code on the render target format
+    GLuint renderbuffers[2] = { 0, 0 };
+    glGenRenderbuffers(2, renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, TARGET_SIZE, TARGET_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!complete) {
+        logError("PREWARM::Offscreen framebuffer is incomplete, skipping the prewarm.");
+    }
+    else
+    {
+        GLint viewport[4] = { 0, 0, 0, 0 };
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        // Drain earlier work (uploads, compiles) so it is not billed to the first draw
+        glFinish();
+
+        // 2. Each draw runs to completion before the next starts, so its time is its own
+        for (size_t i = 0; i < draws.size(); i++)
+        {
+            for (double* ms : { &results[i].coldMs, &results[i].warmMs })
+            {
+                auto drawStart = std::chrono::steady_clock::now();
+                draws[i]();
+                glFinish();
+                *ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - drawStart).count();
+            }
+        }
+
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    // 3. Back to the window
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(2, renderbuffers);
+
+    totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - prewarmStart).count();
+    return complete;
+}
+
+// Print one line per combination and the total
+void ShaderPrewarmer::printReport() const
+{
+    std::cout << "Shader prewarm: " << results.size() << " combinations in " << std::fixed << std::setprecision(2)
+              << totalMs << " ms (first draw / second draw)" << std::endl;
+    for (const Result& result : results)
+    {
+        std::cout << "  " << std::left << std::setw(40) << result.name << std::right << std::setw(8) << result.coldMs
+                  << " ms / " << result.warmMs << " ms" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Utility function for reporting errors
+void ShaderPrewarmer::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::SHADERPREWARMER::" << message << std::endl;
+}
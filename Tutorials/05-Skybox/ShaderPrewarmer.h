@@ -0,0 +1,64 @@
+#ifndef SHADERPREWARMER_H
+#define SHADERPREWARMER_H
+
+#include <glad/gl.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Draws every registered program + state combination once, offscreen, before the first frame.
+//
+// Linking a program is not the end of the driver's work: many drivers generate the final GPU
+// code only when the program is first drawn, because it depends on the vertex layout, the
+// render target formats and some fixed-function state. That first draw then stalls whatever
+// frame it happens in. Calling prewarm() at a known point (a loading screen, after all
+// content is set up) moves those stalls there.
+//
+// A combination is registered as a callback that issues the real draw, with the mesh, VAO,
+// shader or pipeline and state used when rendering, so what gets compiled is exactly what
+// the frame will need. prewarm() runs each one into a tiny framebuffer with the window's
+// formats (RGBA8 color, 24-bit depth + stencil) and times it up to glFinish, twice: the first
+// (cold) time includes any deferred compile, the second (warm) time is the steady state.
+class ShaderPrewarmer
+{
+public:
+    // Timing of one combination
+    struct Result
+    {
+        std::string name;
+        double coldMs = 0.0; // First draw, including any deferred compile
+        double warmMs = 0.0; // Second draw, for comparison
+    };
+
+    // Side of the offscreen target in pixels (draws are clipped to it, so they cost almost nothing)
+    static constexpr GLsizei TARGET_SIZE = 4;
+
+    // Register a combination. draw must issue the draw call(s) exactly as a frame would.
+    void add(const std::string& name, std::function<void()> draw);
+
+    // Draw every combination into an offscreen target and time it.
+    // Must be called on the GL thread after everything it draws is set up. Restores the default
+    // framebuffer and the viewport afterwards. Returns false if the target cannot be created.
+    bool prewarm();
+
+    // Per-combination timings of the last prewarm(), in the order added
+    const std::vector<Result>& getResults() const { return results; }
+
+    // Wall time of the last prewarm() in milliseconds
+    double getTotalMs() const { return totalMs; }
+
+    // Print one line per combination and the total
+    void printReport() const;
+
+private:
+    std::vector<std::function<void()>> draws;
+    std::vector<Result> results;
+    double totalMs = 0.0;
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // SHADERPREWARMER_H
@@ -0,0 +1,237 @@
+#include "ShaderStage.h"
+#include "FrameUniforms.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderBinaryCache.h"
+
+// Constructor: Stores the stage and the file path
+ShaderStage::ShaderStage(GLenum type, const std::string& filePath)
+: type(type), filePath(filePath)
+{
+    // No OpenGL calls here. The stage is compiled in load().
+}
+
+// Destructor: Deletes the program
+ShaderStage::~ShaderStage()
+{
+    if (ID != 0) {
+        glDeleteProgram(ID);
+    }
+    if (pendingShader != 0) {
+        glDeleteShader(pendingShader);
+    }
+}
+
+// Move constructor
+ShaderStage::ShaderStage(ShaderStage&& other) noexcept
+: ID(other.ID), type(other.type), filePath(std::move(other.filePath)), defines(std::move(other.defines)),
+  uniforms(std::move(other.uniforms)), binaryCache(other.binaryCache), loadedFromBinary(other.loadedFromBinary),
+  compileTimeMs(other.compileTimeMs), pendingShader(other.pendingShader), pendingBinaryKey(other.pendingBinaryKey),
+  sourceFiles(std::move(other.sourceFiles)), loadStart(other.loadStart)
+{
+    other.ID = 0;
+    other.pendingShader = 0;
+}
+
+// Move assignment operator
+ShaderStage& ShaderStage::operator=(ShaderStage&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (ID != 0) {
+            glDeleteProgram(ID);
+        }
+        if (pendingShader != 0) {
+            glDeleteShader(pendingShader);
+        }
+        ID = other.ID;
+        type = other.type;
+        filePath = std::move(other.filePath);
+        defines = std::move(other.defines);
+        uniforms = std::move(other.uniforms);
+        binaryCache = other.binaryCache;
+        loadedFromBinary = other.loadedFromBinary;
+        compileTimeMs = other.compileTimeMs;
+        pendingShader = other.pendingShader;
+        pendingBinaryKey = other.pendingBinaryKey;
+        sourceFiles = std::move(other.sourceFiles);
+        loadStart = other.loadStart;
+        other.ID = 0;
+        other.pendingShader = 0;
+    }
+    return *this;
+}
+
+// Preprocess, compile and link the stage
+bool ShaderStage::load()
+{
+    return beginLoad() && finishLoad();
+}
+
+// Submit the compile and link without waiting for them
+bool ShaderStage::beginLoad()
+{
+    if (pendingShader != 0)
+    {
+        glDeleteShader(pendingShader);
+        pendingShader = 0;
+    }
+    if (ID != 0)
+    {
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+    uniforms.clear();
+    loadedFromBinary = false;
+    compileTimeMs = 0.0;
+    loadStart = std::chrono::steady_clock::now();
+
+    std::string code;
+    if (!ShaderPreprocessor::process(filePath, defines, code, &sourceFiles)) {
+        return false; // Error already reported by ShaderPreprocessor
+    }
+
+    // The separable flag is applied by the next link or glProgramBinary, so set it first.
+    // The key is tagged with the stage type: a separable stage's binary is not interchangeable
+    // with a whole program built from the same source.
+    const bool useBinaryCache = binaryCache && binaryCache->isEnabled();
+    if (useBinaryCache)
+    {
+        pendingBinaryKey = binaryCache->makeKey({ type == GL_VERTEX_SHADER ? "separable vertex" : "separable fragment", code });
+        ID = glCreateProgram();
+        glProgramParameteri(ID, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        if (binaryCache->load(pendingBinaryKey, ID))
+        {
+            setupLinkedProgram();
+            loadedFromBinary = true;
+            compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+            return true; // No compiling or linking needed
+        }
+        // A miss, or a binary the driver rejected: compile from source as usual
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+
+    // What glCreateShaderProgramv does, but without its status queries, so the driver can
+    // keep compiling while other programs are submitted
+    const char* source = code.c_str();
+    pendingShader = glCreateShader(type);
+    glShaderSource(pendingShader, 1, &source, NULL);
+    glCompileShader(pendingShader);
+
+    ID = glCreateProgram();
+    glProgramParameteri(ID, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    if (useBinaryCache) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // Keep the binary around for store()
+    }
+    glAttachShader(ID, pendingShader);
+    glLinkProgram(ID);
+    return true; // Submitted; finishLoad() reports the result
+}
+
+// Wait for the submitted compile and link, report errors, and set the stage up
+bool ShaderStage::finishLoad()
+{
+    if (!isLoadPending()) {
+        return ID != 0; // Nothing submitted, or loaded from the binary cache
+    }
+
+    GLint compiled = GL_FALSE;
+    GLint linked = GL_FALSE;
+    glGetShaderiv(pendingShader, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_TRUE) {
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    }
+    if (linked != GL_TRUE)
+    {
+        // The compile log explains a broken stage; the link log of such a program is just noise
+        GLchar infoLog[1024] = "";
+        if (compiled != GL_TRUE) {
+            glGetShaderInfoLog(pendingShader, sizeof(infoLog), NULL, infoLog);
+        } else {
+            glGetProgramInfoLog(ID, sizeof(infoLog), NULL, infoLog);
+        }
+        // Messages read "<file index>:<line>", so list the files by index
+        std::string fileList;
+        for (size_t i = 0; i < sourceFiles.size(); i++) {
+            fileList += "  " + std::to_string(i) + ": " + sourceFiles[i] + "\n";
+        }
+        logError(std::string(compiled != GL_TRUE ? "COMPILATION_ERROR" : "LINKING_ERROR") + " of type: "
+                 + std::string(type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") + "\n" + fileList + infoLog
+                 + "\n -- --------------------------------------------------- -- ");
+    }
+
+    // The shader object is linked into the program (or failed) and no longer needed
+    glDetachShader(ID, pendingShader);
+    glDeleteShader(pendingShader);
+    pendingShader = 0;
+
+    if (linked != GL_TRUE)
+    {
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    // Save the linked stage for the next launch
+    if (binaryCache && binaryCache->isEnabled()) {
+        binaryCache->store(pendingBinaryKey, ID);
+    }
+
+    setupLinkedProgram();
+    compileTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    return true;
+}
+
+// Set up a freshly linked (or binary-loaded) stage
+void ShaderStage::setupLinkedProgram()
+{
+    // Resolve all uniform locations once, so setting uniforms never queries the driver
+    if (!uniforms.build(ID)) {
+        logError("UNIFORM_HASH_COLLISION in " + filePath);
+    }
+
+    // Connect the shared per-frame uniform block, if the stage uses it
+    // (block bindings are not part of a program binary, so this runs for cached stages too)
+    GLuint frameBlockIndex = glGetUniformBlockIndex(ID, FrameUniforms::BLOCK_NAME);
+    if (frameBlockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, frameBlockIndex, FrameUniforms::BINDING_POINT);
+    }
+}
+
+// Get the pipeline stage bit
+GLbitfield ShaderStage::getStageBit() const
+{
+    return type == GL_VERTEX_SHADER ? GL_VERTEX_SHADER_BIT : GL_FRAGMENT_SHADER_BIT;
+}
+
+// Resolve a uniform location by a name only known at runtime
+GLint ShaderStage::getUniformLocation(std::string_view name) const
+{
+    return uniforms.find(Shader::hashName(name));
+}
+
+// Utility function for reporting errors
+void ShaderStage::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::SHADERSTAGE::" << message << std::endl;
+}
+
+// Compile-time hashed names: resolved through the location table, no driver lookup.
+void ShaderStage::setBool(Shader::UniformName name, bool value) const { setBool(uniforms.find(name.hash), value); }
+void ShaderStage::setInt(Shader::UniformName name, int value) const { setInt(uniforms.find(name.hash), value); }
+void ShaderStage::setFloat(Shader::UniformName name, float value) const { setFloat(uniforms.find(name.hash), value); }
+void ShaderStage::setVec2(Shader::UniformName name, const glm::vec2& value) const { setVec2(uniforms.find(name.hash), value); }
+void ShaderStage::setVec3(Shader::UniformName name, const glm::vec3& value) const { setVec3(uniforms.find(name.hash), value); }
+void ShaderStage::setVec4(Shader::UniformName name, const glm::vec4& value) const { setVec4(uniforms.find(name.hash), value); }
+void ShaderStage::setMat3(Shader::UniformName name, const glm::mat3& mat) const { setMat3(uniforms.find(name.hash), mat); }
+void ShaderStage::setMat4(Shader::UniformName name, const glm::mat4& mat) const { setMat4(uniforms.find(name.hash), mat); }
+
+// Pre-resolved locations: go straight to the driver, addressed by program (no glUseProgram needed).
+void ShaderStage::setBool(GLint location, bool value) const { glProgramUniform1i(ID, location, (int)value); }
+void ShaderStage::setInt(GLint location, int value) const { glProgramUniform1i(ID, location, value); }
+void ShaderStage::setFloat(GLint location, float value) const { glProgramUniform1f(ID, location, value); }
+void ShaderStage::setVec2(GLint location, const glm::vec2& value) const { glProgramUniform2fv(ID, location, 1, &value[0]); }
+void ShaderStage::setVec3(GLint location, const glm::vec3& value) const { glProgramUniform3fv(ID, location, 1, &value[0]); }
+void ShaderStage::setVec4(GLint location, const glm::vec4& value) const { glProgramUniform4fv(ID, location, 1, &value[0]); }
+void ShaderStage::setMat3(GLint location, const glm::mat3& mat) const { glProgramUniformMatrix3fv(ID, location, 1, GL_FALSE, glm::value_ptr(mat)); }
+void ShaderStage::setMat4(GLint location, const glm::mat4& mat) const { glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, glm::value_ptr(mat)); }
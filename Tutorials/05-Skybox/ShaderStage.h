@@ -0,0 +1,138 @@
+#ifndef SHADERSTAGE_H
+#define SHADERSTAGE_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp> // For glm::value_ptr to pass matrices to OpenGL
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+
+#include "Shader.h" // For Shader::UniformName
+#include "UniformTable.h"
+
+class ShaderBinaryCache;
+
+// One shader stage compiled on its own, as a separable program (GL_PROGRAM_SEPARABLE).
+//
+// A Shader links one vertex and one fragment shader into a single program, so N vertex
+// variants used with M fragment variants need N x M compiles and links. Stages instead are
+// compiled once each (N + M) and combined when drawing by a ProgramPipeline, which swaps
+// only the stage that changed between draws.
+//
+// Uniforms belong to the stage that declares them and are set with glProgramUniform*,
+// so setting them needs no bind. The vertex stage must redeclare the gl_PerVertex output
+// block, and the varyings between stages should use explicit locations.
+//
+// Like Shader, a stage can load in two steps so a ShaderBatch overlaps it with other
+// compiles, and can come from a ShaderBinaryCache.
+class ShaderStage
+{
+public:
+    // Constructor stores the stage (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER) and the file path.
+    // Does NOT compile anything.
+    ShaderStage(GLenum type, const std::string& filePath);
+
+    // Destructor to clean up the program
+    ~ShaderStage();
+
+    // Prevent copying (stages are not copyable)
+    ShaderStage(const ShaderStage&) = delete;
+    ShaderStage& operator=(const ShaderStage&) = delete;
+
+    // Allow moving (transfer ownership)
+    ShaderStage(ShaderStage&& other) noexcept;
+    ShaderStage& operator=(ShaderStage&& other) noexcept;
+
+    // Defines inserted after the #version line on the next load (see ShaderPreprocessor)
+    void setDefines(const std::vector<std::string>& defines) { this->defines = defines; }
+
+    // Preprocess, compile and link the stage.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure (errors will be printed to cerr).
+    bool load();
+
+    // load() in two steps, as in Shader: beginLoad() submits the compile and link without
+    // querying any status, finishLoad() waits and reports errors (see ShaderBatch).
+    bool beginLoad();
+    bool finishLoad();
+
+    // Check if a compile and link was submitted by beginLoad() and not finished yet
+    bool isLoadPending() const { return pendingShader != 0; }
+
+    // Wall time from beginLoad() until the stage was ready, in milliseconds
+    double getCompileTimeMs() const { return compileTimeMs; }
+
+    // Check if the last load came from the binary cache
+    bool wasLoadedFromBinary() const { return loadedFromBinary; }
+
+    // Load and store the linked stage through a binary cache (nullptr = always compile)
+    void setBinaryCache(ShaderBinaryCache* cache) { binaryCache = cache; }
+
+    // Get the program ID (0 until load() succeeds)
+    GLuint getID() const { return ID; }
+
+    // Get the shader type (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)
+    GLenum getType() const { return type; }
+
+    // Get the pipeline stage bit (GL_VERTEX_SHADER_BIT or GL_FRAGMENT_SHADER_BIT)
+    GLbitfield getStageBit() const;
+
+    // Check if the stage was loaded successfully
+    bool isValid() const { return ID != 0; }
+
+    // Resolve a uniform location of this stage, -1 if the stage has no such uniform
+    GLint getUniformLocation(std::string_view name) const;
+    GLint getUniformLocation(Shader::UniformName name) const { return uniforms.find(name.hash); }
+
+    // Utility uniform functions (glProgramUniform*: no bind needed).
+    // Only safe to call if isValid() is true.
+    void setBool(Shader::UniformName name, bool value) const;
+    void setInt(Shader::UniformName name, int value) const;
+    void setFloat(Shader::UniformName name, float value) const;
+    void setVec2(Shader::UniformName name, const glm::vec2& value) const;
+    void setVec3(Shader::UniformName name, const glm::vec3& value) const;
+    void setVec4(Shader::UniformName name, const glm::vec4& value) const;
+    void setMat3(Shader::UniformName name, const glm::mat3& mat) const;
+    void setMat4(Shader::UniformName name, const glm::mat4& mat) const;
+
+    void setBool(GLint location, bool value) const;
+    void setInt(GLint location, int value) const;
+    void setFloat(GLint location, float value) const;
+    void setVec2(GLint location, const glm::vec2& value) const;
+    void setVec3(GLint location, const glm::vec3& value) const;
+    void setVec4(GLint location, const glm::vec4& value) const;
+    void setMat3(GLint location, const glm::mat3& mat) const;
+    void setMat4(GLint location, const glm::mat4& mat) const;
+
+private:
+    GLuint ID = 0;
+    GLenum type;
+    std::string filePath;
+    std::vector<std::string> defines;
+
+    // Uniform locations by name hash, built once in load()
+    UniformTable uniforms;
+
+    ShaderBinaryCache* binaryCache = nullptr;
+    bool loadedFromBinary = false;
+    double compileTimeMs = 0.0;
+
+    // State of a load between beginLoad() and finishLoad()
+    GLuint pendingShader = 0;
+    uint64_t pendingBinaryKey = 0;
+    std::vector<std::string> sourceFiles; // For error messages ("<file index>:<line>")
+    std::chrono::steady_clock::time_point loadStart;
+
+    // Set up a freshly linked (or binary-loaded) stage
+    void setupLinkedProgram();
+
+    // Internal logging function for standardized error output
+    void logError(const std::string& message) const;
+};
+
+#endif // SHADERSTAGE_H
@@ -0,0 +1,144 @@
+#include "ShaderVariants.h"
+#include "ShaderBatch.h"
+
+#include <filesystem> // For short permutation names
+
+// Constructor: Stores the file paths and keywords
+ShaderVariants::ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& keywords)
+: vertexFilePath(vertexPath), fragmentFilePath(fragmentPath), keywords(keywords)
+{
+    if (this->keywords.size() > MAX_KEYWORDS)
+    {
+        std::cerr << "WARNING::SHADERVARIANTS::TOO_MANY_KEYWORDS (" << this->keywords.size()
+                  << "), only the first " << MAX_KEYWORDS << " are used" << std::endl;
+        this->keywords.resize(MAX_KEYWORDS);
+    }
+}
+
+// Mask of the named keywords
+uint32_t ShaderVariants::getMask(std::initializer_list<std::string_view> names) const
+{
+    uint32_t mask = 0;
+    for (std::string_view name : names)
+    {
+        size_t bit = 0;
+        while (bit < keywords.size() && keywords[bit] != name) {
+            bit++;
+        }
+        if (bit == keywords.size())
+        {
+            std::cerr << "WARNING::SHADERVARIANTS::UNKNOWN_KEYWORD " << name << " in " << getName(0) << std::endl;
+            continue;
+        }
+        mask |= 1u << bit;
+    }
+    return mask;
+}
+
+// The permutation for mask, compiling it now if it was never requested
+Shader* ShaderVariants::get(uint32_t mask)
+{
+    auto it = variants.find(mask);
+    if (it != variants.end()) {
+        return it->second->isValid() ? it->second.get() : nullptr; // Compiled (or failed) before
+    }
+
+    Shader& shader = create(mask);
+    if (!shader.load()) {
+        return nullptr; // Error already printed by Shader::load
+    }
+    return &shader;
+}
+
+// Queue permutations to compile ahead of time with the other programs of a batch
+void ShaderVariants::addToBatch(ShaderBatch& batch, std::initializer_list<uint32_t> masks)
+{
+    for (uint32_t mask : masks)
+    {
+        if (variants.count(mask) == 0) {
+            batch.add(&create(mask), getName(mask));
+        }
+    }
+}
+
+// The separable stage for mask, compiling it now if it was never requested
+ShaderStage* ShaderVariants::getStage(GLenum type, uint32_t mask)
+{
+    auto it = stages.find((static_cast<uint64_t>(type) << 32) | mask);
+    if (it != stages.end()) {
+        return it->second->isValid() ? it->second.get() : nullptr; // Compiled (or failed) before
+    }
+
+    ShaderStage& stage = createStage(type, mask);
+    if (!stage.load()) {
+        return nullptr; // Error already printed by ShaderStage::load
+    }
+    return &stage;
+}
+
+// Queue separable stages to compile ahead of time with the rest of a batch
+void ShaderVariants::addStagesToBatch(ShaderBatch& batch, GLenum type, std::initializer_list<uint32_t> masks)
+{
+    for (uint32_t mask : masks)
+    {
+        if (stages.count((static_cast<uint64_t>(type) << 32) | mask) == 0) {
+            batch.add(&createStage(type, mask), getName(mask, type) + " (stage)");
+        }
+    }
+}
+
+// Name of a permutation for reports
+std::string ShaderVariants::getName(uint32_t mask, GLenum type) const
+{
+    std::string keywordList;
+    for (size_t bit = 0; bit < keywords.size(); bit++)
+    {
+        if (mask & (1u << bit)) {
+            keywordList += (keywordList.empty() ? "" : " ") + keywords[bit];
+        }
+    }
+    const std::string& filePath = type == GL_FRAGMENT_SHADER ? fragmentFilePath : vertexFilePath;
+    const std::string fileName = std::filesystem::path(filePath).filename().string();
+    return keywordList.empty() ? fileName : fileName + " [" + keywordList + "]";
+}
+
+// Defines of a permutation
+std::vector<std::string> ShaderVariants::getDefines(uint32_t mask) const
+{
+    std::vector<std::string> defines;
+    for (size_t bit = 0; bit < MAX_KEYWORDS; bit++)
+    {
+        if (!(mask & (1u << bit))) {
+            continue;
+        }
+        if (bit >= keywords.size())
+        {
+            std::cerr << "WARNING::SHADERVARIANTS::MASK_BIT_WITHOUT_KEYWORD " << bit << " in " << getName(0) << std::endl;
+            continue;
+        }
+        defines.push_back(keywords[bit] + " 1");
+    }
+    return defines;
+}
+
+// Create the (not yet compiled) Shader of a permutation
+Shader& ShaderVariants::create(uint32_t mask)
+{
+    auto shader = std::make_unique<Shader>(vertexFilePath, fragmentFilePath);
+    shader->setDefines(getDefines(mask));
+    shader->setBinaryCache(binaryCache);
+    Shader& created = *shader;
+    variants[mask] = std::move(shader);
+    return created;
+}
+
+// Create the (not yet compiled) ShaderStage of a permutation
+ShaderStage& ShaderVariants::createStage(GLenum type, uint32_t mask)
+{
+    auto stage = std::make_unique<ShaderStage>(type, type == GL_FRAGMENT_SHADER ? fragmentFilePath : vertexFilePath);
+    stage->setDefines(getDefines(mask));
+    stage->setBinaryCache(binaryCache);
+    ShaderStage& created = *stage;
+    stages[(static_cast<uint64_t>(type) << 32) | mask] = std::move(stage);
+    return created;
+}
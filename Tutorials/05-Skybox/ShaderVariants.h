@@ -0,0 +1,99 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+
+#include "Shader.h"
+#include "ShaderStage.h"
+
+class ShaderBatch;
+class ShaderBinaryCache;
+
+// Specialized versions (permutations) of one vertex + fragment shader pair.
+//
+// The shader files are written once with #ifdef blocks for a list of keywords, and each
+// combination of keywords compiles into its own program, so a feature switch costs nothing
+// in the shader instead of a branch on a uniform. Keyword i is bit i of a 32-bit mask, and
+// each set bit becomes "#define <keyword> 1" (see ShaderPreprocessor).
+//
+// A permutation compiles the first time get() asks for it, or ahead of time through
+// addToBatch(). Either way it is compiled once: later calls return the same Shader, and a
+// permutation that failed is not retried. Only the masks actually used are ever compiled,
+// so the keyword list can grow without multiplying the compile time.
+//
+// The same files also compile into separable ShaderStages (getStage), one per stage type
+// and mask. A vertex permutation then pairs with any fragment permutation whose inputs it
+// provides through a ProgramPipeline: N vertex and M fragment permutations cost N + M
+// compiles instead of N x M programs.
+class ShaderVariants
+{
+public:
+    static constexpr size_t MAX_KEYWORDS = 32;
+
+    // Constructor stores the file paths and keywords but does NOT compile anything
+    ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& keywords);
+
+    // Prevent copying (meshes keep pointers to the permutations)
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // Use a program binary cache for every permutation compiled after this call
+    void setBinaryCache(ShaderBinaryCache* cache) { binaryCache = cache; }
+
+    // Mask of the named keywords (unknown names print a warning and are ignored)
+    uint32_t getMask(std::initializer_list<std::string_view> names) const;
+
+    // The permutation for mask, compiling it now if it was never requested.
+    // Must be called on the GL thread. Returns nullptr if it failed to compile
+    // (errors are printed once, when it compiles).
+    Shader* get(uint32_t mask);
+
+    // Queue permutations to compile ahead of time with the other programs of a batch.
+    // Masks already compiled or queued are skipped. get() returns them once the batch has compiled.
+    void addToBatch(ShaderBatch& batch, std::initializer_list<uint32_t> masks);
+
+    // The separable stage (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER) for mask, compiling it now
+    // if it was never requested. Must be called on the GL thread. Returns nullptr if it failed.
+    ShaderStage* getStage(GLenum type, uint32_t mask);
+
+    // Queue separable stages to compile ahead of time with the rest of a batch.
+    // Stages already compiled or queued are skipped.
+    void addStagesToBatch(ShaderBatch& batch, GLenum type, std::initializer_list<uint32_t> masks);
+
+    // Name of a permutation for reports, e.g. "cube_instanced.vert.glsl [TEXTURE_ARRAY]"
+    // (just the file name for mask 0). Stages are named after their own file.
+    std::string getName(uint32_t mask, GLenum type = GL_VERTEX_SHADER) const;
+
+    // Number of permutations (programs and stages) created so far
+    size_t getCount() const { return variants.size() + stages.size(); }
+
+private:
+    std::string vertexFilePath;
+    std::string fragmentFilePath;
+    std::vector<std::string> keywords;
+    ShaderBinaryCache* binaryCache = nullptr;
+
+    // Permutations by mask (unique_ptr keeps each Shader at a fixed address)
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants;
+
+    // Separable stages by stage type (high 32 bits) and mask (low 32 bits)
+    std::unordered_map<uint64_t, std::unique_ptr<ShaderStage>> stages;
+
+    // Defines of a permutation ("<keyword> 1" per set bit)
+    std::vector<std::string> getDefines(uint32_t mask) const;
+
+    // Create the (not yet compiled) Shader of a permutation
+    Shader& create(uint32_t mask);
+
+    // Create the (not yet compiled) ShaderStage of a permutation
+    ShaderStage& createStage(GLenum type, uint32_t mask);
+};
+
+#endif // SHADERVARIANTS_H
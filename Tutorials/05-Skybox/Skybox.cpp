@@ -1,5 +1,7 @@
 #include "Skybox.h"
+#include "RenderState.h"
 #include <iostream>
+#include <algorithm> // For std::find_if
 
 // Definition of the static constant vertices for the skybox cube
 const float Skybox::skyboxVertices[108] = {
@@ -56,24 +58,41 @@ Skybox::Skybox()
 
 // Destructor
 Skybox::~Skybox()
+{
+    releaseMesh();
+}
+
+// Helper function to release the geometry
+void Skybox::releaseMesh()
 {
     // Delete the OpenGL resources owned by this class
     if (vao != 0) {
+        RenderState::onVertexArrayDeleted(vao);
         glDeleteVertexArrays(1, &vao);
     }
     if (vbo != 0) {
         glDeleteBuffers(1, &vbo);
     }
+    vao = vbo = 0;
+    // Or give the pooled space back
+    if (meshHandle.isValid()) {
+        meshPool->free(meshHandle);
+    }
+    meshHandle = MeshPool::MeshHandle();
+    meshPool = nullptr;
 }
 
 // Move constructor
 Skybox::Skybox(Skybox&& other) noexcept
 : vao(other.vao), vbo(other.vbo),
-cubeTexture(other.cubeTexture), shader(other.shader)
+cubeTexture(other.cubeTexture), shader(other.shader),
+meshPool(other.meshPool), meshHandle(other.meshHandle)
 {
     // Transfer ownership by setting other's IDs and pointers to 0/nullptr
     other.vao = 0;
     other.vbo = 0;
+    other.meshPool = nullptr;
+    other.meshHandle = MeshPool::MeshHandle();
     other.cubeTexture = nullptr;
     other.shader = nullptr;
 }
@@ -82,9 +101,8 @@ cubeTexture(other.cubeTexture), shader(other.shader)
 Skybox& Skybox::operator=(Skybox&& other) noexcept
 {
     if (this != &other) {
-        // Delete our own OpenGL resources if they exist
-        if (vao != 0) glDeleteVertexArrays(1, &vao);
-        if (vbo != 0) glDeleteBuffers(1, &vbo);
+        // Delete our own OpenGL resources (or pool allocation) if they exist
+        releaseMesh();
         // Note: We do NOT delete our old shader or cubeTexture pointers
         
         // Transfer ownership from other
@@ -92,10 +110,14 @@ Skybox& Skybox::operator=(Skybox&& other) noexcept
         vbo = other.vbo;
         cubeTexture = other.cubeTexture;
         shader = other.shader;
+        meshPool = other.meshPool;
+        meshHandle = other.meshHandle;
         
         // Set other's IDs and pointers to 0/nullptr
         other.vao = 0;
         other.vbo = 0;
+        other.meshPool = nullptr;
+        other.meshHandle = MeshPool::MeshHandle();
         other.cubeTexture = nullptr;
         other.shader = nullptr;
     }
@@ -128,7 +150,7 @@ void Skybox::setCubeTexture(CubeTexture* texture)
 }
 
 // Draws the skybox
-void Skybox::draw(const glm::mat4& view, const glm::mat4& projection)
+void Skybox::draw()
 {
     // Ensure necessary resources are assigned and valid before drawing
     if (!isValid()) { // Updated call to isValid()
@@ -138,27 +160,28 @@ void Skybox::draw(const glm::mat4& view, const glm::mat4& projection)
     
     // Draw skybox as last (or first with depth testing disabled)
     // Drawing last with GL_LEQUAL is common to ensure it's behind everything
-    glDepthFunc(GL_LEQUAL);
+    RenderState::setDepthFunc(GL_LEQUAL);
     
+    // The shader removes the translation from the shared view matrix itself
     shader->use();
     
-    // We need the view matrix without the translation component for the skybox
-    // Get the camera's view matrix, then remove the translation part
-    glm::mat4 viewWithoutTranslation = glm::mat4(glm::mat3(view));
-    
-    shader->setMat4("uView", viewWithoutTranslation);
-    shader->setMat4("uProjection", projection);
-    
-    // Bind the skybox VAO and texture
-    glBindVertexArray(vao);
     cubeTexture->bind(0); // Bind to texture unit 0 (assuming uniform "skybox" is set to 0) - Renamed
     
-    glDrawArrays(GL_TRIANGLES, 0, 36); // Draw the 36 vertices of the cube
+    if (meshHandle.isValid())
+    {
+        // One multi-draw from the pool's shared VAO
+        meshPool->draw(std::span<const MeshPool::MeshHandle>(&meshHandle, 1));
+    }
+    else
+    {
+        // Bind the skybox VAO
+        RenderState::bindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, 36); // Draw the 36 vertices of the cube
+    }
     
-    glBindVertexArray(0); // Unbind VAO
-    cubeTexture->unbind(0); // Unbind texture from unit 0 - Renamed
+    // VAO and cubemap stay bound; RenderState skips the rebind next frame
     
-    glDepthFunc(GL_LESS); // Set depth function back to default
+    RenderState::setDepthFunc(GL_LESS); // Set depth function back to default
 }
 
 // Check if the necessary resources (shader and texture) are assigned and valid
@@ -167,21 +190,22 @@ bool Skybox::isValid() const
 {
     return shader != nullptr && shader->isValid() &&
     cubeTexture != nullptr && cubeTexture->isValid() &&
-    vao != 0 && vbo != 0; // Also check if geometry is set up - Renamed
+    ((vao != 0 && vbo != 0) || meshHandle.isValid()); // Also check if geometry is set up - Renamed
 }
 
 
 // Initializes the skybox geometry (VAO and VBO)
 bool Skybox::setupMesh()
 {
+    releaseMesh(); // setupMesh may be called again after construction
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
+    RenderState::bindVertexArray(vao);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glBindVertexArray(0); // Unbind VAO
+    RenderState::bindVertexArray(0); // Unbind VAO
     
     // Check if VAO was successfully created (a basic check)
     if (vao == 0)
@@ -193,3 +217,33 @@ bool Skybox::setupMesh()
     return true;
 }
 
+// Places the skybox geometry in a shared mesh pool
+bool Skybox::setupMesh(MeshPool& pool, const VertexLayoutDesc& layout)
+{
+    releaseMesh();
+    
+    // Index the 36 corner positions: the cube has only 8 distinct vertices
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (size_t i = 0; i < 36; i++)
+    {
+        glm::vec3 position(skyboxVertices[i * 3], skyboxVertices[i * 3 + 1], skyboxVertices[i * 3 + 2]);
+        auto it = std::find_if(vertices.begin(), vertices.end(), [&](const Vertex& v) { return v.position == position; });
+        if (it == vertices.end())
+        {
+            Vertex vertex = {};
+            vertex.position = position;
+            it = vertices.insert(vertices.end(), vertex);
+        }
+        indices.push_back(static_cast<unsigned int>(it - vertices.begin()));
+    }
+    
+    meshHandle = pool.allocate(layout, vertices, indices);
+    if (!meshHandle.isValid())
+    {
+        std::cerr << "Failed to allocate the skybox from the mesh pool." << std::endl;
+        return false;
+    }
+    meshPool = &pool;
+    return true;
+}
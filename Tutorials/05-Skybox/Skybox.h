@@ -10,6 +10,7 @@
 
 #include "Shader.h"
 #include "CubeTexture.h"
+#include "MeshPool.h"
 
 class Skybox
 {
@@ -32,6 +33,11 @@ public:
     // Initializes the skybox geometry (VAO and VBO)
     bool setupMesh();
 
+    // Places the skybox geometry in a shared mesh pool instead of its own VAO and VBO.
+    // Only positions are read (location 0), so any pooled layout works; passing the layout of
+    // the other pooled meshes lets the skybox share their VAO. The pool must outlive the skybox.
+    bool setupMesh(MeshPool& pool, const VertexLayoutDesc& layout);
+
     // Assign the shader to this skybox
     void setShader(Shader* shader);
 
@@ -39,8 +45,8 @@ public:
     void setCubeTexture(CubeTexture* texture);
 
     // Draws the skybox
-    // Takes view and projection matrices as parameters
-    void draw(const glm::mat4& view, const glm::mat4& projection);
+    // View and projection come from the per-frame uniform block (see FrameUniforms)
+    void draw();
 
     // Check if the necessary resources (shader and texture) are assigned and valid
     // Renamed from isReadyToDraw for consistency
@@ -51,6 +57,11 @@ private:
     GLuint vbo = 0; // Initialize to 0 - Renamed from skyboxVBO
     CubeTexture* cubeTexture = nullptr; // Pointer to the CubeTexture object (owned externally) - Renamed from cubemapTexture
     Shader* shader = nullptr;      // Pointer to the Shader object (owned externally) - Renamed from skyboxShader
+    MeshPool* meshPool = nullptr;  // Pool holding the geometry instead of vao/vbo (owned externally)
+    MeshPool::MeshHandle meshHandle;
+
+    // Helper function to release the geometry (own VAO/VBO, or the pool allocation)
+    void releaseMesh();
 
     // Declaration of the static constant vertices for the skybox cube
     // The definition is in the .cpp file
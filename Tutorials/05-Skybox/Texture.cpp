@@ -1,12 +1,17 @@
 #include "Texture.h"
+#include "RenderState.h"
+#include "TextureCompression.h"
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include "TextureStreamer.h"
+#include "ImageDecoder.h"
 
-// Tell stb_image to implement the functions
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <algorithm>  // For std::clamp
+#include <filesystem> // For finding the fallback of a compressed file
 
-// Constructor implementation: Simply stores the file path.
-Texture::Texture(const std::string& filePath)
-: ID(0), filePath(filePath)
+// Constructor implementation: Simply stores the file path and sampling.
+Texture::Texture(const std::string& filePath, const TextureSampling& sampling)
+: ID(0), filePath(filePath), sampling(sampling)
 {
     // No OpenGL or image loading calls here.
     // Image loading and texture creation happen in the load() method.
@@ -17,16 +22,20 @@ Texture::~Texture()
 {
     if (ID != 0) // Only delete if a valid texture was created (ID is not 0)
     {
+        RenderState::onTextureDeleted(ID);
         glDeleteTextures(1, &ID);
     }
 }
 
 // Move constructor
 Texture::Texture(Texture&& other) noexcept
-: ID(other.ID), filePath(std::move(other.filePath)),
-width(other.width), height(other.height), nrChannels(other.nrChannels)
+: ID(other.ID), filePath(std::move(other.filePath)), sampling(other.sampling), gpuMemoryBytes(other.gpuMemoryBytes),
+baseLevel(other.baseLevel), levelCount(other.levelCount), width(other.width), height(other.height), nrChannels(other.nrChannels)
 {
     other.ID = 0; // Set other's ID to 0 to prevent double deletion
+    other.gpuMemoryBytes = 0;
+    other.baseLevel = 0;
+    other.levelCount = 0;
     other.width = 0;
     other.height = 0;
     other.nrChannels = 0;
@@ -39,18 +48,26 @@ Texture& Texture::operator=(Texture&& other) noexcept
     {
         if (ID != 0) // Delete the current texture if this object holds one
         {
+            RenderState::onTextureDeleted(ID);
             glDeleteTextures(1, &ID);
         }
         
         // Transfer ownership
         ID = other.ID;
         filePath = std::move(other.filePath);
+        sampling = other.sampling;
+        gpuMemoryBytes = other.gpuMemoryBytes;
+        baseLevel = other.baseLevel;
+        levelCount = other.levelCount;
         width = other.width;
         height = other.height;
         nrChannels = other.nrChannels;
         
         // Set other's state to default
         other.ID = 0;
+        other.gpuMemoryBytes = 0;
+        other.baseLevel = 0;
+        other.levelCount = 0;
         other.width = 0;
         other.height = 0;
         other.nrChannels = 0;
@@ -64,68 +81,363 @@ bool Texture::load()
     // Clean up any existing texture if load() is called multiple times
     if (ID != 0)
     {
+        RenderState::onTextureDeleted(ID);
         glDeleteTextures(1, &ID);
         ID = 0; // Reset ID
+        gpuMemoryBytes = 0;
+        baseLevel = 0;
+        levelCount = 0;
     }
     
-    // 1. Load image data using stb_image.h
-    // Flip texture vertically because OpenGL expects the first pixel to be at the bottom-left
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
+    // Block-compressed containers are uploaded as they are
+    std::string imagePath = filePath;
+    if (CompressedImage::isContainerFile(filePath))
+    {
+        CompressedImage compressed = CompressedImage::loadFromFile(filePath);
+        if (compressed.isValid() && upload(compressed))
+        {
+            return true;
+        }
+        // Not readable or not supported by this context: use the uncompressed original
+        imagePath = getFallbackPath(filePath);
+        if (imagePath.empty())
+        {
+            logError("No uncompressed fallback found for " + filePath);
+            return false;
+        }
+        std::cerr << "WARNING::TEXTURE::LOAD::USING_FALLBACK " << imagePath << std::endl;
+    }
     
-    if (!data)
+    // 1. Load image data, 2. filter its mip chain, then 3. upload it
+    Image image = ImageDecoder::decode(imagePath);
+    if (!image.isValid())
     {
-        logError("Failed to load texture image: " + filePath);
-        return false; // Indicate failure
+        return false; // Indicate failure (message already printed by decode)
+    }
+    // This is the GL thread, not a pool worker, so the shared pool can split the filtering
+    std::vector<Image> mipLevels = MipGenerator::generate(image, MipOptions(), &ThreadPool::shared());
+    return upload(image, mipLevels);
+}
+
+// Helper function to map a channel count to an OpenGL format
+GLenum Texture::formatForChannels(int channels)
+{
+    if (channels == 1)
+        return GL_RED;
+    else if (channels == 3)
+        return GL_RGB;
+    else if (channels == 4)
+        return GL_RGBA;
+    return 0;
+}
+
+// Set the wrap and filter modes of the texture bound to target
+void TextureSampling::apply(GLenum target, bool hasMipmaps) const
+{
+    GLenum minFilter = this->minFilter;
+    if (!hasMipmaps)
+    {
+        // Sampling missing levels would make the texture incomplete (black)
+        if (minFilter == GL_NEAREST_MIPMAP_NEAREST || minFilter == GL_NEAREST_MIPMAP_LINEAR)
+            minFilter = GL_NEAREST;
+        else if (minFilter == GL_LINEAR_MIPMAP_NEAREST || minFilter == GL_LINEAR_MIPMAP_LINEAR)
+            minFilter = GL_LINEAR;
+    }
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrapS);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrapT);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, magFilter);
+}
+
+// Upload a decoded image into this texture with its mip chain
+bool Texture::upload(const Image& image, std::span<const Image> mipLevels, int firstLevel)
+{
+    if (!image.isValid())
+    {
+        logError("Attempted to upload an empty image for " + filePath);
+        return false;
     }
     
     // Determine the image format based on the number of channels
-    GLenum format;
-    if (nrChannels == 1)
-        format = GL_RED;
-    else if (nrChannels == 3)
-        format = GL_RGB;
-    else if (nrChannels == 4)
-        format = GL_RGBA;
-    else
+    GLenum format = formatForChannels(image.channels);
+    if (format == 0)
     {
-        logError("Unsupported number of texture channels: " + std::to_string(nrChannels) + " for " + filePath);
-        stbi_image_free(data); // Free image data
+        logError("Unsupported number of texture channels: " + std::to_string(image.channels) + " for " + filePath);
         return false; // Indicate failure
     }
+    width = image.width;
+    height = image.height;
+    nrChannels = image.channels;
+    // Without a chain the driver generates every level from level 0, which must then be resident
+    const int lastLevel = static_cast<int>(mipLevels.size());
+    baseLevel = mipLevels.empty() ? 0 : std::clamp(firstLevel, 0, lastLevel);
+    levelCount = mipLevels.empty() ? MipGenerator::getLevelCount(width, height) : lastLevel + 1;
     
-    // 2. Create OpenGL texture
-    glGenTextures(1, &ID); // Generate a texture ID
-    glBindTexture(GL_TEXTURE_2D, ID); // Bind the texture
-    
-    // 3. Set texture wrapping and filtering options
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Set texture wrapping for S axis
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // Set texture wrapping for T axis
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // Set minification filter
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Set magnification filter
+    // 2. Create OpenGL texture (or reuse the placeholder's ID)
+    if (ID == 0) {
+        glGenTextures(1, &ID); // Generate a texture ID
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D, ID); // Bind the texture (on unit 0)
     
-    // 4. Upload image data to the texture
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    // 3. Set texture wrapping and filtering options (every upload has a full mip chain)
+    sampling.apply(GL_TEXTURE_2D, true);
+    // Sampling starts at the finest uploaded level, so the unallocated ones above are never read
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    // Only the levels we upload (or the full chain, the default, when the driver generates it)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels.empty() ? 1000 : lastLevel);
     
-    // 5. Generate mipmaps
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // 4. Upload image data to the texture, from the base level down
+    // Rows are tightly packed, which breaks the default 4-byte alignment for RGB/RED widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gpuMemoryBytes = 0;
+    for (int level = baseLevel; level <= lastLevel; level++)
+    {
+        const Image& levelImage = level == 0 ? image : mipLevels[level - 1];
+        glTexImage2D(GL_TEXTURE_2D, level, format, levelImage.width, levelImage.height, 0, format, GL_UNSIGNED_BYTE, levelImage.pixels.data());
+        gpuMemoryBytes += levelImage.pixels.size();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     
-    // 6. Free image data after uploading to the GPU
-    stbi_image_free(data);
+    // 5. Or let the driver generate the chain
+    if (mipLevels.empty()) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        gpuMemoryBytes += gpuMemoryBytes / 3; // A full chain adds a third of the base level
+    }
     
     // Unbind the texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
     
     return true; // Indicate success
 }
 
+// Make the next finer level resident, then lower the base level to it
+bool Texture::streamInLevel(const Image& levelImage, TextureStreamer* streamer, std::shared_ptr<const void> keepAlive,
+                            std::function<void()> onComplete)
+{
+    const int level = baseLevel - 1;
+    if (ID == 0 || level < 0)
+    {
+        logError("No finer mip level to stream in for " + filePath);
+        return false;
+    }
+    if (levelImage.width != std::max(width >> level, 1) || levelImage.height != std::max(height >> level, 1)
+        || levelImage.channels != nrChannels)
+    {
+        logError("Mip level " + std::to_string(level) + " does not match the texture layout for " + filePath);
+        return false;
+    }
+    const GLenum format = formatForChannels(nrChannels);
+    
+    // Nothing samples the level until the base level is lowered, so it can be filled at leisure
+    RenderState::bindTexture(0, GL_TEXTURE_2D, ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, level, format, levelImage.width, levelImage.height, 0, format, GL_UNSIGNED_BYTE,
+                 streamer ? nullptr : levelImage.pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    
+    auto makeResident = [this, level, bytes = levelImage.pixels.size(), onComplete = std::move(onComplete)]() {
+        RenderState::bindTexture(0, GL_TEXTURE_2D, ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+        baseLevel = level;
+        gpuMemoryBytes += bytes;
+        if (onComplete) {
+            onComplete();
+        }
+    };
+    if (!streamer)
+    {
+        makeResident();
+        return true;
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+    
+    TextureStreamer::Upload upload;
+    upload.texture = ID;
+    upload.bindTarget = GL_TEXTURE_2D;
+    upload.format = format;
+    upload.channels = nrChannels;
+    upload.regions.push_back({ GL_TEXTURE_2D, level, levelImage.width, levelImage.height, levelImage.pixels.data() });
+    upload.keepAlive = std::move(keepAlive);
+    upload.onComplete = std::move(makeResident);
+    streamer->enqueue(std::move(upload));
+    return true;
+}
+
+// Raise the base level and release the storage of the levels below it
+void Texture::dropLevelsBelow(int newBaseLevel)
+{
+    newBaseLevel = std::min(newBaseLevel, levelCount - 1);
+    if (ID == 0 || newBaseLevel <= baseLevel) {
+        return;
+    }
+    const GLenum format = formatForChannels(nrChannels);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, ID);
+    // Clamp first, so the texture never refers to a released level
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, newBaseLevel);
+    for (int level = baseLevel; level < newBaseLevel; level++)
+    {
+        // GL 4.1 cannot shrink storage in place: redefining a level as 0x0 lets the driver free it
+        glTexImage2D(GL_TEXTURE_2D, level, format, 0, 0, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        gpuMemoryBytes -= static_cast<size_t>(std::max(width >> level, 1)) * std::max(height >> level, 1) * nrChannels;
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+    baseLevel = newBaseLevel;
+}
+
+// Stream a decoded image and its mip levels through the streamer's pixel buffers
+bool Texture::stream(const Image& image, std::span<const Image> mipLevels, std::shared_ptr<const void> keepAlive,
+                     TextureStreamer& streamer, std::function<void()> onComplete)
+{
+    if (!image.isValid())
+    {
+        logError("Attempted to stream an empty image for " + filePath);
+        return false;
+    }
+    GLenum format = formatForChannels(image.channels);
+    if (format == 0)
+    {
+        logError("Unsupported number of texture channels: " + std::to_string(image.channels) + " for " + filePath);
+        return false;
+    }
+    
+    // Allocate the new storage now; the streamer fills it over the next frames
+    GLuint streamingID = 0;
+    glGenTextures(1, &streamingID);
+    RenderState::bindTexture(0, GL_TEXTURE_2D, streamingID);
+    sampling.apply(GL_TEXTURE_2D, true);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels.empty() ? 1000 : static_cast<GLint>(mipLevels.size()));
+    
+    TextureStreamer::Upload upload;
+    upload.texture = streamingID;
+    upload.bindTarget = GL_TEXTURE_2D;
+    upload.format = format;
+    upload.channels = image.channels;
+    size_t bytes = 0;
+    for (size_t level = 0; level <= mipLevels.size(); level++)
+    {
+        const Image& levelImage = level == 0 ? image : mipLevels[level - 1];
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), format, levelImage.width, levelImage.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        upload.regions.push_back({ GL_TEXTURE_2D, static_cast<GLint>(level), levelImage.width, levelImage.height, levelImage.pixels.data() });
+        bytes += levelImage.pixels.size();
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+    
+    upload.keepAlive = std::move(keepAlive);
+    const bool generateMipmaps = mipLevels.empty();
+    const int levelCountOnCompletion = generateMipmaps ? MipGenerator::getLevelCount(image.width, image.height)
+                                                       : static_cast<int>(mipLevels.size()) + 1;
+    upload.onComplete = [this, streamingID, bytes, generateMipmaps, levelCountOnCompletion, width = image.width, height = image.height,
+                         channels = image.channels, onComplete = std::move(onComplete)]() {
+        if (generateMipmaps)
+        {
+            RenderState::bindTexture(0, GL_TEXTURE_2D, streamingID);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+        }
+        // Swap the finished texture in for the current one
+        if (ID != 0)
+        {
+            RenderState::onTextureDeleted(ID);
+            glDeleteTextures(1, &ID);
+        }
+        ID = streamingID;
+        this->width = width;
+        this->height = height;
+        nrChannels = channels;
+        baseLevel = 0;
+        levelCount = levelCountOnCompletion;
+        gpuMemoryBytes = generateMipmaps ? bytes + bytes / 3 : bytes;
+        if (onComplete) {
+            onComplete();
+        }
+    };
+    streamer.enqueue(std::move(upload));
+    return true;
+}
+
+// Upload a block-compressed image with its stored mip levels
+bool Texture::upload(const CompressedImage& image)
+{
+    if (!image.isValid())
+    {
+        logError("Attempted to upload an empty compressed image for " + filePath);
+        return false;
+    }
+    if (!TextureCompression::isSupported(image.internalFormat))
+    {
+        std::cerr << "WARNING::TEXTURE::UPLOAD::UNSUPPORTED_COMPRESSED_FORMAT "
+                  << TextureCompression::getFormatName(image.internalFormat) << " for " << image.source << std::endl;
+        return false;
+    }
+    width = image.width;
+    height = image.height;
+    nrChannels = 0; // Not meaningful for compressed formats
+    baseLevel = 0;
+    levelCount = image.levelCount;
+    
+    if (ID == 0) {
+        glGenTextures(1, &ID);
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D, ID);
+    
+    // Only use mipmapped filtering if the file has a mip chain (no glGenerateMipmap on compressed data)
+    sampling.apply(GL_TEXTURE_2D, image.levelCount > 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levelCount - 1);
+    
+    // Upload every stored level of the first face
+    gpuMemoryBytes = 0;
+    for (const CompressedImage::Surface& surface : image.surfaces)
+    {
+        if (surface.face != 0) {
+            continue;
+        }
+        glCompressedTexImage2D(GL_TEXTURE_2D, surface.level, image.internalFormat, surface.width, surface.height, 0,
+                               static_cast<GLsizei>(surface.size), image.data.data() + surface.offset);
+        gpuMemoryBytes += surface.size;
+    }
+    
+    RenderState::bindTexture(0, GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// Get the uncompressed file to load when a compressed file's format is unsupported
+std::string Texture::getFallbackPath(const std::string& compressedPath)
+{
+    static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".tga" };
+    for (const char* extension : extensions)
+    {
+        std::filesystem::path candidate(compressedPath);
+        candidate.replace_extension(extension);
+        std::error_code error;
+        if (std::filesystem::exists(candidate, error)) {
+            return candidate.string();
+        }
+    }
+    return std::string();
+}
+
+// Create a 1x1 texture to sample while the real image is still loading
+bool Texture::createPlaceholder(unsigned char r, unsigned char g, unsigned char b)
+{
+    Image placeholder;
+    placeholder.pixels = { r, g, b };
+    placeholder.width = 1;
+    placeholder.height = 1;
+    placeholder.channels = 3;
+    return upload(placeholder);
+}
+
 // Bind the texture to a specific texture unit.
 void Texture::bind(GLuint textureUnit) const
 {
     if (ID != 0) // Only bind if the texture is valid
     {
-        glActiveTexture(GL_TEXTURE0 + textureUnit); // Activate the specified texture unit
-        glBindTexture(GL_TEXTURE_2D, ID);             // Bind this texture to the active unit
+        // Activate the specified texture unit and bind this texture to it
+        // (skipped by the state cache if it is already bound there)
+        RenderState::bindTexture(textureUnit, GL_TEXTURE_2D, ID);
     }
     else
     {
@@ -136,10 +448,8 @@ void Texture::bind(GLuint textureUnit) const
 
 void Texture::unbind(unsigned int textureUnit) const
 {
-    // Activate the specified texture unit
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    // Unbind the texture from the currently active texture unit
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Unbind the texture from the specified texture unit
+    RenderState::bindTexture(textureUnit, GL_TEXTURE_2D, 0);
 }
 
 // Utility function for reporting errors
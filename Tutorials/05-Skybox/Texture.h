@@ -2,14 +2,39 @@
 #define TEXTURE_H
 
 #include <glad/gl.h>
+#include <functional>
+#include <memory>
 #include <string>
 #include <iostream>
+#include <span>
+
+#include "Image.h" // For the decoded CPU image
+#include "CompressedImage.h" // For KTX / DDS block-compressed images
+
+class TextureStreamer;
+
+// Sampler state applied to a texture when it is uploaded
+struct TextureSampling
+{
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR; // Mipmap filters fall back to their base filter without a mip chain
+    GLenum magFilter = GL_LINEAR;
+
+    bool operator==(const TextureSampling& other) const
+    {
+        return wrapS == other.wrapS && wrapT == other.wrapT && minFilter == other.minFilter && magFilter == other.magFilter;
+    }
+
+    // Set the wrap and filter modes of the texture bound to target (hasMipmaps = false drops mipmap filtering)
+    void apply(GLenum target, bool hasMipmaps) const;
+};
 
 class Texture
 {
 public:
-    // Constructor: Stores the file path but does NOT load the image or create the OpenGL texture.
-    Texture(const std::string& filePath);
+    // Constructor: Stores the file path and sampling but does NOT load the image or create the OpenGL texture.
+    Texture(const std::string& filePath, const TextureSampling& sampling = TextureSampling());
 
     // Destructor: Deletes the OpenGL texture object.
     ~Texture();
@@ -23,12 +48,60 @@ public:
     Texture& operator=(Texture&& other) noexcept;
 
     // Method to load the image, create the OpenGL texture, and configure it.
+    // The mip chain is filtered on the CPU (see MipGenerator) using the shared thread pool.
+    // KTX and DDS files are uploaded block-compressed with their stored mip chain.
+    // If the context cannot sample their format, a sibling file with the same name and
+    // an image extension (.png, .jpg, .jpeg, .tga) is loaded instead, if one exists.
     // This must be called AFTER creating the Texture object and
     // AFTER a valid OpenGL context has been made current.
     // Returns true on success, false on failure.
     // Errors will be printed to cerr.
     bool load();
 
+    // Upload a decoded image into this texture with its mip chain.
+    // mipLevels are levels 1..N (e.g. from MipGenerator::generate) and are uploaded level by level;
+    // if empty, the driver generates the mipmaps instead (glGenerateMipmap).
+    // With firstLevel > 0 (and a mip chain), only levels firstLevel..N are uploaded: the finer levels
+    // are left unallocated and GL_TEXTURE_BASE_LEVEL is clamped to firstLevel (see MipResidency).
+    // Reuses the existing texture ID (e.g. the placeholder), so meshes holding
+    // this texture pick up the new image without any change.
+    // Must be called on the GL thread. Returns true on success, false on failure.
+    bool upload(const Image& image, std::span<const Image> mipLevels = {}, int firstLevel = 0);
+
+    // Make the next finer level (getBaseLevel() - 1) resident from its image, then lower the base
+    // level to it. With a streamer, the level streams in over the next frames and the base level
+    // drops once it has arrived (onComplete runs then; keepAlive must own the pixels, and the
+    // Texture must not be moved or destroyed before completion); without one it is immediate.
+    // Must be called on the GL thread. Returns true if the level was uploaded or queued.
+    bool streamInLevel(const Image& levelImage, TextureStreamer* streamer = nullptr,
+                       std::shared_ptr<const void> keepAlive = nullptr, std::function<void()> onComplete = {});
+
+    // Raise the base level to newBaseLevel and release the storage of the levels below it.
+    // Must be called on the GL thread.
+    void dropLevelsBelow(int newBaseLevel);
+
+    // Stream a decoded image and its mip levels through the streamer's pixel buffers instead of
+    // uploading it at once (see TextureStreamer). The pixels go into new storage while the current
+    // texture (e.g. the placeholder) stays in use, and the ID is swapped once the last row has
+    // arrived; onComplete runs then. keepAlive must own the pixels of image and mipLevels.
+    // The Texture must not be moved or destroyed before completion.
+    // Must be called on the GL thread. Returns true if the upload was queued.
+    bool stream(const Image& image, std::span<const Image> mipLevels, std::shared_ptr<const void> keepAlive,
+                TextureStreamer& streamer, std::function<void()> onComplete = {});
+
+    // Upload a block-compressed image (face 0) with its stored mip levels.
+    // Fails without touching the texture if the context does not support the format.
+    // Must be called on the GL thread. Returns true on success, false on failure.
+    bool upload(const CompressedImage& image);
+
+    // Get the uncompressed file to load when a compressed file's format is unsupported:
+    // the same path with an image extension, or an empty string if there is none.
+    static std::string getFallbackPath(const std::string& compressedPath);
+
+    // Create a 1x1 texture to sample while the real image is still loading.
+    // Must be called on the GL thread. Returns true on success, false on failure.
+    bool createPlaceholder(unsigned char r = 128, unsigned char g = 128, unsigned char b = 128);
+
     // Bind the texture to a specific texture unit.
     // Only safe to call if isValid() is true.
     void bind(GLuint textureUnit = 0) const; // Default to texture unit 0
@@ -42,9 +115,29 @@ public:
     // Get the OpenGL texture ID.
     GLuint getID() const { return ID; }
 
+    // Get the image file path.
+    const std::string& getFilePath() const { return filePath; }
+
+    // Get the sampler state used at upload.
+    const TextureSampling& getSampling() const { return sampling; }
+
+    // Bytes of GPU memory taken by the uploaded levels (estimated from the uploaded data;
+    // drivers may pad RGB to RGBA). 0 if nothing has been uploaded.
+    size_t getGpuMemoryBytes() const { return gpuMemoryBytes; }
+
+    // Get the finest resident mip level (GL_TEXTURE_BASE_LEVEL); 0 unless the mips are streamed.
+    int getBaseLevel() const { return baseLevel; }
+
+    // Get the number of levels in the full mip chain (resident or not).
+    int getLevelCount() const { return levelCount; }
+
 private:
     GLuint ID = 0; // The OpenGL texture ID (0 indicates invalid/not loaded)
     std::string filePath; // Stored file path to the image
+    TextureSampling sampling; // Wrap and filter modes set at upload
+    size_t gpuMemoryBytes = 0; // Size of the uploaded levels
+    int baseLevel = 0;  // Finest resident level
+    int levelCount = 0; // Levels in the full chain
 
     int width = 0;  // Image width
     int height = 0; // Image height
@@ -52,6 +145,9 @@ private:
 
     // Utility function for reporting errors
     void logError(const std::string& message) const;
+
+    // Helper function to map a channel count to an OpenGL format (0 if unsupported)
+    static GLenum formatForChannels(int channels);
 };
 
 #endif // TEXTURE_H
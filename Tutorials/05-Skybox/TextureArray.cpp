@@ -0,0 +1,233 @@
+#include "TextureArray.h"
+
+#include <algorithm> // For std::max
+
+#include "MipGenerator.h" // For the level count
+#include "RenderState.h"
+#include "TextureStreamer.h"
+
+// Helper function to map a channel count to an OpenGL format
+static GLenum formatForChannels(int channels)
+{
+    if (channels == 1)
+        return GL_RED;
+    else if (channels == 3)
+        return GL_RGB;
+    else if (channels == 4)
+        return GL_RGBA;
+    return 0;
+}
+
+// Constructor: Stores the layout, no OpenGL calls
+TextureArray::TextureArray(int width, int height, int channels, int layerCount, const TextureSampling& sampling)
+: width(width), height(height), channels(channels), layerCount(layerCount),
+levelCount(MipGenerator::getLevelCount(width, height)), sampling(sampling)
+{
+}
+
+// Destructor: Deletes the OpenGL texture object if it was created
+TextureArray::~TextureArray()
+{
+    if (ID != 0)
+    {
+        RenderState::onTextureDeleted(ID);
+        glDeleteTextures(1, &ID);
+    }
+}
+
+// Move constructor
+TextureArray::TextureArray(TextureArray&& other) noexcept
+: ID(other.ID), width(other.width), height(other.height), channels(other.channels),
+layerCount(other.layerCount), levelCount(other.levelCount), sampling(other.sampling)
+{
+    other.ID = 0; // Prevent double deletion
+}
+
+// Move assignment operator
+TextureArray& TextureArray::operator=(TextureArray&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (ID != 0)
+        {
+            RenderState::onTextureDeleted(ID);
+            glDeleteTextures(1, &ID);
+        }
+        ID = other.ID;
+        width = other.width;
+        height = other.height;
+        channels = other.channels;
+        layerCount = other.layerCount;
+        levelCount = other.levelCount;
+        sampling = other.sampling;
+        other.ID = 0;
+    }
+    return *this;
+}
+
+// Create the texture and allocate every layer of the full mip chain
+bool TextureArray::setup()
+{
+    GLenum format = formatForChannels(channels);
+    if (format == 0 || width <= 0 || height <= 0 || layerCount <= 0)
+    {
+        logError("Invalid layout: " + std::to_string(width) + "x" + std::to_string(height) + ", "
+                 + std::to_string(channels) + " channels, " + std::to_string(layerCount) + " layers");
+        return false;
+    }
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (layerCount > maxLayers)
+    {
+        logError(std::to_string(layerCount) + " layers exceed GL_MAX_ARRAY_TEXTURE_LAYERS (" + std::to_string(maxLayers) + ")");
+        return false;
+    }
+
+    if (ID == 0) {
+        glGenTextures(1, &ID);
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, ID);
+
+    sampling.apply(GL_TEXTURE_2D_ARRAY, true);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    // GL 4.1 has no glTexStorage3D: allocate each level explicitly (every layer at once)
+    for (int level = 0; level < levelCount; level++)
+    {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, std::max(width >> level, 1), std::max(height >> level, 1),
+                     layerCount, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+// Check that an image and its mips fit a layer
+bool TextureArray::checkLayer(int layer, const Image& image, std::span<const Image> mipLevels) const
+{
+    if (ID == 0)
+    {
+        logError("Attempted to upload a layer before setup().");
+        return false;
+    }
+    if (layer < 0 || layer >= layerCount)
+    {
+        logError("Layer " + std::to_string(layer) + " out of range for " + image.source);
+        return false;
+    }
+    if (image.width != width || image.height != height || image.channels != channels)
+    {
+        logError("Layer image " + image.source + " does not match the array layout");
+        return false;
+    }
+    if (!mipLevels.empty() && static_cast<int>(mipLevels.size()) != levelCount - 1)
+    {
+        logError("Incomplete mip chain for " + image.source);
+        return false;
+    }
+    return true;
+}
+
+// Upload one layer
+bool TextureArray::uploadLayer(int layer, const Image& image, std::span<const Image> mipLevels)
+{
+    if (!checkLayer(layer, image, mipLevels)) {
+        return false;
+    }
+
+    GLenum format = formatForChannels(channels);
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, ID);
+    // Rows are tightly packed, which breaks the default 4-byte alignment for RGB/RED widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, image.pixels.data());
+    for (size_t i = 0; i < mipLevels.size(); i++)
+    {
+        const Image& level = mipLevels[i];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(i + 1), 0, 0, layer, level.width, level.height, 1,
+                        format, GL_UNSIGNED_BYTE, level.pixels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+// Queue one layer on a TextureStreamer
+bool TextureArray::streamLayer(int layer, const Image& image, std::span<const Image> mipLevels, TextureStreamer& streamer,
+                               std::shared_ptr<const void> keepAlive, std::function<void()> onComplete)
+{
+    if (!checkLayer(layer, image, mipLevels)) {
+        return false;
+    }
+    if (static_cast<int>(mipLevels.size()) != levelCount - 1)
+    {
+        logError("Streamed layers need their mip chain (" + image.source + ")");
+        return false;
+    }
+
+    TextureStreamer::Upload upload;
+    upload.texture = ID;
+    upload.bindTarget = GL_TEXTURE_2D_ARRAY;
+    upload.format = formatForChannels(channels);
+    upload.channels = channels;
+    upload.regions.push_back({ GL_TEXTURE_2D_ARRAY, 0, image.width, image.height, image.pixels.data(), layer });
+    for (size_t i = 0; i < mipLevels.size(); i++)
+    {
+        const Image& level = mipLevels[i];
+        upload.regions.push_back({ GL_TEXTURE_2D_ARRAY, static_cast<GLint>(i + 1), level.width, level.height,
+                                  level.pixels.data(), layer });
+    }
+    upload.keepAlive = std::move(keepAlive);
+    upload.onComplete = std::move(onComplete);
+    streamer.enqueue(std::move(upload));
+    return true;
+}
+
+// Rebuild the mip chain of every layer on the GPU
+void TextureArray::generateMipmaps()
+{
+    if (ID == 0) {
+        return;
+    }
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, ID);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// Bind the array to a specific texture unit
+void TextureArray::bind(GLuint textureUnit) const
+{
+    if (ID != 0)
+    {
+        RenderState::bindTexture(textureUnit, GL_TEXTURE_2D_ARRAY, ID);
+    }
+    else
+    {
+        logError("Attempted to bind an invalid texture array.");
+    }
+}
+
+void TextureArray::unbind(GLuint textureUnit) const
+{
+    RenderState::bindTexture(textureUnit, GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// Bytes of GPU memory taken by all layers and levels
+size_t TextureArray::getGpuMemoryBytes() const
+{
+    if (ID == 0) {
+        return 0;
+    }
+    size_t bytes = 0;
+    for (int level = 0; level < levelCount; level++)
+    {
+        bytes += static_cast<size_t>(std::max(width >> level, 1)) * std::max(height >> level, 1) * channels;
+    }
+    return bytes * layerCount;
+}
+
+// Utility function for reporting errors
+void TextureArray::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::TEXTUREARRAY::" << message << std::endl;
+}
@@ -0,0 +1,97 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <glad/gl.h>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <iostream>
+
+#include "Image.h"   // For the layer images
+#include "Texture.h" // For TextureSampling
+
+class TextureStreamer;
+
+// A GL_TEXTURE_2D_ARRAY: many same-size, same-format images in one texture object.
+// Shaders pick the image with a layer index (sampler2DArray, texture(s, vec3(uv, layer))),
+// so draws that only differ by texture can share one binding and be merged into one
+// instanced draw with a per-instance layer (see Mesh::setTextureArray).
+class TextureArray
+{
+public:
+    // Constructor: Stores the layer size, channel count (1, 3 or 4) and number of layers.
+    // Does NOT create the OpenGL texture.
+    TextureArray(int width, int height, int channels, int layerCount, const TextureSampling& sampling = TextureSampling());
+
+    // Destructor: Deletes the OpenGL texture object.
+    ~TextureArray();
+
+    // Prevent copying (textures are not copyable)
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    // Allow moving (transfer ownership)
+    TextureArray(TextureArray&& other) noexcept;
+    TextureArray& operator=(TextureArray&& other) noexcept;
+
+    // Method to create the OpenGL texture and allocate every layer of the full mip chain.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure (e.g. more layers than GL_MAX_ARRAY_TEXTURE_LAYERS).
+    bool setup();
+
+    // Upload one layer. The image must match the array's size and channel count.
+    // mipLevels are levels 1..N (e.g. from MipGenerator::generate); if empty, only level 0 is
+    // uploaded and generateMipmaps() must be called once all layers are in.
+    // Returns true on success, false on failure.
+    bool uploadLayer(int layer, const Image& image, std::span<const Image> mipLevels = {});
+
+    // Queue one layer (level 0 and mipLevels, which are required) on a TextureStreamer instead,
+    // so it arrives over the following frames under the streamer's byte budget.
+    // keepAlive must own the pixels until onComplete runs (on the GL thread, once the last row is in).
+    // Returns false (and queues nothing) if the layer does not fit the array.
+    bool streamLayer(int layer, const Image& image, std::span<const Image> mipLevels, TextureStreamer& streamer,
+                     std::shared_ptr<const void> keepAlive, std::function<void()> onComplete = {});
+
+    // Rebuild the mip chain of every layer from level 0 on the GPU
+    void generateMipmaps();
+
+    // Bind the array to a specific texture unit.
+    // Only safe to call if isValid() is true.
+    void bind(GLuint textureUnit = 0) const;
+
+    // Unbinds the array from a specific texture unit
+    void unbind(GLuint textureUnit = 0) const;
+
+    // Check if the texture was created successfully.
+    bool isValid() const { return ID != 0; }
+
+    // Get the OpenGL texture ID.
+    GLuint getID() const { return ID; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChannels() const { return channels; }
+    int getLayerCount() const { return layerCount; }
+    int getLevelCount() const { return levelCount; }
+
+    // Bytes of GPU memory taken by all layers and levels
+    size_t getGpuMemoryBytes() const;
+
+private:
+    GLuint ID = 0; // The OpenGL texture ID (0 indicates invalid/not created)
+    int width;
+    int height;
+    int channels;
+    int layerCount;
+    int levelCount; // Full chain down to 1x1
+    TextureSampling sampling;
+
+    // Check that an image and its mips fit a layer, reporting the problem if not
+    bool checkLayer(int layer, const Image& image, std::span<const Image> mipLevels) const;
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // TEXTUREARRAY_H
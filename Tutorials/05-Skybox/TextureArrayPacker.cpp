@@ -0,0 +1,190 @@
+#include "TextureArrayPacker.h"
+
+#include <algorithm> // For std::min
+#include <chrono>    // For polling the decode jobs
+#include <iostream>  // For the summary
+#include <map>       // For grouping by layout
+#include <set>       // For hasSharedLayout
+#include <tuple>     // For the group key
+
+#include "ImageDecoder.h"
+#include "TextureStreamer.h"
+
+// Constructor: Stores the sampling and layer limit
+TextureArrayPacker::TextureArrayPacker(const TextureSampling& sampling, int maxLayersPerArray)
+: sampling(sampling), maxLayersPerArray(maxLayersPerArray)
+{
+}
+
+// Decode and pack the files, blocking until done
+bool TextureArrayPacker::pack(const std::vector<std::string>& filePaths, TextureLoader& loader)
+{
+    if (!isReady())
+    {
+        std::cerr << "ERROR::TEXTUREARRAYPACKER::A pack is already in progress." << std::endl;
+        return false;
+    }
+    packAsync(filePaths, loader, nullptr);
+    for (PackedImage& job : jobs) {
+        job.decoded.wait();
+    }
+    update();
+    return allPacked;
+}
+
+// Start decoding the files through the loader
+void TextureArrayPacker::packAsync(const std::vector<std::string>& filePaths, TextureLoader& loader, TextureStreamer* streamer)
+{
+    if (!isReady())
+    {
+        std::cerr << "ERROR::TEXTUREARRAYPACKER::A pack is already in progress." << std::endl;
+        return;
+    }
+    this->streamer = streamer;
+    allPacked = true;
+
+    // Decode every file and filter its mip chain on the loader's workers, joining the decode
+    // of any texture loading from the same file
+    jobs.reserve(filePaths.size());
+    for (const std::string& filePath : filePaths) {
+        jobs.push_back({ filePath, loader.decodeShared(filePath) });
+    }
+}
+
+// Check if at least two files share a size and channel count
+bool TextureArrayPacker::hasSharedLayout(const std::vector<std::string>& filePaths)
+{
+    std::set<std::tuple<int, int, int>> layouts;
+    for (const std::string& filePath : filePaths)
+    {
+        int width = 0, height = 0, channels = 0;
+        if (!ImageDecoder::readInfo(filePath, width, height, channels)) {
+            continue; // Would fail to pack anyway
+        }
+        // Decoding for upload expands grey-alpha to RGBA (see DecodeTarget::UPLOADABLE)
+        if (channels == 2) {
+            channels = 4;
+        }
+        if (!layouts.insert({ width, height, channels }).second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Advance an asynchronous pack
+bool TextureArrayPacker::update()
+{
+    if (!jobs.empty())
+    {
+        // The layout of an array is only known once all of its images are, so wait for every decode
+        for (PackedImage& job : jobs)
+        {
+            if (job.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return false;
+            }
+        }
+        createArrays();
+    }
+    return pendingLayers == 0;
+}
+
+// Group the decoded images into arrays and upload or queue their layers
+void TextureArrayPacker::createArrays()
+{
+    // 1. Group by layout (width, height, channels), keeping the input order within a group.
+    // The decodes are shared, so a streamed layer keeps its pixels alive until it is uploaded
+    struct Decoded
+    {
+        std::string filePath;
+        std::shared_ptr<const DecodedImage> pixels;
+    };
+    std::map<std::tuple<int, int, int>, std::vector<Decoded>> groups;
+    for (PackedImage& job : jobs)
+    {
+        Decoded packed = { job.filePath, job.decoded.get() };
+        if (!packed.pixels->image.isValid())
+        {
+            allPacked = false; // Error already printed by decode
+            continue;
+        }
+        const Image& image = packed.pixels->image;
+        groups[std::make_tuple(image.width, image.height, image.channels)].push_back(std::move(packed));
+    }
+    jobs.clear();
+
+    GLint layerLimit = maxLayersPerArray;
+    if (layerLimit <= 0) {
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layerLimit);
+    }
+
+    // 2. One array per group (or several if the group exceeds the layer limit)
+    for (auto& [layout, images] : groups)
+    {
+        const auto [width, height, channels] = layout;
+        for (size_t first = 0; first < images.size(); first += layerLimit)
+        {
+            int layerCount = static_cast<int>(std::min(images.size() - first, static_cast<size_t>(layerLimit)));
+            auto array = std::make_unique<TextureArray>(width, height, channels, layerCount, sampling);
+            if (!array->setup())
+            {
+                allPacked = false;
+                continue;
+            }
+            for (int layer = 0; layer < layerCount; layer++)
+            {
+                const Decoded& packed = images[first + layer];
+                MaterialLayer material = { array.get(), layer };
+                if (streamer == nullptr)
+                {
+                    if (array->uploadLayer(layer, packed.pixels->image, packed.pixels->mipLevels)) {
+                        materials[packed.filePath] = material;
+                    } else {
+                        allPacked = false;
+                    }
+                    continue;
+                }
+
+                // The material becomes visible to find() only once its last mip level has arrived
+                auto onComplete = [this, filePath = packed.filePath, material]() {
+                    materials[filePath] = material;
+                    pendingLayers--;
+                };
+                if (array->streamLayer(layer, packed.pixels->image, packed.pixels->mipLevels, *streamer, packed.pixels, std::move(onComplete))) {
+                    pendingLayers++;
+                } else {
+                    allPacked = false;
+                }
+            }
+            arrays.push_back(std::move(array));
+        }
+    }
+}
+
+// Get the array and layer of a packed file
+MaterialLayer TextureArrayPacker::find(const std::string& filePath) const
+{
+    auto found = materials.find(filePath);
+    return found != materials.end() ? found->second : MaterialLayer();
+}
+
+// Bytes of GPU memory taken by all arrays
+size_t TextureArrayPacker::getGpuMemoryBytes() const
+{
+    size_t bytes = 0;
+    for (const std::unique_ptr<TextureArray>& array : arrays) {
+        bytes += array->getGpuMemoryBytes();
+    }
+    return bytes;
+}
+
+// Print one line per array
+void TextureArrayPacker::printSummary() const
+{
+    std::cout << "Material library: " << materials.size() << " textures in " << arrays.size() << " arrays" << std::endl;
+    for (const std::unique_ptr<TextureArray>& array : arrays)
+    {
+        std::cout << "  " << array->getWidth() << "x" << array->getHeight() << " x" << array->getChannels()
+                  << ": " << array->getLayerCount() << " layers, " << array->getGpuMemoryBytes() / 1024 << " KB" << std::endl;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef TEXTUREARRAYPACKER_H
+#define TEXTUREARRAYPACKER_H
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureArray.h"
+#include "TextureLoader.h"
+
+class TextureStreamer;
+
+// Where a packed texture lives: an array and a layer in it
+struct MaterialLayer
+{
+    TextureArray* array = nullptr;
+    int layer = -1;
+
+    bool isValid() const { return array != nullptr; }
+};
+
+// A library file and its (possibly still running) decode
+struct PackedImage
+{
+    std::string filePath;
+    SharedDecode decoded;
+};
+
+// Packs a material library into texture arrays.
+// The image files are decoded (with their mip chains) through a TextureLoader, so a file that
+// is also loading as a texture is decoded once for both; the images are grouped by
+// size and channel count, and each group becomes one GL_TEXTURE_2D_ARRAY (split when it
+// exceeds the layer limit). Materials are then looked up by file path.
+// Meshes using materials of the same array can be drawn together with one binding,
+// passing each instance's layer (see Mesh::drawInstanced).
+//
+// packAsync() + update() keep the GL thread free while packing: the files decode in the
+// background, and once all are in, the layers go through a TextureStreamer so they share
+// its per-frame byte budget with every other texture upload. A material is only returned
+// by find() once its layer has fully arrived, so callers draw a placeholder until then.
+class TextureArrayPacker
+{
+public:
+    // Constructor: Stores the sampling for the arrays and the maximum layers per array
+    // (0 = GL_MAX_ARRAY_TEXTURE_LAYERS). Does NOT load anything.
+    explicit TextureArrayPacker(const TextureSampling& sampling = TextureSampling(), int maxLayersPerArray = 0);
+
+    // Prevent copying (materials point at the owned arrays)
+    TextureArrayPacker(const TextureArrayPacker&) = delete;
+    TextureArrayPacker& operator=(const TextureArrayPacker&) = delete;
+
+    // Decode and pack the files, blocking until done. Can be called more than once; each call
+    // adds new arrays. Files that fail to decode are reported and skipped.
+    // Must be called on the GL thread (not on a pool worker). Returns true if every file was packed.
+    bool pack(const std::vector<std::string>& filePaths, TextureLoader& loader);
+
+    // Start decoding the files through loader and return immediately. update() creates the
+    // arrays once every file is decoded and fills their layers through streamer (or directly
+    // if it is null, which blocks for the upload). Ignored while a previous pack is in progress.
+    // The streamer must outlive the pack.
+    void packAsync(const std::vector<std::string>& filePaths, TextureLoader& loader, TextureStreamer* streamer = nullptr);
+
+    // Check if packing the files would batch anything: at least two of them share a size and
+    // channel count, so they would land in one array. Reads only the file headers.
+    static bool hasSharedLayout(const std::vector<std::string>& filePaths);
+
+    // Advance an asynchronous pack. Call once per frame on the GL thread.
+    // Returns true once the pack has finished (every layer uploaded or failed).
+    bool update();
+
+    // Check if no pack is in progress
+    bool isReady() const { return jobs.empty() && pendingLayers == 0; }
+
+    // Check if every file of the last pack was packed
+    bool succeeded() const { return allPacked; }
+
+    // Get the array and layer of a packed file (invalid if the file was not packed)
+    MaterialLayer find(const std::string& filePath) const;
+
+    // The arrays created so far
+    const std::vector<std::unique_ptr<TextureArray>>& getArrays() const { return arrays; }
+
+    // Bytes of GPU memory taken by all arrays
+    size_t getGpuMemoryBytes() const;
+
+    // Print one line per array (size, channels, layers, memory)
+    void printSummary() const;
+
+private:
+    TextureSampling sampling;
+    int maxLayersPerArray;
+    std::vector<std::unique_ptr<TextureArray>> arrays;
+    std::unordered_map<std::string, MaterialLayer> materials; // By file path
+
+    // Asynchronous pack in progress
+    std::vector<PackedImage> jobs;              // Decodes not yet grouped
+    TextureStreamer* streamer = nullptr;
+    size_t pendingLayers = 0;                   // Layers queued on the streamer, not yet complete
+    bool allPacked = true;
+
+    // Group the decoded images into arrays and upload or queue their layers
+    void createArrays();
+};
+
+#endif // TEXTUREARRAYPACKER_H
@@ -0,0 +1,261 @@
+#include "TextureCache.h"
+
+#include <algorithm>  // For std::any_of
+#include <filesystem> // For resolving paths
+#include <functional> // For std::hash
+#include <iostream>   // For error reporting
+
+// ---------------------------------------------------------------------------
+// Handle
+// ---------------------------------------------------------------------------
+
+TextureCache::Handle::Handle(TextureCache* cache, Entry* entry)
+: cache(cache), entry(entry)
+{
+    cache->addReference(entry);
+}
+
+TextureCache::Handle::Handle(const Handle& other)
+: cache(other.cache), entry(other.entry)
+{
+    if (entry) {
+        cache->addReference(entry);
+    }
+}
+
+TextureCache::Handle& TextureCache::Handle::operator=(const Handle& other)
+{
+    if (this != &other)
+    {
+        // Take the new reference first, in case both handles share the entry
+        if (other.entry) {
+            other.cache->addReference(other.entry);
+        }
+        reset();
+        cache = other.cache;
+        entry = other.entry;
+    }
+    return *this;
+}
+
+TextureCache::Handle::Handle(Handle&& other) noexcept
+: cache(other.cache), entry(other.entry)
+{
+    other.cache = nullptr;
+    other.entry = nullptr;
+}
+
+TextureCache::Handle& TextureCache::Handle::operator=(Handle&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        cache = other.cache;
+        entry = other.entry;
+        other.cache = nullptr;
+        other.entry = nullptr;
+    }
+    return *this;
+}
+
+// Drop this reference
+void TextureCache::Handle::reset()
+{
+    if (entry) {
+        cache->releaseReference(entry);
+    }
+    cache = nullptr;
+    entry = nullptr;
+}
+
+Texture* TextureCache::Handle::get() const
+{
+    return entry ? &entry->texture : nullptr;
+}
+
+bool TextureCache::Handle::isReady() const
+{
+    return entry && entry->load.isReady();
+}
+
+bool TextureCache::Handle::succeeded() const
+{
+    return entry && entry->load.succeeded();
+}
+
+// ---------------------------------------------------------------------------
+// TextureCache
+// ---------------------------------------------------------------------------
+
+size_t TextureCache::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = std::hash<std::string>()(key.path);
+    for (GLenum value : { key.sampling.wrapS, key.sampling.wrapT, key.sampling.minFilter, key.sampling.magFilter }) {
+        hash ^= std::hash<GLenum>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+// Constructor: Stores the budget and loader
+TextureCache::TextureCache(size_t budgetBytes, TextureLoader* loader)
+: budgetBytes(budgetBytes), loader(loader)
+{
+}
+
+// Destructor: Deletes all textures
+TextureCache::~TextureCache()
+{
+    size_t referenced = entries.size() - unused.size();
+    if (referenced > 0) {
+        std::cerr << "WARNING::TEXTURECACHE::DESTROYED_WITH_LIVE_HANDLES " << referenced << " textures" << std::endl;
+    }
+    // Loads still in flight (decoding or streaming) refer to their Texture: finish them before deleting it
+    bool loading = std::any_of(entries.begin(), entries.end(), [](const auto& entry) { return !entry.second->load.isReady(); });
+    if (loader && loading) {
+        loader->finishAll();
+    }
+    if (loader)
+    {
+        for (auto& [key, entry] : entries) {
+            loader->forget(&entry->texture);
+        }
+    }
+}
+
+// Get the canonical form of a path
+std::string TextureCache::resolvePath(const std::string& filePath)
+{
+    std::error_code error;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(filePath, error);
+    return error ? filePath : resolved.string();
+}
+
+// Get the texture for a file with the given sampling
+TextureCache::Handle TextureCache::acquire(const std::string& filePath, const TextureSampling& sampling)
+{
+    Key key { resolvePath(filePath), sampling };
+    auto found = entries.find(key);
+    if (found != entries.end())
+    {
+        stats.hits++;
+        return Handle(this, found->second.get());
+    }
+
+    stats.misses++;
+    auto entry = std::make_unique<Entry>(key, filePath);
+    if (loader)
+    {
+        entry->load = loader->load(&entry->texture);
+    }
+    else
+    {
+        if (!entry->texture.load())
+        {
+            std::cerr << "ERROR::TEXTURECACHE::ACQUIRE::LOAD_FAILED " << filePath << std::endl;
+            return Handle();
+        }
+        std::promise<bool> loaded;
+        loaded.set_value(true);
+        entry->load.texture = &entry->texture;
+        entry->load.result = loaded.get_future().share();
+    }
+
+    Entry* added = entry.get();
+    entries.emplace(key, std::move(entry));
+    // A new entry starts unreferenced like any other, so the handle's reference
+    // takes it out of the unused list through the usual path
+    added->unusedPosition = unused.insert(unused.end(), added);
+    Handle handle(this, added);
+    trim(); // The new texture may push older unused ones out
+    return handle;
+}
+
+// Reference counting
+void TextureCache::addReference(Entry* entry)
+{
+    if (entry->refCount++ == 0) {
+        unused.erase(entry->unusedPosition);
+    }
+}
+
+void TextureCache::releaseReference(Entry* entry)
+{
+    if (--entry->refCount == 0)
+    {
+        // Most recently used goes to the back
+        entry->unusedPosition = unused.insert(unused.end(), entry);
+        trim();
+    }
+}
+
+// Delete an unreferenced texture
+void TextureCache::evict(Entry* entry)
+{
+    unused.erase(entry->unusedPosition);
+    stats.evictions++;
+    if (loader) {
+        loader->forget(&entry->texture);
+    }
+    Key key = entry->key; // Copied: erasing destroys the entry holding it
+    entries.erase(key);   // Destroys the Texture (and its GL object)
+}
+
+// Evict least recently used textures until under budget
+unsigned int TextureCache::trim()
+{
+    unsigned int evicted = 0;
+    size_t resident = getResidentBytes();
+    for (auto it = unused.begin(); it != unused.end() && resident > budgetBytes; )
+    {
+        Entry* entry = *it++;
+        // A texture still loading is referenced by its TextureLoader job
+        if (!entry->load.isReady()) {
+            continue;
+        }
+        resident -= entry->texture.getGpuMemoryBytes();
+        evict(entry);
+        evicted++;
+    }
+
+    bool overBudget = resident > budgetBytes;
+    if (overBudget && !overBudgetReported)
+    {
+        std::cerr << "WARNING::TEXTURECACHE::OVER_BUDGET " << resident << " bytes resident, budget "
+                  << budgetBytes << " (all remaining textures are in use)" << std::endl;
+    }
+    overBudgetReported = overBudget;
+    return evicted;
+}
+
+// Delete every unreferenced texture
+unsigned int TextureCache::evictUnused()
+{
+    unsigned int evicted = 0;
+    for (auto it = unused.begin(); it != unused.end(); )
+    {
+        Entry* entry = *it++;
+        if (entry->load.isReady())
+        {
+            evict(entry);
+            evicted++;
+        }
+    }
+    return evicted;
+}
+
+// Change the budget
+void TextureCache::setBudget(size_t newBudgetBytes)
+{
+    budgetBytes = newBudgetBytes;
+    trim();
+}
+
+// Bytes of GPU memory taken by all cached textures
+size_t TextureCache::getResidentBytes() const
+{
+    size_t total = 0;
+    for (const auto& [key, entry] : entries) {
+        total += entry->texture.getGpuMemoryBytes();
+    }
+    return total;
+}
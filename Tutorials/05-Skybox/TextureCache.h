@@ -0,0 +1,156 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Texture.h"
+#include "TextureLoader.h"
+
+// Shares Texture objects between their users, so a file sampled the same way is
+// decoded and uploaded only once however many meshes use it.
+//
+// Textures are keyed by their resolved (canonical) path plus their sampling, and
+// handed out as refcounted handles. When the last handle of a texture goes away the
+// texture stays resident, so acquiring it again is free, but becomes evictable:
+// whenever the resident GPU bytes exceed the budget, unreferenced textures are
+// deleted least-recently-used first. Referenced textures are never evicted, so the
+// budget can be exceeded while everything resident is in use.
+//
+// All methods must be called on the GL thread. The cache must outlive its handles.
+class TextureCache
+{
+private:
+    struct Entry; // Defined below, needed by Handle
+
+public:
+    // Refcounted reference to a cached texture. Copying shares the reference;
+    // destroying (or resetting) the last handle makes the texture evictable.
+    class Handle
+    {
+    public:
+        Handle() = default;
+        ~Handle() { reset(); }
+
+        Handle(const Handle& other);
+        Handle& operator=(const Handle& other);
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+
+        // Drop this reference (the handle becomes empty)
+        void reset();
+
+        // Get the texture (nullptr for an empty handle)
+        Texture* get() const;
+        Texture* operator->() const { return get(); }
+
+        // Check if the handle refers to a texture
+        bool isValid() const { return entry != nullptr; }
+
+        // Check if loading has finished (successfully or not), without blocking
+        bool isReady() const;
+
+        // Check if the texture finished loading successfully, without blocking
+        bool succeeded() const;
+
+    private:
+        friend class TextureCache;
+        Handle(TextureCache* cache, Entry* entry);
+
+        TextureCache* cache = nullptr;
+        Entry* entry = nullptr;
+    };
+
+    // Cache statistics
+    struct Stats
+    {
+        uint64_t hits = 0;      // acquire() calls served from the cache
+        uint64_t misses = 0;    // acquire() calls that loaded a texture
+        uint64_t evictions = 0; // Textures deleted to stay under the budget
+    };
+
+    // Constructor: Stores the budget (in bytes of GPU memory) and the loader used for new textures.
+    // Without a loader, textures are loaded synchronously in acquire().
+    explicit TextureCache(size_t budgetBytes = 256u << 20, TextureLoader* loader = nullptr);
+
+    // Destructor: Deletes all textures (warns if handles are still held).
+    ~TextureCache();
+
+    // Prevent copying (handles point into the cache)
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Get the texture for a file with the given sampling, loading it on the first request.
+    // Returns an empty handle if a synchronous load fails.
+    Handle acquire(const std::string& filePath, const TextureSampling& sampling = TextureSampling());
+
+    // Evict unreferenced textures, least recently used first, until the resident bytes fit the budget.
+    // Called automatically on acquire() and release; call it after uploads finish as well, since
+    // asynchronously loaded textures only reach their full size once uploaded.
+    // Returns the number of textures evicted.
+    unsigned int trim();
+
+    // Delete every unreferenced texture regardless of the budget. Returns the number evicted.
+    unsigned int evictUnused();
+
+    // Change the budget (trims immediately)
+    void setBudget(size_t budgetBytes);
+    size_t getBudget() const { return budgetBytes; }
+
+    // Bytes of GPU memory taken by all cached textures
+    size_t getResidentBytes() const;
+
+    // Number of cached textures, and of those without handles
+    size_t getTextureCount() const { return entries.size(); }
+    size_t getUnusedCount() const { return unused.size(); }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Cache key: resolved path + sampling
+    struct Key
+    {
+        std::string path;
+        TextureSampling sampling;
+
+        bool operator==(const Key& other) const { return path == other.path && sampling == other.sampling; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Texture texture;
+        TextureLoadHandle load;             // Ready once decoded and uploaded
+        unsigned int refCount = 0;
+        std::list<Entry*>::iterator unusedPosition; // Position in unused (valid while refCount == 0)
+
+        Entry(const Key& key, const std::string& filePath) : key(key), texture(filePath, key.sampling) {}
+    };
+
+    size_t budgetBytes;
+    TextureLoader* loader;
+    std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> entries;
+    std::list<Entry*> unused; // Textures without handles, least recently used first
+    Stats stats;
+    bool overBudgetReported = false; // Warn once each time the budget cannot be met
+
+    // Reference counting (called by Handle)
+    void addReference(Entry* entry);
+    void releaseReference(Entry* entry);
+
+    // Delete an unreferenced texture
+    void evict(Entry* entry);
+
+    // Get the canonical form of a path, so different spellings of one file share an entry
+    static std::string resolvePath(const std::string& filePath);
+};
+
+#endif // TEXTURECACHE_H
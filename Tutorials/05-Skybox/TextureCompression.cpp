@@ -0,0 +1,153 @@
+#include "TextureCompression.h"
+
+#include <algorithm> // For std::find
+#include <cstring>   // For std::strcmp
+#include <iostream>  // For printing the support list
+
+std::vector<GLenum> TextureCompression::supportedFormats;
+bool TextureCompression::queried = false;
+
+// Helper function to fill supportedFormats from the context
+void TextureCompression::querySupport()
+{
+    queried = true;
+    supportedFormats.clear();
+
+    // 1. Formats the driver lists explicitly
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+    if (count > 0)
+    {
+        std::vector<GLint> formats(count);
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        for (GLint format : formats)
+        {
+            supportedFormats.push_back(static_cast<GLenum>(format));
+        }
+    }
+
+    // 2. RGTC (BC4/BC5) is core since 3.0, but drivers are not required to list it
+    supportedFormats.push_back(GL_COMPRESSED_RED_RGTC1);
+    supportedFormats.push_back(GL_COMPRESSED_RG_RGTC2);
+
+    // 3. Extensions; some drivers only advertise the formats through these
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (!extension) {
+            continue;
+        }
+        if (std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+        {
+            supportedFormats.insert(supportedFormats.end(), {
+                GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+                GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT });
+        }
+        else if (std::strcmp(extension, "GL_EXT_texture_sRGB") == 0)
+        {
+            supportedFormats.insert(supportedFormats.end(), {
+                GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT });
+        }
+        else if (std::strcmp(extension, "GL_ARB_texture_compression_bptc") == 0)
+        {
+            supportedFormats.insert(supportedFormats.end(), {
+                GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM });
+        }
+        else if (std::strcmp(extension, "GL_ARB_ES3_compatibility") == 0)
+        {
+            supportedFormats.insert(supportedFormats.end(), {
+                GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_SRGB8_ETC2,
+                GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC });
+        }
+    }
+}
+
+// Check if the current context accepts this format
+bool TextureCompression::isSupported(GLenum internalFormat)
+{
+    if (!queried) {
+        querySupport();
+    }
+    return std::find(supportedFormats.begin(), supportedFormats.end(), internalFormat) != supportedFormats.end();
+}
+
+// Bytes per 4x4 block
+unsigned int TextureCompression::getBlockBytes(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+        // 4 bits per pixel
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return 8;
+        // 8 bits per pixel
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+// Size in bytes of one mip level
+size_t TextureCompression::getLevelSize(GLenum internalFormat, int width, int height)
+{
+    // Partial blocks at the edges still take a whole block
+    size_t blocksX = std::max(1, (width + 3) / 4);
+    size_t blocksY = std::max(1, (height + 3) / 4);
+    return blocksX * blocksY * getBlockBytes(internalFormat);
+}
+
+// Short name for messages
+const char* TextureCompression::getFormatName(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:        return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:       return "BC1 RGBA";
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:       return "BC1 sRGB";
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:       return "BC2";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:       return "BC3";
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return "BC3 sRGB";
+        case GL_COMPRESSED_RED_RGTC1:                return "BC4";
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:         return "BC4 signed";
+        case GL_COMPRESSED_RG_RGTC2:                 return "BC5";
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:          return "BC5 signed";
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:          return "BC7";
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:    return "BC7 sRGB";
+        case GL_COMPRESSED_RGB8_ETC2:                return "ETC2 RGB";
+        case GL_COMPRESSED_SRGB8_ETC2:               return "ETC2 sRGB";
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:           return "ETC2 RGBA";
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:    return "ETC2 sRGB RGBA";
+        default:                                     return "unknown";
+    }
+}
+
+// Print the compressed formats the context supports
+void TextureCompression::printSupport()
+{
+    static const GLenum formats[] = {
+        GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RED_RGTC1,
+        GL_COMPRESSED_RG_RGTC2, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_RGBA8_ETC2_EAC
+    };
+    std::cout << "Compressed texture formats:";
+    for (GLenum format : formats)
+    {
+        std::cout << " " << getFormatName(format) << (isSupported(format) ? " (yes)" : " (no)");
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,64 @@
+#ifndef TEXTURECOMPRESSION_H
+#define TEXTURECOMPRESSION_H
+
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+// Block-compressed formats not in the core 4.1 header (they come from extensions,
+// or from later core versions, so the loader only has the RGTC ones)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0          // BC1
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1         // BC1 with 1-bit alpha
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2         // BC2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3         // BC3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C         // BC1 sRGB
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F   // BC3 sRGB
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C            // BC7
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D      // BC7 sRGB
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+
+// Information about the block-compressed texture formats, and which ones the
+// current OpenGL context can sample. All formats use 4x4 pixel blocks.
+class TextureCompression
+{
+public:
+    // Check if the current context accepts this format in glCompressedTexImage2D.
+    // Queried once on first use (needs a current context), then cached.
+    static bool isSupported(GLenum internalFormat);
+
+    // Bytes per 4x4 block (8 or 16), or 0 if the format is not a known compressed format
+    static unsigned int getBlockBytes(GLenum internalFormat);
+
+    // Size in bytes of one mip level of the given dimensions
+    static size_t getLevelSize(GLenum internalFormat, int width, int height);
+
+    // Short name for messages, e.g. "BC1", "BC7", "ETC2 RGBA"
+    static const char* getFormatName(GLenum internalFormat);
+
+    // Print the compressed formats the context supports (for diagnostics)
+    static void printSupport();
+
+private:
+    // Formats reported by the context (filled on first use)
+    static std::vector<GLenum> supportedFormats;
+    static bool queried;
+
+    // Helper function to fill supportedFormats from the context's format list and extensions
+    static void querySupport();
+
+    // Private constructor to prevent instantiation (it's a static utility class)
+    TextureCompression() = delete;
+};
+
+#endif // TEXTURECOMPRESSION_H
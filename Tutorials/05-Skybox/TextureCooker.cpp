@@ -0,0 +1,155 @@
+#include "TextureCooker.h"
+
+#include <algorithm>  // For std::min, std::max
+#include <cctype>     // For std::tolower
+#include <chrono>     // For measuring encode throughput
+#include <filesystem> // For listing the texture directory
+#include <iomanip>    // For formatting the report
+#include <iostream>   // For printing the report
+
+#include "MipGenerator.h"       // For the mip chain
+#include "ImageDecoder.h"       // For decoding the source image
+#include "TextureCompression.h" // For the KTX format enums and names
+
+// Cook one image file into a KTX file
+bool TextureCooker::cookFile(const std::string& sourcePath, const std::string& outputPath, bool flipVertically,
+                             bool compareReference, Report& report, ThreadPool& pool)
+{
+    report = Report();
+    report.source = sourcePath;
+
+    DecodeOptions decodeOptions;
+    decodeOptions.flipVertically = flipVertically;
+    Image image = ImageDecoder::decode(sourcePath, decodeOptions);
+    if (!image.isValid()) {
+        return false; // Error already printed by decode
+    }
+
+    const bool hasAlpha = image.channels == 2 || image.channels == 4;
+    const BlockCompressor::Format format = hasAlpha ? BlockCompressor::Format::BC3 : BlockCompressor::Format::BC1;
+
+    CompressedImage cooked;
+    // The fast encoder always writes 4-color blocks, so BC1 output is opaque
+    cooked.internalFormat = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    cooked.width = image.width;
+    cooked.height = image.height;
+    cooked.faceCount = 1;
+    cooked.source = outputPath;
+
+    // Filter the whole chain first (gamma-correct Kaiser), then encode every level down to 1x1
+    std::vector<Image> mipLevels = MipGenerator::generate(image, MipOptions(), &pool);
+    size_t pixelCount = 0;
+    for (int levelIndex = 0; levelIndex <= static_cast<int>(mipLevels.size()); levelIndex++)
+    {
+        const Image& level = levelIndex == 0 ? image : mipLevels[levelIndex - 1];
+        auto encodeStart = std::chrono::steady_clock::now();
+        std::vector<uint8_t> blocks = BlockCompressor::compressImage(level, format, BlockCompressor::Quality::FAST, &pool);
+        std::chrono::duration<double, std::milli> encodeTime = std::chrono::steady_clock::now() - encodeStart;
+        report.encodeMs += encodeTime.count();
+        pixelCount += static_cast<size_t>(level.width) * level.height;
+
+        if (levelIndex == 0)
+        {
+            Image decoded = BlockCompressor::decompressImage(blocks, format, level.width, level.height);
+            report.psnr = BlockCompressor::computePSNR(level, decoded);
+        }
+
+        cooked.surfaces.push_back({ 0, levelIndex, level.width, level.height, cooked.data.size(), blocks.size() });
+        cooked.data.insert(cooked.data.end(), blocks.begin(), blocks.end());
+        cooked.levelCount = levelIndex + 1;
+    }
+
+    if (!cooked.saveKTX(outputPath)) {
+        return false;
+    }
+
+    report.width = image.width;
+    report.height = image.height;
+    report.levelCount = cooked.levelCount;
+    report.formatName = TextureCompression::getFormatName(cooked.internalFormat);
+    report.uncompressedBytes = pixelCount * 4;
+    report.compressedBytes = cooked.getCompressedBytes();
+    report.megapixelsPerSecond = report.encodeMs > 0.0 ? pixelCount / (report.encodeMs * 1000.0) : 0.0;
+    report.threadCount = pool.getThreadCount();
+
+    if (compareReference)
+    {
+        auto referenceStart = std::chrono::steady_clock::now();
+        std::vector<uint8_t> blocks = BlockCompressor::compressImage(image, format, BlockCompressor::Quality::REFERENCE, &pool);
+        std::chrono::duration<double, std::milli> referenceTime = std::chrono::steady_clock::now() - referenceStart;
+        Image decoded = BlockCompressor::decompressImage(blocks, format, image.width, image.height);
+        report.referencePsnr = BlockCompressor::computePSNR(image, decoded);
+        report.referenceMegapixelsPerSecond = static_cast<double>(image.width) * image.height / (referenceTime.count() * 1000.0);
+    }
+    return true;
+}
+
+// Cook every image under a directory
+int TextureCooker::cookDirectory(const std::string& directory, const std::string& outputDirectory, bool compareReference)
+{
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator files(directory, error);
+    if (error)
+    {
+        std::cerr << "ERROR::TEXTURECOOKER::Cannot open directory: " << directory << std::endl;
+        return 1;
+    }
+
+    std::cout << "Cooking textures in " << directory << " with " << BlockCompressor::getInstructionSet() << " on "
+              << ThreadPool::shared().getThreadCount() << " worker threads" << std::endl;
+    int failures = 0, skipped = 0;
+    double totalMs = 0.0;
+    for (const std::filesystem::directory_entry& entry : files)
+    {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (!entry.is_regular_file() || (extension != ".jpg" && extension != ".jpeg" && extension != ".png" && extension != ".tga")) {
+            continue;
+        }
+
+        std::filesystem::path outputPath = entry.path();
+        if (!outputDirectory.empty()) {
+            outputPath = std::filesystem::path(outputDirectory) / std::filesystem::relative(entry.path(), directory);
+        }
+        outputPath.replace_extension(".ktx");
+
+        // Leave outputs that are newer than their source
+        std::filesystem::file_time_type outputTime = std::filesystem::last_write_time(outputPath, error);
+        if (!error && outputTime >= entry.last_write_time())
+        {
+            skipped++;
+            continue;
+        }
+        std::filesystem::create_directories(outputPath.parent_path(), error);
+
+        // Cubemap faces are sampled unflipped (see CubeTexture::load)
+        bool flip = entry.path().filename().string().rfind("skybox_", 0) != 0;
+
+        Report report;
+        if (!cookFile(entry.path().string(), outputPath.string(), flip, compareReference, report))
+        {
+            failures++;
+            continue;
+        }
+        printReport(report);
+        totalMs += report.encodeMs;
+    }
+    std::cout << "Cooking done: " << failures << " failures, " << skipped << " up to date, " << totalMs << " ms encoding" << std::endl;
+    return failures;
+}
+
+// Print a one-line summary of a report
+void TextureCooker::printReport(const Report& report)
+{
+    std::cout << std::fixed << std::setprecision(2)
+              << report.source << ": " << report.formatName << " " << report.width << "x" << report.height
+              << ", " << report.levelCount << " levels, " << report.uncompressedBytes / 1024 << " KB -> "
+              << report.compressedBytes / 1024 << " KB, " << report.megapixelsPerSecond << " MP/s on "
+              << report.threadCount << " threads, PSNR " << report.psnr << " dB";
+    if (report.referenceMegapixelsPerSecond > 0.0)
+    {
+        // The reference is this project's own slower encoder, so this compares the two, not against a third party
+        std::cout << " (PCA reference " << report.referenceMegapixelsPerSecond << " MP/s, PSNR " << report.referencePsnr << " dB)";
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
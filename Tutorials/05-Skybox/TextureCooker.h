@@ -0,0 +1,61 @@
+#ifndef TEXTURECOOKER_H
+#define TEXTURECOOKER_H
+
+#include <string>
+
+#include "BlockCompressor.h"
+#include "CompressedImage.h"
+#include "ThreadPool.h"
+
+// Turns image files into block-compressed KTX files with a full mip chain, using the
+// CPU BlockCompressor (no OpenGL, so it runs on build machines without a GPU).
+// Images without alpha become BC1, images with alpha become BC3.
+// The 05-Skybox target runs it over every tutorial's Assets as a build phase ("Cook Textures"),
+// writing next to the copied assets; outputs newer than their source are skipped.
+// The tutorial loads the .ktx names, falling back to the images when a file is missing
+// or its format cannot be sampled (see Texture::getFallbackPath).
+class TextureCooker
+{
+public:
+    // Results of cooking one file
+    struct Report
+    {
+        std::string source;
+        int width = 0;
+        int height = 0;
+        int levelCount = 0;
+        const char* formatName = "";
+        size_t uncompressedBytes = 0;        // RGBA8, all levels
+        size_t compressedBytes = 0;          // All levels
+        double encodeMs = 0.0;               // Fast encoder, all levels (wall time, all pool threads)
+        double megapixelsPerSecond = 0.0;    // Fast encoder throughput over threadCount threads
+        double psnr = 0.0;                   // Fast encoder quality against the source (level 0, dB)
+        double referenceMegapixelsPerSecond = 0.0; // Reference (PCA) encoder throughput over threadCount threads (level 0)
+        double referencePsnr = 0.0;          // Reference (PCA) encoder quality against the source (level 0, dB)
+        unsigned int threadCount = 1;        // Threads the encoders ran on
+    };
+
+    // Cook one image file into a KTX file.
+    // flipVertically must match how the file is sampled: true for Texture, false for CubeTexture faces.
+    // compareReference also encodes level 0 with the reference encoder, for the report.
+    // Returns true on success; errors will be printed to cerr.
+    static bool cookFile(const std::string& sourcePath, const std::string& outputPath, bool flipVertically,
+                         bool compareReference, Report& report, ThreadPool& pool = ThreadPool::shared());
+
+    // Cook every .jpg / .jpeg / .png / .tga under a directory (recursively) into a .ktx at the
+    // same relative path under outputDirectory (next to the source if it is empty).
+    // Files named "skybox_*" are cubemap faces and are not flipped. Outputs newer than their
+    // source are left alone, so running it on every build only cooks what changed.
+    // Prints one report line per file. Returns the number of files that failed.
+    // compareReference is off by default: the reference encoder is about 10x slower than the fast one.
+    static int cookDirectory(const std::string& directory, const std::string& outputDirectory = "", bool compareReference = false);
+
+    // Print a one-line summary of a report
+    static void printReport(const Report& report);
+
+private:
+    // Private constructor to prevent instantiation (it's a static utility class)
+    TextureCooker() = delete;
+};
+
+#endif // TEXTURECOOKER_H
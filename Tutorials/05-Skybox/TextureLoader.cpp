@@ -0,0 +1,217 @@
+#include "TextureLoader.h"
+
+#include <chrono>     // For the upload time budget
+#include <filesystem> // For resolving shared decode paths
+#include <iostream>   // For error reporting
+
+#include "Texture.h"
+#include "MipGenerator.h"
+#include "ImageDecoder.h"
+#include "TextureStreamer.h"
+#include "MipResidency.h"
+
+// Check if loading has finished, without blocking
+bool TextureLoadHandle::isReady() const
+{
+    return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Constructor: Stores the pool used for decoding
+TextureLoader::TextureLoader(ThreadPool& pool, TextureStreamer* streamer, MipResidency* residency)
+: pool(pool), streamer(streamer), residency(residency)
+{
+}
+
+// Start loading a texture from its file path
+TextureLoadHandle TextureLoader::load(Texture* texture)
+{
+    TextureLoadHandle handle;
+    if (!texture)
+    {
+        std::cerr << "ERROR::TEXTURELOADER::LOAD::NULL_POINTER" << std::endl;
+        std::promise<bool> failed;
+        failed.set_value(false);
+        handle.result = failed.get_future().share();
+        return handle;
+    }
+
+    // Something to sample until the real image arrives
+    texture->createPlaceholder();
+
+    auto job = std::make_unique<Job>();
+    job->texture = texture;
+    // Copy the path: the worker must not touch the Texture object
+    std::string filePath = texture->getFilePath();
+    if (CompressedImage::isContainerFile(filePath))
+        job->compressed = pool.submit([filePath]() { return CompressedImage::loadFromFile(filePath); });
+    else
+        job->decoded = decodeShared(filePath);
+
+    handle.texture = texture;
+    handle.result = job->uploaded.get_future().share();
+    jobs.push_back(std::move(job));
+    return handle;
+}
+
+// Get the decoded pixels of an image file, sharing a decode already running or held
+SharedDecode TextureLoader::decodeShared(const std::string& filePath)
+{
+    pruneSharedDecodes();
+
+    // Different spellings of one file share a decode, as they share a TextureCache entry
+    std::error_code error;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(filePath, error);
+    std::string key = error ? filePath : resolved.string();
+
+    auto found = sharedDecodes.find(key);
+    if (found != sharedDecodes.end()) {
+        return found->second;
+    }
+    SharedDecode decoded = pool.submit([filePath]() {
+        return std::shared_ptr<const DecodedImage>(std::make_shared<DecodedImage>(decode(filePath)));
+    }).share();
+    sharedDecodes.emplace(std::move(key), decoded);
+    return decoded;
+}
+
+// Forget the finished decodes nobody holds any more
+void TextureLoader::pruneSharedDecodes()
+{
+    for (auto it = sharedDecodes.begin(); it != sharedDecodes.end(); )
+    {
+        // Once finished, the future's own copy is the only reference left when every user is done
+        bool finished = it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (finished && it->second.get().use_count() == 1) {
+            it = sharedDecodes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Decode an image file and filter its mip chain (runs on a worker)
+DecodedImage TextureLoader::decode(const std::string& filePath)
+{
+    DecodedImage result;
+    result.image = ImageDecoder::decode(filePath);
+    if (result.image.isValid())
+    {
+        // Already on a pool worker: filter inline (other textures keep the other workers busy)
+        result.mipLevels = MipGenerator::generate(result.image, MipOptions(), nullptr);
+    }
+    return result;
+}
+
+// Check if the worker has finished reading the file
+bool TextureLoader::Job::isDecoded() const
+{
+    const auto zero = std::chrono::seconds(0);
+    if (compressed.valid())
+        return compressed.wait_for(zero) == std::future_status::ready;
+    return decoded.wait_for(zero) == std::future_status::ready;
+}
+
+// Upload one decoded job on the GL thread
+bool TextureLoader::finishJob(Job& job)
+{
+    if (job.compressed.valid())
+    {
+        CompressedImage image = job.compressed.get();
+        if (image.isValid() && job.texture->upload(image))
+        {
+            job.uploaded.set_value(true);
+            return true;
+        }
+        
+        // Not readable or not supported by this context: decode the uncompressed original instead
+        std::string fallbackPath = Texture::getFallbackPath(job.texture->getFilePath());
+        if (fallbackPath.empty())
+        {
+            std::cerr << "ERROR::TEXTURELOADER::NO_FALLBACK_FOR " << job.texture->getFilePath() << std::endl;
+            job.uploaded.set_value(false);
+            return true;
+        }
+        std::cerr << "WARNING::TEXTURELOADER::USING_FALLBACK " << fallbackPath << std::endl;
+        job.decoded = decodeShared(fallbackPath);
+        return false;
+    }
+    
+    // The pixels may be shared with other users of the file, so they are only read here
+    std::shared_ptr<const DecodedImage> decoded = job.decoded.get();
+    job.decoded = SharedDecode(); // Our reference is the local one now
+    // On decode failure the placeholder stays in place (error already printed by decode)
+    if (!decoded->image.isValid())
+    {
+        job.uploaded.set_value(false);
+        return true;
+    }
+    if (residency)
+    {
+        // Only the coarse levels are uploaded now; the residency manager keeps (a copy of) the chain for the rest
+        job.uploaded.set_value(residency->add(job.texture, decoded->image, decoded->mipLevels));
+        return true;
+    }
+    if (streamer)
+    {
+        // The streamer holds the pixels until the last row is in, then fulfils the promise
+        auto uploaded = std::make_shared<std::promise<bool>>(std::move(job.uploaded));
+        if (!job.texture->stream(decoded->image, decoded->mipLevels, decoded, *streamer, [uploaded]() { uploaded->set_value(true); })) {
+            uploaded->set_value(false);
+        }
+        return true;
+    }
+    job.uploaded.set_value(job.texture->upload(decoded->image, decoded->mipLevels));
+    return true;
+}
+
+// Upload decoded images under a time budget
+unsigned int TextureLoader::processUploads(double budgetMs)
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned int finished = 0;
+
+    for (auto it = jobs.begin(); it != jobs.end(); )
+    {
+        // Stop once the budget is spent (but always make progress by finishing one)
+        std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - start;
+        if (finished > 0 && spent.count() >= budgetMs) {
+            break;
+        }
+
+        // Skip images still decoding; later ones may already be done
+        if (!(*it)->isDecoded() || !finishJob(**it))
+        {
+            ++it;
+            continue;
+        }
+
+        it = jobs.erase(it);
+        finished++;
+    }
+    // Free the pixels of decodes whose last user (e.g. a streamed upload) has finished
+    pruneSharedDecodes();
+    return finished;
+}
+
+// Block until every pending texture is decoded and uploaded
+void TextureLoader::finishAll()
+{
+    for (std::unique_ptr<Job>& job : jobs)
+    {
+        // get() waits for the decode; a requeued fallback finishes on the second pass
+        while (!finishJob(*job)) {}
+    }
+    jobs.clear();
+    pruneSharedDecodes();
+    if (streamer) {
+        streamer->flush();
+    }
+}
+
+// Stop tracking a texture about to be destroyed
+void TextureLoader::forget(Texture* texture)
+{
+    if (residency) {
+        residency->remove(texture);
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Image.h"
+#include "CompressedImage.h"
+#include "ThreadPool.h"
+
+class Texture;
+class TextureStreamer;
+class MipResidency;
+
+// Handle to a texture that is loading in the background.
+// The future becomes ready once the image has been decoded AND uploaded,
+// holding true on success and false on failure.
+struct TextureLoadHandle
+{
+    Texture* texture = nullptr;
+    std::shared_future<bool> result;
+
+    // Check if loading has finished (successfully or not), without blocking
+    bool isReady() const;
+
+    // Check if the texture finished loading successfully, without blocking
+    bool succeeded() const { return isReady() && result.get(); }
+};
+
+// A decoded image file and its mip levels 1..N
+struct DecodedImage
+{
+    Image image;
+    std::vector<Image> mipLevels;
+};
+
+// A decode that may still be running, shared by everyone who needs the file's pixels
+using SharedDecode = std::shared_future<std::shared_ptr<const DecodedImage>>;
+
+// Loads textures in two stages:
+//  1. Decode: ImageDecoder::decode() and MipGenerator::generate() run on the thread pool,
+//     producing a CPU Image with its mip chain (KTX / DDS files are read into a
+//     CompressedImage instead, with the mips stored in the file).
+//  2. Upload: the GL thread calls processUploads() once per frame, which uploads
+//     decoded images until the frame's time budget is spent. With a TextureStreamer,
+//     decoded images are handed to it instead and arrive over the following frames
+//     under its byte budget (the handle becomes ready once the last row is in).
+//     With a MipResidency, only the coarse levels are uploaded and it streams the
+//     finer ones in as the camera gets close (the handle becomes ready at once).
+// Each texture gets a 1x1 placeholder immediately, so it can be bound and drawn
+// while loading. Decodes are shared by file: other users of the pixels (e.g.
+// TextureArrayPacker) join the decode of a texture loading from the same file
+// through decodeShared() instead of decoding it again. Decoding runs on all workers at once, so startup time scales
+// with the number of cores instead of the number of textures.
+class TextureLoader
+{
+public:
+    // Constructor: Uses the given pool for decoding (the shared pool by default),
+    // the streamer for uploads and the residency manager for mip levels if given
+    // (they must outlive the loads).
+    explicit TextureLoader(ThreadPool& pool = ThreadPool::shared(), TextureStreamer* streamer = nullptr,
+                           MipResidency* residency = nullptr);
+
+    // Prevent copying (pending jobs refer to their Texture)
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Start loading a texture from its file path. The texture must outlive the load.
+    // Must be called on the GL thread (it creates the placeholder).
+    TextureLoadHandle load(Texture* texture);
+
+    // Get the decoded pixels (and mip chain) of an image file: joins the decode already
+    // running or still held for the same file, otherwise starts one on the pool.
+    // Must be called on the GL thread. The result is invalid (empty image) on failure.
+    SharedDecode decodeShared(const std::string& filePath);
+
+    // Upload decoded images, stopping once budgetMs milliseconds have been spent.
+    // At least one ready image is uploaded per call so loading always progresses.
+    // Also frees shared decodes nobody holds any more, so keep calling it once per frame even
+    // when no texture is pending. Must be called on the GL thread. Returns the number of textures finished.
+    unsigned int processUploads(double budgetMs);
+
+    // Block until every pending texture is decoded and uploaded (e.g. before a benchmark).
+    void finishAll();
+
+    // Stop tracking a texture about to be destroyed (e.g. unregister it from the residency manager).
+    // Its load must have finished.
+    void forget(Texture* texture);
+
+    // Number of textures still decoding or waiting for upload
+    size_t getPendingCount() const { return jobs.size(); }
+
+private:
+    struct Job
+    {
+        Texture* texture = nullptr;
+        SharedDecode decoded;                    // Set for image files (and compressed fallbacks)
+        std::future<CompressedImage> compressed; // Set for KTX / DDS files
+        std::promise<bool> uploaded;
+
+        // Check if the worker has finished reading the file
+        bool isDecoded() const;
+    };
+
+    ThreadPool& pool;
+    TextureStreamer* streamer;
+    MipResidency* residency;
+    std::vector<std::unique_ptr<Job>> jobs; // In submission order
+    std::unordered_map<std::string, SharedDecode> sharedDecodes; // By resolved path, while running or held
+
+    // Decode an image file and filter its mip chain (runs on a worker)
+    static DecodedImage decode(const std::string& filePath);
+
+    // Forget the finished decodes nobody holds any more
+    void pruneSharedDecodes();
+
+    // Upload one decoded job on the GL thread and fulfil its promise.
+    // Returns false if the job was requeued to decode its uncompressed fallback instead.
+    bool finishJob(Job& job);
+};
+
+#endif // TEXTURELOADER_H
@@ -0,0 +1,274 @@
+#include "TextureStreamer.h"
+
+#include <algorithm> // For std::min
+#include <chrono>    // For timing fence waits
+#include <cstring>   // For std::memcpy
+
+#include "RenderState.h"
+
+// Longest time update() blocks on a fence before falling back to orphaning (1 second)
+static constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000ull;
+
+// Offsets of pieces in the PBO are rounded up to this, so the driver can copy aligned rows
+static constexpr size_t PIECE_ALIGNMENT = 16;
+
+// Constructor: Stores the budget
+TextureStreamer::TextureStreamer(size_t frameBudgetBytes)
+: frameBudgetBytes(frameBudgetBytes)
+{
+    // The PBO ring is created in the setup() method.
+}
+
+// Destructor: Deletes the fences and the buffer
+TextureStreamer::~TextureStreamer()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+    if (PBO != 0) {
+        glDeleteBuffers(1, &PBO);
+    }
+}
+
+// Size of one ring segment in bytes
+size_t TextureStreamer::segmentBytes() const
+{
+    return (frameBudgetBytes + PIECE_ALIGNMENT - 1) & ~(PIECE_ALIGNMENT - 1);
+}
+
+// Create the PBO ring
+bool TextureStreamer::setup()
+{
+    if (frameBudgetBytes < PIECE_ALIGNMENT)
+    {
+        logError("SETUP::Frame budget of " + std::to_string(frameBudgetBytes) + " bytes is too small.");
+        return false;
+    }
+    if (PBO == 0) {
+        glGenBuffers(1, &PBO);
+    }
+    if (PBO == 0)
+    {
+        logError("SETUP::Failed to generate the pixel unpack buffer.");
+        return false;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+    // Allocate every segment up front; the contents are written by update()
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, segmentBytes() * SEGMENT_COUNT, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    currentSegment = SEGMENT_COUNT - 1; // The first update() writes segment 0
+    stats = Stats();
+    return true;
+}
+
+// Queue an upload
+void TextureStreamer::enqueue(Upload upload)
+{
+    // Zero-sized regions have nothing to stream (and would stall the row splitting)
+    std::erase_if(upload.regions, [](const Region& region) { return region.width <= 0 || region.height <= 0 || !region.pixels; });
+    pending.push_back(std::move(upload));
+}
+
+// Block until the GPU has finished reading the given segment
+bool TextureStreamer::waitForSegment(unsigned int segment)
+{
+    GLsync& fence = fences[segment];
+    if (!fence) {
+        return true; // Nothing pending
+    }
+
+    // Fast path: the GPU is already done with it
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        // The CPU is SEGMENT_COUNT frames ahead: wait, and record that we did
+        auto waitStart = std::chrono::steady_clock::now();
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+        stats.fenceWaits++;
+        stats.fenceWaitMs += waited.count();
+    }
+
+    glDeleteSync(fence);
+    fence = 0;
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+// Copy sub-rectangles into the mapped segment until the budget is used
+unsigned int TextureStreamer::fillSegment(unsigned char* mapped, size_t segmentOffset, size_t budget)
+{
+    size_t used = 0;   // Bytes of the segment taken, including alignment padding
+    size_t copied = 0; // Bytes of pixels copied
+    size_t uploadIndex = 0;
+    while (uploadIndex < pending.size())
+    {
+        const Upload& upload = pending[uploadIndex];
+        if (cursor.region >= upload.regions.size())
+        {
+            // Every region of this upload is in: move on to the next one
+            uploadIndex++;
+            cursor = Cursor();
+            continue;
+        }
+
+        const Region& region = upload.regions[cursor.region];
+        const size_t pixelBytes = static_cast<size_t>(upload.channels);
+        const size_t rowBytes = region.width * pixelBytes;
+        used = (used + PIECE_ALIGNMENT - 1) & ~(PIECE_ALIGNMENT - 1); // Segments start aligned
+        const size_t space = used < budget ? budget - used : 0;
+
+        Piece piece = { uploadIndex, cursor.region, 0, cursor.row, region.width, 0, segmentOffset + used };
+        if (rowBytes <= budget)
+        {
+            // A band of whole rows: contiguous in the source, one copy
+            int rows = static_cast<int>(std::min<size_t>(region.height - cursor.row, space / rowBytes));
+            if (rows == 0) {
+                break; // Segment full
+            }
+            std::memcpy(mapped + used, region.pixels + cursor.row * rowBytes, rows * rowBytes);
+            piece.height = rows;
+            used += rows * rowBytes;
+            copied += rows * rowBytes;
+            cursor.row += rows;
+        }
+        else
+        {
+            // A single row is larger than the budget: stream it in pieces
+            int columns = static_cast<int>(std::min<size_t>(region.width - cursor.column, space / pixelBytes));
+            if (columns == 0) {
+                break; // Segment full
+            }
+            std::memcpy(mapped + used, region.pixels + cursor.row * rowBytes + cursor.column * pixelBytes, columns * pixelBytes);
+            piece.x = cursor.column;
+            piece.width = columns;
+            piece.height = 1;
+            used += columns * pixelBytes;
+            copied += columns * pixelBytes;
+            cursor.column += columns;
+            if (cursor.column == region.width)
+            {
+                cursor.column = 0;
+                cursor.row++;
+            }
+        }
+        pieces.push_back(piece);
+
+        if (cursor.row >= region.height)
+        {
+            cursor.region++;
+            cursor.row = 0;
+        }
+    }
+
+    stats.bytesThisFrame = copied;
+    return static_cast<unsigned int>(uploadIndex);
+}
+
+// Stream up to the frame budget of queued pixels
+unsigned int TextureStreamer::update()
+{
+    stats.bytesThisFrame = 0;
+    if (PBO == 0 || pending.empty()) {
+        return 0;
+    }
+
+    currentSegment = (currentSegment + 1) % SEGMENT_COUNT;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+
+    if (!waitForSegment(currentSegment))
+    {
+        // Fallback: new storage, so no pending upload is affected, and no fence applies any more
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, segmentBytes() * SEGMENT_COUNT, nullptr, GL_STREAM_DRAW);
+        for (GLsync& fence : fences)
+        {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        }
+    }
+
+    // No synchronization by the driver: the fence above guarantees the GPU is not reading this range
+    const size_t segmentOffset = currentSegment * segmentBytes();
+    unsigned char* mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(segmentOffset),
+        static_cast<GLsizeiptr>(frameBudgetBytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    if (!mapped)
+    {
+        logError("UPDATE::Failed to map the pixel unpack buffer.");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return 0;
+    }
+
+    const Cursor start = cursor;
+    pieces.clear();
+    unsigned int finished = fillSegment(mapped, segmentOffset, frameBudgetBytes);
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+    {
+        // The storage was lost while mapped (rare): stream the same pieces again next frame
+        cursor = start;
+        stats.bytesThisFrame = 0;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return 0;
+    }
+
+    // With a PBO bound, the pixels argument is an offset into it
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const Piece& piece : pieces)
+    {
+        const Upload& upload = pending[piece.upload];
+        const Region& region = upload.regions[piece.region];
+        RenderState::bindTexture(0, upload.bindTarget, upload.texture);
+        if (region.target == GL_TEXTURE_2D_ARRAY)
+        {
+            glTexSubImage3D(region.target, region.level, piece.x, piece.y, region.layer, piece.width, piece.height, 1,
+                            upload.format, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(piece.offset));
+        }
+        else
+        {
+            glTexSubImage2D(region.target, region.level, piece.x, piece.y, piece.width, piece.height,
+                            upload.format, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(piece.offset));
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    fences[currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    stats.subImages += static_cast<unsigned int>(pieces.size());
+    stats.totalBytes += stats.bytesThisFrame;
+
+    // Completed uploads leave the queue before their callback runs (it may enqueue more)
+    for (unsigned int i = 0; i < finished; i++)
+    {
+        Upload upload = std::move(pending.front());
+        pending.pop_front();
+        RenderState::bindTexture(0, upload.bindTarget, 0);
+        stats.completed++;
+        if (upload.onComplete) {
+            upload.onComplete();
+        }
+    }
+    return finished;
+}
+
+// Stream everything queued, ignoring the budget
+void TextureStreamer::flush()
+{
+    while (!pending.empty())
+    {
+        if (update() == 0 && stats.bytesThisFrame == 0) {
+            break; // No progress (not set up, or the buffer cannot be mapped): errors already printed
+        }
+    }
+}
+
+// Utility function for reporting errors
+void TextureStreamer::logError(const std::string& message) const
+{
+    std::cerr << "ERROR::TEXTURESTREAMER::" << message << std::endl;
+}
@@ -0,0 +1,147 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <glad/gl.h>
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Streams texture uploads through pixel unpack buffers under a per-frame byte budget.
+//
+// glTexImage2D from client memory copies synchronously, so one large image can stall a
+// frame. Instead, uploads are queued here and update() (once per frame) copies at most
+// frameBudgetBytes of pixels into the next segment of a PBO ring, then issues
+// glTexSubImage2D calls (glTexSubImage3D for array layers) that read from the PBO, which
+// the driver can overlap with rendering.
+// Large images are split into sub-rectangles (bands of rows, or pieces of a row if a single
+// row exceeds the budget), so an image of any size spreads over as many frames as it needs.
+//
+// As in DynamicMesh, the ring has SEGMENT_COUNT segments, written with
+// GL_MAP_UNSYNCHRONIZED_BIT and reused only once the fence after their uploads has signaled.
+class TextureStreamer
+{
+public:
+    // Number of ring segments (frames the CPU may be ahead of the GPU, plus one)
+    static constexpr unsigned int SEGMENT_COUNT = 3;
+
+    // One image of the upload: a mip level of a 2D texture, of one cubemap face or of one array layer
+    struct Region
+    {
+        GLenum target = GL_TEXTURE_2D; // GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face or GL_TEXTURE_2D_ARRAY
+        GLint level = 0;
+        int width = 0;
+        int height = 0;
+        const unsigned char* pixels = nullptr; // Tightly packed rows
+        GLint layer = 0;                       // Layer of a GL_TEXTURE_2D_ARRAY (ignored otherwise)
+    };
+
+    // A queued upload. The texture storage must already be allocated (e.g. glTexImage2D with nullptr).
+    struct Upload
+    {
+        GLuint texture = 0;
+        GLenum bindTarget = GL_TEXTURE_2D; // GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP or GL_TEXTURE_2D_ARRAY
+        GLenum format = GL_RGBA;           // GL_RED, GL_RGB or GL_RGBA (unsigned bytes)
+        int channels = 4;
+        std::vector<Region> regions;
+        std::shared_ptr<const void> keepAlive; // Owns the pixels until the upload completes
+        std::function<void()> onComplete;      // Called on the GL thread after the last sub-rectangle
+    };
+
+    // Upload metrics, to check the budget keeps frames smooth
+    struct Stats
+    {
+        size_t bytesThisFrame = 0;     // Bytes streamed by the last update()
+        size_t totalBytes = 0;         // Bytes streamed since setup()
+        unsigned int subImages = 0;    // glTexSubImage2D / 3D calls since setup()
+        unsigned int completed = 0;    // Uploads finished since setup()
+        unsigned int fenceWaits = 0;   // Updates that found their segment still in use by the GPU
+        double fenceWaitMs = 0.0;      // Total time spent blocked on those fences
+    };
+
+    // Constructor: Stores the per-frame budget (also the size of one ring segment).
+    // Does NOT create the OpenGL buffer.
+    explicit TextureStreamer(size_t frameBudgetBytes = 4u << 20);
+
+    // Destructor: Deletes the fences and the buffer. Pending uploads are dropped.
+    ~TextureStreamer();
+
+    // Prevent copying (owns OpenGL objects, pending callbacks refer to their textures)
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Create the PBO ring.
+    // Must be called AFTER a valid OpenGL context has been made current.
+    // Returns true on success, false on failure.
+    bool setup();
+
+    // Queue an upload. Must be called on the GL thread.
+    void enqueue(Upload upload);
+
+    // Stream up to the frame budget of queued pixels (at least one sub-rectangle, so uploads
+    // always progress). Call once per frame on the GL thread. Returns the number of uploads completed.
+    unsigned int update();
+
+    // Stream everything queued, ignoring the budget (e.g. before a benchmark or at shutdown)
+    void flush();
+
+    // Number of uploads not yet completed
+    size_t getPendingCount() const { return pending.size(); }
+
+    // Get the per-frame budget in bytes
+    size_t getFrameBudget() const { return frameBudgetBytes; }
+
+    // Get the upload metrics
+    const Stats& getStats() const { return stats; }
+
+    // Check if the streamer was set up successfully
+    bool isValid() const { return PBO != 0; }
+
+private:
+    // Progress through the first queued upload
+    struct Cursor
+    {
+        size_t region = 0; // Region being streamed
+        int row = 0;       // First row not yet streamed
+        int column = 0;    // First pixel of that row not yet streamed (when rows are split)
+    };
+
+    // A sub-rectangle copied into the current segment, waiting for its glTexSubImage2D
+    struct Piece
+    {
+        size_t upload;     // Index into pending
+        size_t region;
+        int x, y, width, height;
+        size_t offset;     // Byte offset into the PBO
+    };
+
+    size_t frameBudgetBytes;
+    GLuint PBO = 0;
+    std::deque<Upload> pending;
+    Cursor cursor;
+
+    unsigned int currentSegment = 0;
+    std::array<GLsync, SEGMENT_COUNT> fences = {};
+    std::vector<Piece> pieces; // Scratch, kept to avoid per-frame allocations
+
+    Stats stats;
+
+    // Size of one ring segment in bytes: the budget, rounded up so every segment starts aligned
+    size_t segmentBytes() const;
+
+    // Copy sub-rectangles into the mapped segment until budget bytes are used; records them in pieces.
+    // Returns the number of uploads whose last piece was copied.
+    unsigned int fillSegment(unsigned char* mapped, size_t segmentOffset, size_t budget);
+
+    // Block until the GPU has finished reading the given segment. Returns false on timeout.
+    bool waitForSegment(unsigned int segment);
+
+    // Utility function for reporting errors
+    void logError(const std::string& message) const;
+};
+
+#endif // TEXTURESTREAMER_H
@@ -0,0 +1,57 @@
+#include "ThreadPool.h"
+
+#include <algorithm> // For std::max
+
+// Constructor: Starts the worker threads
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    threadCount = std::max(threadCount, 1u);
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+// Destructor: Finishes the queued jobs, then joins the workers
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// Worker thread body
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return; // Stopping, and nothing left to run
+            }
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        // Run outside the lock so other workers can pick up jobs meanwhile.
+        // Exceptions are captured by the packaged_task into the job's future.
+        job();
+    }
+}
+
+// Pool shared by the whole application
+ThreadPool& ThreadPool::shared()
+{
+    // hardware_concurrency() may return 0 when unknown
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return pool;
+}
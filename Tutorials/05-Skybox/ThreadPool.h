@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of worker threads running queued jobs in FIFO order.
+// Used for CPU-side work that must not block the GL thread (image decoding, etc.).
+// Jobs must NOT make OpenGL calls: the context is only current on the main thread.
+class ThreadPool
+{
+public:
+    // Constructor: Starts threadCount workers (at least one).
+    explicit ThreadPool(unsigned int threadCount);
+
+    // Destructor: Finishes the queued jobs, then joins the workers.
+    ~ThreadPool();
+
+    // Prevent copying and moving (workers hold a pointer to the pool)
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a job. The returned future holds its result (or the exception it threw).
+    template <typename Function>
+    auto submit(Function&& job) -> std::future<std::invoke_result_t<std::decay_t<Function>>>;
+
+    // Number of worker threads
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+    // Pool shared by the whole application: one worker per core, leaving one for the GL thread.
+    // Created on first use.
+    static ThreadPool& shared();
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+
+    // Worker thread body: runs jobs until the pool is stopping and the queue is empty
+    void workerLoop();
+};
+
+// Queue a job and return a future for its result
+template <typename Function>
+auto ThreadPool::submit(Function&& job) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+{
+    using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+    // std::function needs a copyable callable, so the (move-only) task lives in a shared_ptr
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(job));
+    std::future<Result> result = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.emplace([task]() { (*task)(); });
+    }
+    jobAvailable.notify_one();
+    return result;
+}
+
+#endif // THREADPOOL_H
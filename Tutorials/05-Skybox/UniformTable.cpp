@@ -0,0 +1,77 @@
+#include "UniformTable.h"
+#include "Shader.h" // For Shader::hashName
+
+#include <algorithm> // For std::sort, std::lower_bound
+#include <string>
+#include <string_view>
+
+// Build the table by introspecting the linked program
+bool UniformTable::build(GLuint program)
+{
+    entries.clear();
+
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < uniformCount; i++)
+    {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &nameLength, &arraySize, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), nameLength);
+        GLint location = glGetUniformLocation(program, name.c_str());
+        if (location < 0)
+        {
+            continue; // Uniform block members have no location
+        }
+
+        // Arrays are reported as "name[0]"; register the base name as well
+        std::string_view baseName = name;
+        if (arraySize > 1 || baseName.ends_with("[0]"))
+        {
+            if (baseName.ends_with("[0]"))
+                baseName.remove_suffix(3);
+            entries.push_back({ Shader::hashName(baseName), location });
+            for (GLint element = 0; element < arraySize; element++)
+            {
+                std::string elementName = std::string(baseName) + "[" + std::to_string(element) + "]";
+                GLint elementLocation = glGetUniformLocation(program, elementName.c_str());
+                if (elementLocation >= 0)
+                    entries.push_back({ Shader::hashName(elementName), elementLocation });
+            }
+        }
+        else
+        {
+            entries.push_back({ Shader::hashName(name), location });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+    // Two distinct names hashing to the same value would silently alias each other
+    for (size_t i = 1; i < entries.size(); i++)
+    {
+        if (entries[i].hash == entries[i - 1].hash && entries[i].location != entries[i - 1].location)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Binary search of the table
+GLint UniformTable::find(uint32_t hash) const
+{
+    auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+                               [](const Entry& entry, uint32_t value) { return entry.hash < value; });
+    if (it != entries.end() && it->hash == hash)
+    {
+        return it->location;
+    }
+    return -1; // Not an active uniform (glUniform* ignores location -1)
+}
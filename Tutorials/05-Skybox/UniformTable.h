@@ -0,0 +1,36 @@
+#ifndef UNIFORMTABLE_H
+#define UNIFORMTABLE_H
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <vector>
+
+// Flat uniform location table of one linked program, sorted by name hash
+// (see Shader::hashName). Built once by introspecting the program with glGetActiveUniform,
+// so setting a uniform never asks the driver for its location.
+// Used by Shader (whole programs) and ShaderStage (separable single-stage programs).
+class UniformTable
+{
+public:
+    // Build the table from a linked program, replacing the previous contents.
+    // Array uniforms are registered both by their base name ("uLights") and per element ("uLights[1]").
+    // Returns false if two distinct names hash to the same value (they would alias each other).
+    bool build(GLuint program);
+
+    // Binary search of the table, returns -1 if not found (setting -1 is a no-op in OpenGL)
+    GLint find(uint32_t hash) const;
+
+    // Remove every entry
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry
+    {
+        uint32_t hash;
+        GLint location;
+    };
+    std::vector<Entry> entries;
+};
+
+#endif // UNIFORMTABLE_H
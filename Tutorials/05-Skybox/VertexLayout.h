@@ -0,0 +1,275 @@
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp> // For packHalf1x16, packUnorm1x16, packSnorm1x16
+
+#include <array>
+#include <cstdint>
+#include <cstring> // For std::memcpy
+#include <span>
+#include <type_traits>
+
+// Define a simple Vertex structure to hold common vertex attributes
+// This makes it easier to pass vertex data around.
+// This is the CPU-side format; a VertexLayout decides how it is stored on the GPU.
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+// Axis-aligned bounds of a mesh's positions, used to quantize positions to unorm16
+struct PositionBounds
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+};
+
+// --- Attribute formats -------------------------------------------------------
+// Each format describes how one Vertex attribute is stored in the GPU buffer:
+// SIZE bytes, read by glVertexAttribPointer(COMPONENTS, TYPE, NORMALIZED),
+// written by encode(). Sizes are multiples of 4 to keep attributes aligned.
+
+// 3 x float32 position (12 bytes)
+struct PositionFloat3
+{
+    static constexpr size_t SIZE = 12;
+    static constexpr GLint COMPONENTS = 3;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLboolean NORMALIZED = GL_FALSE;
+    static constexpr bool QUANTIZED = false;
+    static void encode(const glm::vec3& p, uint8_t* dst, const PositionBounds&) { std::memcpy(dst, &p, SIZE); }
+};
+
+// 3 x float16 position, padded to 4 (8 bytes). Exact up to ~2048 units, no dequantization needed.
+struct PositionHalf4
+{
+    static constexpr size_t SIZE = 8;
+    static constexpr GLint COMPONENTS = 3;
+    static constexpr GLenum TYPE = GL_HALF_FLOAT;
+    static constexpr GLboolean NORMALIZED = GL_FALSE;
+    static constexpr bool QUANTIZED = false;
+    static void encode(const glm::vec3& p, uint8_t* dst, const PositionBounds&)
+    {
+        uint16_t packed[4] = { glm::packHalf1x16(p.x), glm::packHalf1x16(p.y), glm::packHalf1x16(p.z), glm::packHalf1x16(1.0f) };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// 3 x unorm16 position relative to the mesh bounds, padded to 4 (8 bytes).
+// The shader sees [0, 1]; Mesh folds the bounds (the dequantization scale and offset) into the model matrix.
+struct PositionUnorm16x4
+{
+    static constexpr size_t SIZE = 8;
+    static constexpr GLint COMPONENTS = 3;
+    static constexpr GLenum TYPE = GL_UNSIGNED_SHORT;
+    static constexpr GLboolean NORMALIZED = GL_TRUE;
+    static constexpr bool QUANTIZED = true;
+    static void encode(const glm::vec3& p, uint8_t* dst, const PositionBounds& bounds)
+    {
+        glm::vec3 extent = glm::max(bounds.max - bounds.min, glm::vec3(1e-20f));
+        glm::vec3 t = (p - bounds.min) / extent;
+        uint16_t packed[4] = { glm::packUnorm1x16(t.x), glm::packUnorm1x16(t.y), glm::packUnorm1x16(t.z), 0xFFFF };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// 3 x float32 normal (12 bytes)
+struct NormalFloat3
+{
+    static constexpr size_t SIZE = 12;
+    static constexpr GLint COMPONENTS = 3;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLboolean NORMALIZED = GL_FALSE;
+    static void encode(const glm::vec3& n, uint8_t* dst) { std::memcpy(dst, &n, SIZE); }
+};
+
+// 3 x snorm8 normal, padded to 4 (4 bytes). Read directly as a vec3, no shader change needed.
+struct NormalSnorm8x4
+{
+    static constexpr size_t SIZE = 4;
+    static constexpr GLint COMPONENTS = 3;
+    static constexpr GLenum TYPE = GL_BYTE;
+    static constexpr GLboolean NORMALIZED = GL_TRUE;
+    static void encode(const glm::vec3& n, uint8_t* dst)
+    {
+        int8_t packed[4] = {
+            static_cast<int8_t>(glm::round(glm::clamp(n.x, -1.0f, 1.0f) * 127.0f)),
+            static_cast<int8_t>(glm::round(glm::clamp(n.y, -1.0f, 1.0f) * 127.0f)),
+            static_cast<int8_t>(glm::round(glm::clamp(n.z, -1.0f, 1.0f) * 127.0f)),
+            0
+        };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// Octahedral-encoded normal as 2 x snorm16 (4 bytes).
+// The vertex shader reads a vec2 and must decode it:
+//   vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+//   if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+//   n = normalize(n);
+struct NormalOctSnorm16x2
+{
+    static constexpr size_t SIZE = 4;
+    static constexpr GLint COMPONENTS = 2;
+    static constexpr GLenum TYPE = GL_SHORT;
+    static constexpr GLboolean NORMALIZED = GL_TRUE;
+    static void encode(const glm::vec3& n, uint8_t* dst)
+    {
+        float l1 = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+        glm::vec2 e = l1 > 0.0f ? glm::vec2(n.x, n.y) / l1 : glm::vec2(0.0f);
+        if (l1 > 0.0f && n.z < 0.0f)
+        {
+            // Fold the lower hemisphere over the diagonals
+            glm::vec2 signs(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+            e = (glm::vec2(1.0f) - glm::abs(glm::vec2(e.y, e.x))) * signs;
+        }
+        uint16_t packed[2] = { glm::packSnorm1x16(e.x), glm::packSnorm1x16(e.y) };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// 2 x float32 texture coordinates (8 bytes)
+struct TexCoordFloat2
+{
+    static constexpr size_t SIZE = 8;
+    static constexpr GLint COMPONENTS = 2;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLboolean NORMALIZED = GL_FALSE;
+    static void encode(const glm::vec2& uv, uint8_t* dst) { std::memcpy(dst, &uv, SIZE); }
+};
+
+// 2 x float16 texture coordinates (4 bytes). Supports tiling (UVs outside [0, 1]).
+struct TexCoordHalf2
+{
+    static constexpr size_t SIZE = 4;
+    static constexpr GLint COMPONENTS = 2;
+    static constexpr GLenum TYPE = GL_HALF_FLOAT;
+    static constexpr GLboolean NORMALIZED = GL_FALSE;
+    static void encode(const glm::vec2& uv, uint8_t* dst)
+    {
+        uint16_t packed[2] = { glm::packHalf1x16(uv.x), glm::packHalf1x16(uv.y) };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// 2 x unorm16 texture coordinates (4 bytes). UVs are clamped to [0, 1].
+struct TexCoordUnorm16x2
+{
+    static constexpr size_t SIZE = 4;
+    static constexpr GLint COMPONENTS = 2;
+    static constexpr GLenum TYPE = GL_UNSIGNED_SHORT;
+    static constexpr GLboolean NORMALIZED = GL_TRUE;
+    static void encode(const glm::vec2& uv, uint8_t* dst)
+    {
+        uint16_t packed[2] = { glm::packUnorm1x16(uv.x), glm::packUnorm1x16(uv.y) };
+        std::memcpy(dst, packed, SIZE);
+    }
+};
+
+// --- Layout descriptor -------------------------------------------------------
+
+// One vertex attribute as passed to glVertexAttribPointer
+struct VertexAttribute
+{
+    GLuint location;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    size_t offset;
+
+    bool operator==(const VertexAttribute&) const = default;
+};
+
+// Runtime description of a vertex layout, produced by VertexLayout<...>::describe().
+// Mesh uses it to encode its Vertex data and to set up the attribute pointers.
+struct VertexLayoutDesc
+{
+    GLsizei stride = 0;
+    std::array<VertexAttribute, 3> attributes = {}; // Position (0), normal (1), texture coordinates (2)
+    bool quantizedPositions = false; // Positions are relative to the mesh bounds (see PositionUnorm16x4)
+    bool native = true;              // Byte-identical to Vertex: upload without encoding
+
+    // Encode vertices into dst (vertices.size() * stride bytes). Unused for native layouts.
+    void (*encode)(std::span<const Vertex> vertices, uint8_t* dst, const PositionBounds& bounds) = nullptr;
+
+    // Two descriptors are the same layout when the GPU sees the same bytes (e.g. to share a VAO)
+    bool operator==(const VertexLayoutDesc& other) const
+    {
+        return stride == other.stride && attributes == other.attributes &&
+               quantizedPositions == other.quantizedPositions && native == other.native;
+    }
+
+    // Enable and point the attributes of the currently bound VAO at the currently bound GL_ARRAY_BUFFER
+    void apply() const
+    {
+        for (const VertexAttribute& attribute : attributes)
+        {
+            glEnableVertexAttribArray(attribute.location);
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized, stride, (void*)attribute.offset);
+        }
+    }
+};
+
+// Compile-time vertex layout built from one format per attribute.
+// Offsets and stride are computed at compile time; describe() turns the layout
+// into the runtime descriptor Mesh consumes.
+template <typename PositionFormat, typename NormalFormat, typename TexCoordFormat>
+struct VertexLayout
+{
+    static constexpr size_t POSITION_OFFSET = 0;
+    static constexpr size_t NORMAL_OFFSET = POSITION_OFFSET + PositionFormat::SIZE;
+    static constexpr size_t TEXCOORD_OFFSET = NORMAL_OFFSET + NormalFormat::SIZE;
+    static constexpr size_t STRIDE = TEXCOORD_OFFSET + TexCoordFormat::SIZE;
+
+    static constexpr bool NATIVE = std::is_same_v<PositionFormat, PositionFloat3> &&
+                                   std::is_same_v<NormalFormat, NormalFloat3> &&
+                                   std::is_same_v<TexCoordFormat, TexCoordFloat2>;
+
+    // Encode Vertex data into this layout
+    static void encode(std::span<const Vertex> vertices, uint8_t* dst, const PositionBounds& bounds);
+
+    // Runtime descriptor for this layout
+    static VertexLayoutDesc describe()
+    {
+        VertexLayoutDesc desc;
+        desc.stride = static_cast<GLsizei>(STRIDE);
+        desc.attributes = {{
+            { 0, PositionFormat::COMPONENTS, PositionFormat::TYPE, PositionFormat::NORMALIZED, POSITION_OFFSET },
+            { 1, NormalFormat::COMPONENTS, NormalFormat::TYPE, NormalFormat::NORMALIZED, NORMAL_OFFSET },
+            { 2, TexCoordFormat::COMPONENTS, TexCoordFormat::TYPE, TexCoordFormat::NORMALIZED, TEXCOORD_OFFSET },
+        }};
+        desc.quantizedPositions = PositionFormat::QUANTIZED;
+        desc.native = NATIVE;
+        desc.encode = &encode;
+        return desc;
+    }
+};
+
+// Encode Vertex data into this layout
+template <typename PositionFormat, typename NormalFormat, typename TexCoordFormat>
+void VertexLayout<PositionFormat, NormalFormat, TexCoordFormat>::encode(std::span<const Vertex> vertices, uint8_t* dst, const PositionBounds& bounds)
+{
+    for (const Vertex& vertex : vertices)
+    {
+        PositionFormat::encode(vertex.position, dst + POSITION_OFFSET, bounds);
+        NormalFormat::encode(vertex.normal, dst + NORMAL_OFFSET);
+        TexCoordFormat::encode(vertex.texCoords, dst + TEXCOORD_OFFSET);
+        dst += STRIDE;
+    }
+}
+
+// Full precision layout, byte-identical to Vertex (32 bytes)
+using StandardVertexLayout = VertexLayout<PositionFloat3, NormalFloat3, TexCoordFloat2>;
+
+// Quantized layout (16 bytes): unorm16 positions, octahedral normals, unorm16 UVs
+using CompactVertexLayout = VertexLayout<PositionUnorm16x4, NormalOctSnorm16x2, TexCoordUnorm16x2>;
+
+// Quantized layout that needs no shader changes (16 bytes): half positions, snorm8 normals, half UVs
+using HalfVertexLayout = VertexLayout<PositionHalf4, NormalSnorm8x4, TexCoordHalf2>;
+
+static_assert(StandardVertexLayout::STRIDE == sizeof(Vertex), "StandardVertexLayout must match Vertex");
+
+#endif // VERTEXLAYOUT_H
@@ -14,11 +14,29 @@
 #include "GLWindow.h"
 #include "FPSLimiter.h"
 #include "Shader.h"
+#include "ShaderBinaryCache.h"
+#include "ShaderBatch.h"
+#include "ShaderVariants.h"
+#include "ShaderStage.h"
+#include "ProgramPipeline.h"
+#include "ShaderPrewarmer.h"
 #include "Texture.h"
 #include "CubeTexture.h"
 #include "Mesh.h"
+#include "MeshPool.h"
+#include "MeshOptimizer.h"
 #include "Camera.h"
 #include "Skybox.h"
+#include "RenderState.h"
+#include "RenderQueue.h"
+#include "FrameUniforms.h"
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
+#include "MipResidency.h"
+#include "TextureCache.h"
+#include "TextureArrayPacker.h"
+#include "TextureCompression.h"
+#include "TextureCooker.h"
 
 #define WINDOW_WIDTH 1024
 #define WINDOW_HEIGHT 768
@@ -80,7 +98,7 @@ Mesh loadCube() {
     
     // Manually populate the vector
     for (int i = 0; i < NUM_VERTICES; ++i) {
-        Vertex vertex;
+        Vertex vertex = {}; // Zero-initialize (the normal is not in the raw data), so identical corners weld
         
         // Populate position (3 floats)
         vertex.position.x = cubeRawVertices[i * FLOATS_PER_VERTEX + 0];
@@ -95,7 +113,13 @@ Mesh loadCube() {
         cubeVertices.push_back(vertex);
     }
     
-    return Mesh(cubeVertices);
+    // Weld the duplicated corners into an indexed mesh and optimize it for the vertex cache
+    std::vector<unsigned int> cubeIndices;
+    MeshOptimizer::Report report = MeshOptimizer::optimize(cubeVertices, cubeIndices);
+    MeshOptimizer::printReport("cube", report);
+    
+    // Hand the vectors over to the mesh instead of copying them
+    return Mesh(std::move(cubeVertices), std::move(cubeIndices));
 }
 
 void processKeyInput(GLWindow* window, Camera* camera, float deltaTime) {
@@ -118,7 +142,27 @@ void processKeyInput(GLWindow* window, Camera* camera, float deltaTime) {
         camera->processKeyboard(DOWN, deltaTime);
 }
 
-int main(void) {
+int main(int argc, char** argv) {
+    // Cook mode: compress the textures of every tutorial into KTX files and exit.
+    // "--cook [--compare-reference] [assets directory] [output directory]", by default ./Assets
+    // with the KTX files next to the images; the "Cook Textures" build phase runs it on the source
+    // Assets. --compare-reference also encodes each file with the (much slower) reference encoder
+    // and reports its speed and quality, so builds leave it off.
+    // No window or OpenGL context is created, so this runs on machines without a GPU.
+    if (argc > 1 && std::string(argv[1]) == "--cook") {
+        bool compareReference = false;
+        std::vector<std::string> directories;
+        for (int i = 2; i < argc; i++) {
+            if (std::string(argv[i]) == "--compare-reference")
+                compareReference = true;
+            else
+                directories.push_back(argv[i]);
+        }
+        std::string sourceDirectory = directories.size() > 0 ? directories[0] : "./Assets";
+        std::string outputDirectory = directories.size() > 1 ? directories[1] : "";
+        return TextureCooker::cookDirectory(sourceDirectory, outputDirectory, compareReference) == 0 ? 0 : -1;
+    }
+    
     // Apply the debugger workaround BEFORE creating the window
     GLWindow::debuggerSleepWorkaround(1);
     
@@ -159,31 +203,117 @@ int main(void) {
     // Config AssetManager
     AssetManager::setBaseDirectory("./Assets/05-Skybox/");
     
-    // Load shaders using your Shader class
-    Shader cubeShader(
-                      SHADER_PATH("cube.vert.glsl"),
-                      SHADER_PATH("cube.frag.glsl")
-                      );
-    if (!cubeShader.load()) {
-        // Handle shader loading error (message already printed by Shader::load)
+    // Report which block-compressed formats (KTX / DDS textures) this context can sample
+    TextureCompression::printSupport();
+    
+    // Linked programs are cached on disk, so later launches skip the GLSL compiler
+    // (without driver support every program simply compiles from source)
+    ShaderBinaryCache shaderBinaryCache(AssetManager::getCacheDirectory() + "shaders/");
+    shaderBinaryCache.setup();
+    
+    // Load shaders using your Shader class.
+    // The cube shader is specialized per material path instead of branching on a uniform:
+    // TEXTURE_ARRAY selects the per-instance layer and the sampler2DArray.
+    // The cube draws with separable stages: one vertex stage that always passes the layer,
+    // paired with either fragment stage, so switching the material path swaps one stage
+    // (2 + 1 compiles for the two pairs, and each further vertex or fragment permutation adds one).
+    ShaderVariants cubeShaders(
+                               SHADER_PATH("cube_instanced.vert.glsl"),
+                               SHADER_PATH("cube.frag.glsl"),
+                               { "TEXTURE_ARRAY" }
+                               );
+    const uint32_t cubeArrayVariant = cubeShaders.getMask({ "TEXTURE_ARRAY" });
+    Shader skyboxShader(SHADER_PATH("skybox.vert.glsl"), SHADER_PATH("skybox.frag.glsl"));
+    
+    // Compile every program and stage in one batch: all compiles and links are submitted before
+    // any status is queried, so the driver (on its own threads, if it supports parallel compile)
+    // overlaps them, and each comes from the binary cache when it can
+    ShaderBatch::enableParallelCompile((GLADloadfunc)glfwGetProcAddress);
+    ShaderBatch shaderBatch;
+    cubeShaders.setBinaryCache(&shaderBinaryCache);
+    skyboxShader.setBinaryCache(&shaderBinaryCache);
+    cubeShaders.addStagesToBatch(shaderBatch, GL_VERTEX_SHADER, { cubeArrayVariant });
+    cubeShaders.addStagesToBatch(shaderBatch, GL_FRAGMENT_SHADER, { 0, cubeArrayVariant }); // Both material paths, ahead of time
+    shaderBatch.add(&skyboxShader, "skybox");
+    if (!shaderBatch.compile()) {
+        // Handle shader loading error (messages already printed per program)
         return -1; // Exit application if shader loading failed
     }
+    shaderBatch.printReport();
+    
+    // The pipeline shared by every draw that uses stages
+    ShaderStage* cubeVertexStage = cubeShaders.getStage(GL_VERTEX_SHADER, cubeArrayVariant);
+    ShaderStage* cubeTextureStage = cubeShaders.getStage(GL_FRAGMENT_SHADER, 0);
+    ShaderStage* cubeArrayStage = cubeShaders.getStage(GL_FRAGMENT_SHADER, cubeArrayVariant);
+    ProgramPipeline stagePipeline;
+    if (!stagePipeline.setup()) {
+        return -1;
+    }
+    // Check that each pair's interfaces match (the same vertex stage feeds both fragment stages)
+    for (ShaderStage* fragmentStage : { cubeTextureStage, cubeArrayStage })
+    {
+        stagePipeline.bind(*cubeVertexStage, *fragmentStage);
+        if (!stagePipeline.validate()) {
+            return -1;
+        }
+    }
+    
+    // Load the cube texture in the background: read on worker threads, uploaded by the
+    // render loop. Until then the cube samples a 1x1 placeholder.
+    // The KTX file written by the "Cook Textures" build phase is loaded (block-compressed, 4-8x
+    // smaller in memory and bandwidth); without it, or if the context cannot sample its format,
+    // cube.jpg is decoded instead.
+    // Textures come from the cache, so every mesh using the cube texture shares one load and GPU copy;
+    // unused textures are evicted (least recently used first) beyond 256 MB.
+    // Uploads are streamed through pixel buffers, at most 4 MB per frame, so large images
+    // arrive over a few frames instead of stalling one.
+    // Only the mips up to 64x64 are uploaded at first; the finer ones stream in as the camera
+    // gets close enough to see them, within 64 MB (see MipResidency).
+    TextureStreamer textureStreamer(4u << 20);
+    if (!textureStreamer.setup()) {
+        return -1;
+    }
+    MipResidency mipResidency(64u << 20, &textureStreamer);
+    TextureLoader textureLoader(ThreadPool::shared(), &textureStreamer, &mipResidency);
+    TextureCache textureCache(256u << 20, &textureLoader);
+    TextureCache::Handle cubeTexture = textureCache.acquire(AssetManager::getTexturePath("cube.ktx"));
     
-    // Load texture
-    Texture cubeTexture = Texture(AssetManager::getTexturePath("cube.jpg"));
-    if (!cubeTexture.load()) {
-        return -1; // Exit application if texture loading failed
+    // Meanwhile pack the material library into texture arrays: cubes with different materials of
+    // the same size then share one texture binding and one instanced draw (one layer per instance).
+    // The files decode through the loader (joining the decode of any texture loading the same file) and
+    // the layers stream through the same 4 MB/frame budget; the render loop switches the cubes over
+    // once the library is complete (see below). Packing only pays off when at least two materials
+    // share a size: otherwise every array would hold one layer, so the library is not packed at all
+    // and the cubes keep the cached texture.
+    std::vector<std::string> cubeMaterials = { AssetManager::getTexturePath("cube.jpg") };
+    TextureArrayPacker materialLibrary;
+    bool materialLibraryDone = !TextureArrayPacker::hasSharedLayout(cubeMaterials);
+    if (!materialLibraryDone) {
+        materialLibrary.packAsync(cubeMaterials, textureLoader, &textureStreamer);
+    } else {
+        std::cout << "Material library: no two materials share a size, nothing to pack" << std::endl;
     }
     
+    // Static geometry shares one pool: the cube and the skybox use the same layout, so they
+    // share one VAO and buffers (declared first, it must outlive every mesh allocated from it)
+    MeshPool meshPool(1024, 4096);
+    
     // setup cube mesh
     Mesh cubeMesh = loadCube();
+    // Half-float positions/UVs and snorm8 normals: half the vertex size, no dequantization needed
+    cubeMesh.setVertexLayout(HalfVertexLayout::describe());
+    cubeMesh.setMeshPool(&meshPool);
+    // The cube is never re-uploaded, so free the CPU copy once it is on the GPU
+    cubeMesh.setRetentionPolicy(Mesh::RetentionPolicy::DROP_AFTER_UPLOAD);
     if (!cubeMesh.setupMesh()) {
         return -1; // Exit application if cube loading failed
     }
+    std::cout << "Cube mesh memory: " << cubeMesh.getCpuMemoryBytes() << " bytes CPU, "
+              << cubeMesh.getGpuMemoryBytes() << " bytes GPU" << std::endl;
     
-    // Set mesh shader and texture
-    cubeMesh.setShader(&cubeShader);
-    cubeMesh.addTexture(&cubeTexture);
+    // Set mesh shader and texture (the cached single texture until the material library is in)
+    cubeMesh.setStages(&stagePipeline, cubeVertexStage, cubeTextureStage);
+    cubeMesh.addTexture(cubeTexture.get());
     
     // Define Cube Positions in a 10x10x10 Grid
     std::vector<glm::vec3> cubePositions;
@@ -202,36 +332,52 @@ int main(void) {
         }
     }
     
+    // The grid is static, so build the per-instance model matrices once
+    std::vector<glm::mat4> cubeModels;
+    cubeModels.reserve(cubePositions.size());
+    for (const glm::vec3& position : cubePositions)
+    {
+        glm::mat4 modelMatrix = glm::mat4(1.0f); // Start with identity
+        modelMatrix = glm::translate(modelMatrix, position);
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(.0f, .0f, -30.0f));
+        cubeModels.push_back(modelMatrix);
+        // Each cube face maps the whole texture over one unit
+        mipResidency.addUsage(cubeTexture.get(), glm::vec3(modelMatrix[3]), 1.0f);
+    }
+    
+    // Per-instance array layers, filled once the cubes switch to the material library
+    std::vector<uint32_t> cubeLayers;
+    
     // --- Setup Skybox Resources ---
-    // Define the paths to the skybox faces
+    // Define the paths to the skybox faces (cooked KTX faces, falling back to the JPEGs like the cube)
     std::vector<std::string> skyboxFaces
     {
-        TEXTURE_PATH("skybox_right.jpg"),
-        TEXTURE_PATH("skybox_left.jpg"),
-        TEXTURE_PATH("skybox_top.jpg"),
-        TEXTURE_PATH("skybox_bottom.jpg"),
-        TEXTURE_PATH("skybox_front.jpg"),
-        TEXTURE_PATH("skybox_back.jpg"),
+        TEXTURE_PATH("skybox_right.ktx"),
+        TEXTURE_PATH("skybox_left.ktx"),
+        TEXTURE_PATH("skybox_top.ktx"),
+        TEXTURE_PATH("skybox_bottom.ktx"),
+        TEXTURE_PATH("skybox_front.ktx"),
+        TEXTURE_PATH("skybox_back.ktx"),
     };
 
     // Create and load the CubeTexture for the skybox
+    // The faces are decoded now and streamed in during the first frames
     CubeTexture skyboxCubeTexture(skyboxFaces);
+    skyboxCubeTexture.setStreamer(&textureStreamer);
     if (!skyboxCubeTexture.load()) { // Call load() after creating the object
         return -1;
     }
     
-    // Load skybox shader
-    Shader skyboxShader(SHADER_PATH("skybox.vert.glsl"), SHADER_PATH("skybox.frag.glsl"));
-    if (!skyboxShader.load()) {
-        return -1;
-    }
-    
     // Setup Skybox
     Skybox skybox;
     
-    if (!skybox.setupMesh()) {
+    // Drawn from the pool with one glMultiDrawElementsBaseVertex, no VAO switch after the cubes
+    if (!skybox.setupMesh(meshPool, HalfVertexLayout::describe())) {
         return -1;
     }
+    std::cout << "Mesh pool: " << meshPool.getLiveMeshCount() << " meshes in " << meshPool.getArenaCount()
+              << " arena(s), " << meshPool.getUsedVertices() << " vertices, " << meshPool.getUsedIndices()
+              << " indices, " << meshPool.getGpuMemoryBytes() / 1024 << " KB GPU" << std::endl;
     skybox.setShader(&skyboxShader);
     skybox.setCubeTexture(&skyboxCubeTexture);
     
@@ -243,33 +389,113 @@ int main(void) {
     
     glm::mat4 projectionMatrix = glm::perspective(glm::radians(fovDegrees), aspectRatio, nearPlane, farPlane);
     
+    // Per-frame camera data shared by all shader programs
+    FrameUniforms frameUniforms;
+    if (!frameUniforms.setup()) {
+        return -1;
+    }
+    float elapsedTime = 0.0f;
+    
+    // Draws are queued each frame, then sorted and submitted together
+    RenderQueue renderQueue;
+    renderQueue.setDepthRange(nearPlane, farPlane);
+    
+    // Everything is loaded: draw each program + state combination once offscreen, so drivers
+    // that finish compiling on first use do it here instead of in the first frames
+    // Callbacks only draw: each runs twice and must not advance any streaming state or stats
+    ShaderPrewarmer shaderPrewarmer;
+    shaderPrewarmer.add("cube (instanced, cached texture)", [&]() {
+        cubeMesh.drawInstanced(std::span<const glm::mat4>(cubeModels).first(1));
+    });
+    // The array path is only switched to once the material library is packed, so draw it here
+    // with its fragment stage swapped in (no array is bound yet, which samples black)
+    cubeArrayStage->setInt("uTextureArray", Mesh::TEXTURE_ARRAY_UNIT);
+    shaderPrewarmer.add("cube (instanced, texture array)", [&]() {
+        cubeMesh.setStages(&stagePipeline, cubeVertexStage, cubeArrayStage);
+        cubeMesh.drawInstanced(std::span<const glm::mat4>(cubeModels).first(1));
+        cubeMesh.setStages(&stagePipeline, cubeVertexStage, cubeTextureStage);
+    });
+    shaderPrewarmer.add("skybox", [&]() { skybox.draw(); });
+    shaderPrewarmer.prewarm();
+    shaderPrewarmer.printReport();
+    
     // Create an FPS limiter object
     FPSLimiter fpsLimiter(60); // Target 60 FPS
     
     /* Loop until the user closes the window */
     // Use the GLWindow method to check if the window should close
     while (!window.shouldClose()) {
+        // Reset the per-frame issued/skipped state change counters
+        RenderState::beginFrame();
+        
+        // Upload textures that finished decoding, spending at most 2 ms of the frame
+        // (called every frame: it also frees decoded pixels once their last user is done)
+        textureLoader.processUploads(2.0);
+        if (cubeTexture.isReady() && !cubeTexture.succeeded()) {
+            return -1; // Exit application if texture loading failed
+        }
+        // Stream this frame's share of the pending texture uploads
+        if (textureStreamer.update() > 0) {
+            textureCache.trim(); // Finished textures now count their full size
+        }
+        
+        // Once the material library is packed, cycle the cubes through the materials packed in
+        // the same array as the first one. If the first one shares its array with no other, there
+        // is nothing to batch, so the cubes keep the cached texture and its mip residency.
+        if (!materialLibraryDone && materialLibrary.update())
+        {
+            materialLibraryDone = true;
+            materialLibrary.printSummary();
+            MaterialLayer cubeMaterial = materialLibrary.find(cubeMaterials[0]);
+            std::vector<uint32_t> sameArrayLayers;
+            for (const std::string& material : cubeMaterials)
+            {
+                MaterialLayer packed = materialLibrary.find(material);
+                if (packed.isValid() && packed.array == cubeMaterial.array) {
+                    sameArrayLayers.push_back(static_cast<uint32_t>(packed.layer));
+                }
+            }
+            if (sameArrayLayers.size() > 1)
+            {
+                for (size_t i = 0; i < cubeModels.size(); i++) {
+                    cubeLayers.push_back(sameArrayLayers[i % sameArrayLayers.size()]);
+                }
+                cubeMesh.clearTextures();
+                cubeMesh.setStages(&stagePipeline, cubeVertexStage, cubeArrayStage); // Same vertex stage, one swap
+                cubeMesh.setTextureArray(cubeMaterial.array);
+                // The arrays are fully resident, so the single texture is no longer needed
+                mipResidency.clearUsages(cubeTexture.get());
+                cubeTexture.reset();
+            }
+            else
+            {
+                std::cout << "Material library: one material per array, the cubes keep the cached texture" << std::endl;
+            }
+        }
+        
         // Process key input
         processKeyInput(&window, &mainCamera, fpsLimiter.getDeltaTime());
         
+        // Stream in (or drop) texture mips for what the camera now sees
+        mipResidency.update(mainCamera, projectionMatrix, window.getHeight());
+        
         // Clear the color buffer using the GLWindow clear method
         window.clear(0.16f, 0.24f, 0.32f, 1.0f, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
         // Get the View matrix from the Camera
         glm::mat4 viewMatrix = mainCamera.getViewMatrix();
         
-        // Ask cube to draw
-        for (unsigned int i = 0; i < cubePositions.size(); i++)
-        {
-            glm::mat4 modelMatrix = glm::mat4(1.0f); // Start with identity
-            modelMatrix = glm::translate(modelMatrix, cubePositions[i]);
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(.0f, .0f, -30.0f));
-            
-            cubeMesh.draw(modelMatrix, viewMatrix, projectionMatrix);
-        }
+        // Upload the per-frame camera data once for all programs
+        elapsedTime += fpsLimiter.getDeltaTime();
+        frameUniforms.update(viewMatrix, projectionMatrix, mainCamera.position, elapsedTime, fpsLimiter.getDeltaTime());
+        
+        // Queue all cubes as a single instanced draw, then sort and submit the frame's draws
+        renderQueue.begin(viewMatrix);
+        renderQueue.pushInstanced(&cubeMesh, cubeModels, RenderPass::OPAQUE, cubeLayers);
+        renderQueue.submit();
         
         // Render skybox
-        skybox.draw(viewMatrix, projectionMatrix);
+        skybox.draw();
         
         // Limit the frame rate using the FPSLimiter object
         fpsLimiter.limit();
@@ -281,6 +507,28 @@ int main(void) {
         window.pollEvents();
     }
     
+    std::cout << "Program pipeline: " << stagePipeline.getStats().stageSwaps << " stage swaps, "
+              << stagePipeline.getStats().stageSkips << " skipped" << std::endl;
+    
+    const TextureStreamer::Stats& streamerStats = textureStreamer.getStats();
+    std::cout << "Texture streaming: " << streamerStats.totalBytes / 1024 << " KB in " << streamerStats.subImages
+              << " sub-images, " << streamerStats.completed << " uploads, " << streamerStats.fenceWaits << " fence waits ("
+              << streamerStats.fenceWaitMs << " ms)" << std::endl;
+    
+    const ShaderBinaryCache::Stats& shaderCacheStats = shaderBinaryCache.getStats();
+    std::cout << "Shader binary cache: " << shaderCacheStats.hits << " hits, " << shaderCacheStats.misses << " misses ("
+              << shaderCacheStats.rejected << " rejected by the driver), " << shaderCacheStats.stored << " stored" << std::endl;
+    
+    const MipResidency::Stats& residencyStats = mipResidency.getStats();
+    std::cout << "Mip residency: " << residencyStats.residentBytes / 1024 << " KB resident of "
+              << residencyStats.requiredBytes / 1024 << " KB required, " << residencyStats.levelsStreamedIn
+              << " levels streamed in, " << residencyStats.levelsDropped << " dropped" << std::endl;
+    
+    const TextureCache::Stats& textureCacheStats = textureCache.getStats();
+    std::cout << "Texture cache: " << textureCache.getTextureCount() << " textures, "
+              << textureCache.getResidentBytes() / 1024 << " KB resident, " << textureCacheStats.hits << " hits, "
+              << textureCacheStats.misses << " misses, " << textureCacheStats.evictions << " evictions" << std::endl;
+    
     return 0;
 }
 